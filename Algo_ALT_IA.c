@@ -4,7 +4,7 @@
 ****************************************************
 THIS IS THE FULL NON UPDATED VERSION 
 
-THE UPDATED AND ADAPTED VERSION FOR THE PROJECT IS minimax_AI.c
+THE UPDATED AND ADAPTED VERSION FOR THE PROJECT IS src/search.c
  
 The code will determine the behavior of CPU (AI)
 
@@ -2,7 +2,73 @@
 #define AI_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "const.h"
+#include "profile.h"
 
+/**
+ * @def PATTERN_CACHE_SIZE
+ * @brief Number of positions remembered by a pattern cache.
+ */
+#define PATTERN_CACHE_SIZE 1024
+
+/**
+ * @enum chomp_pattern
+ * @brief End game patterns recognized by the ai.
+ */
+typedef enum {
+    NO_PATTERN = 0, /**< No known pattern. */
+    ROW_LINE_PATTERN, /**< Only the first row is left. */
+    COL_LINE_PATTERN, /**< Only the first column is left. */
+    SQUARE_PATTERN, /**< A small square. */
+    ROW_RECTANGLE_PATTERN, /**< Two rows. */
+    COL_RECTANGLE_PATTERN, /**< Two columns. */
+    CORNER_PATTERN, /**< The first row and the first column. */
+    GUN_PATTERN /**< A corner with a few cells inside. */
+} chomp_pattern;
+
+/**
+ * @struct board_profile
+ * @brief Everything the patterns and strategies read from a position.
+ *
+ * The patterns only look at the first two rows and columns and at the cells
+ * inside the corner they form, so the profile holds their lengths and not
+ * the table. It is computed once per position by board_profile_from_table()
+ * for a table, and is filled the same way for a corner board, whose lengths
+ * do not fit in an int.
+ */
+typedef struct {
+    int64_t row_len[2]; /**< Number of cells of the first two rows. */
+    int64_t col_len[2]; /**< Number of cells of the first two columns. */
+    int64_t num_cells_inside; /**< Number of cells outside the first row and column. */
+    int64_t cols; /**< Number of columns of the board, the moves are row * cols + col. */
+    int64_t max_to_delete; /**< Deletion limit of the board. */
+} board_profile;
+
+/**
+ * @struct pattern_cache_entry
+ * @brief A position already classified, with its pattern and move.
+ */
+typedef struct {
+    chomp_profile key; /**< Row lengths of the position. */
+    int rows; /**< Number of rows of the board, 0 if the entry is empty. */
+    int cols; /**< Number of columns of the board. */
+    int max_to_delete; /**< Deletion limit of the board. */
+    chomp_pattern pattern; /**< Pattern of the position. */
+    int move; /**< Move of the pattern. */
+} pattern_cache_entry;
+
+/**
+ * @struct pattern_cache
+ * @brief Direct-mapped cache of the positions classified by find_pattern_profile().
+ *
+ * Each caller owns its cache, so the lookups need no lock as long as a cache
+ * is used by one thread at a time. A zeroed cache is empty. The board
+ * configuration is part of every entry, so changing it needs no flush.
+ */
+typedef struct {
+    pattern_cache_entry entries[PATTERN_CACHE_SIZE]; /**< The entries, indexed by the hash of the position. */
+} pattern_cache;
 
 // Function declarations
 
@@ -41,108 +107,149 @@ int number_of_cells_in_col(int table[ROWS][COLS], int col);
  */
 int number_of_cells_in_square(int table[ROWS][COLS], int row, int col);
 
+/**
+ * @brief Builds the board profile of a table.
+ * 
+ * This function reads every row once, since the table is a staircase
+ * position, which every position of a game is.
+ * 
+ * @param table A 2D array representing the game table.
+ * @param profile The board profile to fill.
+ */
+void board_profile_from_table(int table[ROWS][COLS], board_profile *profile);
+
+/**
+ * @brief Builds the board profile of a position given by its row lengths.
+ * 
+ * The column lengths and the number of cells inside the corner are derived
+ * from the row lengths, without any table.
+ * 
+ * @param position The row lengths of the position.
+ * @param profile The board profile to fill.
+ */
+void board_profile_from_profile(const chomp_profile *position, board_profile *profile);
+
 /**
  * @brief Detects if the table has a row line pattern.
  * 
  * This function checks if the table has a row line pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
-bool row_line_pattern(int table[ROWS][COLS]);
+bool row_line_pattern(const board_profile *profile);
 
 /**
  * @brief Detects if the table has a column line pattern.
  * 
  * This function checks if the table has a column line pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
-bool col_line_pattern(int table[ROWS][COLS]);
+bool col_line_pattern(const board_profile *profile);
 
 /**
  * @brief Detects if the table has a square pattern.
  * 
  * This function checks if the table has a square pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
-bool square_pattern(int table[ROWS][COLS]);
+bool square_pattern(const board_profile *profile);
 
 /**
  * @brief Detects if the table has a row rectangle pattern.
  * 
  * This function checks if the table has a row rectangle pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
-bool row_rectangle_pattern(int table[ROWS][COLS]);
+bool row_rectangle_pattern(const board_profile *profile);
 
 /**
  * @brief Detects if the table has a column rectangle pattern.
  * 
  * This function checks if the table has a column rectangle pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
-bool col_rectangle_pattern(int table[ROWS][COLS]);
+bool col_rectangle_pattern(const board_profile *profile);
 
 /**
  * @brief Detects if the table has a corner pattern.
  * 
  * This function checks if the table has a corner pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
-bool corner_pattern(int table[ROWS][COLS]);
+bool corner_pattern(const board_profile *profile);
 
 /**
  * @brief Detects if the table has a gun pattern.
  * 
  * This function checks if the table has a gun pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
-bool gun_pattern(int table[ROWS][COLS]);
+bool gun_pattern(const board_profile *profile);
 
 /**
- * @brief Detects the current pattern in the table.
+ * @brief Classifies a position with the pattern rules.
  * 
- * This function checks for various patterns in the table and sets the current pattern.
+ * Only the first rule that matches is used. Its move is not checked against
+ * the position, the caller does it.
  * 
- * @param table A 2D array representing the game table.
- * @return True if a pattern is detected, otherwise false.
+ * @param profile The board profile of the position.
+ * @param row Where to store the row of the move, left unchanged if there is no pattern.
+ * @param col Where to store the column of the move, left unchanged if there is no pattern.
+ * @return The detected pattern, NO_PATTERN if there is none.
+ */
+chomp_pattern match_pattern(const board_profile *profile, int64_t *row, int64_t *col);
+
+/**
+ * @brief Finds the pattern of a position given by its row lengths and its move.
+ * 
+ * This function does not touch any global state, so several positions can
+ * be classified at the same time. A position already in the cache is found
+ * from its row lengths alone, in constant time.
+ * 
+ * @param position The row lengths of the position.
+ * @param move The move coordinates to fill, left unchanged if there is no pattern.
+ * @param cache The cache of the caller, NULL to classify the position without one.
+ * @return The detected pattern, NO_PATTERN if there is none.
  */
-bool detect_pattern(int table[ROWS][COLS]);
+chomp_pattern find_pattern_profile(const chomp_profile *position, int *move, pattern_cache *cache);
 
 /**
- * @brief Returns the move coordinates based on the detected pattern.
+ * @brief Finds the pattern of the table and its move.
  * 
- * This function returns the move coordinates based on the detected pattern.
+ * The table is read into row lengths and classified without a cache, see
+ * find_pattern_profile().
  * 
  * @param table A 2D array representing the game table.
- * @return The move coordinates.
+ * @param move The move coordinates to fill, left unchanged if there is no pattern.
+ * @return The detected pattern, NO_PATTERN if there is none.
  */
-int pattern_move(int table[ROWS][COLS]);
+chomp_pattern find_pattern(int table[ROWS][COLS], int *move);
 
-int row_line_strategy();
+int64_t row_line_strategy(const board_profile *profile);
 
-int col_line_strategy();
+int64_t col_line_strategy(const board_profile *profile);
 
-int square_strategy();
+int64_t square_strategy(const board_profile *profile);
 
-int row_rectangle_strategy(int table[ROWS][COLS]);
+int64_t row_rectangle_strategy(const board_profile *profile);
 
-int col_rectangle_strategy(int table[ROWS][COLS]);
+int64_t col_rectangle_strategy(const board_profile *profile);
 
-int corner_strategy(int table[ROWS][COLS]);
+int64_t corner_strategy(const board_profile *profile);
 
-int gun_strategy(int table[ROWS][COLS]);
+int64_t gun_strategy(const board_profile *profile);
 
 #endif // AI_H
\ No newline at end of file
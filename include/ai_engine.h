@@ -0,0 +1,213 @@
+/**
+ * @file ai_engine.h
+ * @brief Common interface of the ai engines.
+ *
+ * Every way the ai has to choose a move is an engine: a name and a function
+ * that takes a position and a time budget and returns a move. The engines
+ * are listed in one table, the front ends only call the current engine
+ * through ai_engine_move(), and it can be changed at runtime by name. When
+ * an engine finds no move, the pattern engine plays instead.
+ *
+ * The search and Monte-Carlo engines are anytime: given a time budget, they
+ * return the best move found when it runs out. A difficulty level is a time
+ * budget with a depth limit and a number of iterations.
+ *
+ * These engines can also ponder: while the opponent thinks, a background
+ * thread searches the position the opponent has to play. The work is kept
+ * by the engine, its transposition table or its tree, and reused for the
+ * reply once the move of the opponent is known.
+ *
+ * When an opening book is loaded, the positions it holds are played from it
+ * whatever the engine, without any search.
+ */
+
+#ifndef AI_ENGINE_H
+#define AI_ENGINE_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "const.h"
+#include "game_state.h"
+#include "book.h"
+#include "tablebase_file.h"
+
+/**
+ * @def AI_NO_TIME_LIMIT
+ * @brief Time budget of an engine allowed to think as long as it needs.
+ */
+#define AI_NO_TIME_LIMIT 0
+
+/**
+ * @def AI_NETWORK_TIME_BUDGET
+ * @brief Time budget of the network ai when none was given, in milliseconds.
+ */
+#define AI_NETWORK_TIME_BUDGET 2000
+
+/**
+ * @typedef ai_move_function
+ * @brief Chooses a move of a position.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the engine may think, in milliseconds, AI_NO_TIME_LIMIT for none.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false otherwise.
+ */
+typedef bool (*ai_move_function) (const game_state *state, int time_budget_ms, int *row, int *col);
+
+/**
+ * @typedef ai_ponder_function
+ * @brief Searches a position of the opponent, keeping the work for the reply.
+ *
+ * @param state The position, the opponent to move.
+ * @param stop Set by another thread to stop the search.
+ * @return true if the position was searched, false otherwise.
+ */
+typedef bool (*ai_ponder_function) (const game_state *state, atomic_bool *stop);
+
+/**
+ * @typedef ai_prepare_function
+ * @brief Does the work of an engine that only depends on the board, before the game.
+ *
+ * @return true if the engine is ready, false otherwise.
+ */
+typedef bool (*ai_prepare_function) (void);
+
+/**
+ * @struct ai_engine
+ * @brief An engine of the ai.
+ */
+typedef struct {
+    const char *name; /**< Name of the engine, as given on the command line. */
+    const char *description; /**< One line description of the engine. */
+    ai_move_function choose_move; /**< Chooses the move of a position. */
+    ai_ponder_function ponder; /**< Searches during the turn of the opponent, NULL if the engine has nothing to keep. */
+    ai_prepare_function prepare; /**< Prepares the engine for the board before the game, NULL if there is nothing to prepare. */
+} ai_engine;
+
+/**
+ * @struct ai_level
+ * @brief A difficulty level of the ai.
+ */
+typedef struct {
+    const char *name; /**< Name of the level, as given on the command line. */
+    int time_budget_ms; /**< Time the ai may think per move, in milliseconds. */
+    int depth; /**< Depth limit of the search engine, in plies, 0 for none. */
+    int iterations; /**< Iterations of each thread of the Monte-Carlo engine. */
+} ai_level;
+
+/**
+ * @var ai_engines
+ * @brief Every engine of the ai.
+ */
+extern const ai_engine ai_engines[];
+
+/**
+ * @var num_ai_engines
+ * @brief Number of engines of the ai.
+ */
+extern const int num_ai_engines;
+
+/**
+ * @var current_ai_engine
+ * @brief The engine the ai plays with, the pattern engine by default.
+ */
+extern const ai_engine *current_ai_engine;
+
+/**
+ * @var ai_time_budget
+ * @brief Time the ai may think per move, in milliseconds, AI_NO_TIME_LIMIT for none.
+ */
+extern int ai_time_budget;
+
+/**
+ * @var ai_book
+ * @brief The opening book of the ai, empty if none was loaded.
+ */
+extern opening_book ai_book;
+
+/**
+ * @var ai_tablebase_file
+ * @brief The tablebase file the perfect engine reads, none if no file was mapped.
+ */
+extern tablebase_file ai_tablebase_file;
+
+/**
+ * @var ai_levels
+ * @brief Every difficulty level of the ai, from the easiest.
+ */
+extern const ai_level ai_levels[];
+
+/**
+ * @var num_ai_levels
+ * @brief Number of difficulty levels of the ai.
+ */
+extern const int num_ai_levels;
+
+/**
+ * @brief Finds an engine by name.
+ *
+ * @param name The name of the engine.
+ * @return The engine, NULL if there is no engine with that name.
+ */
+const ai_engine *ai_engine_find (const char *name);
+
+/**
+ * @brief Finds a difficulty level by name.
+ *
+ * @param name The name of the level.
+ * @return The level, NULL if there is no level with that name.
+ */
+const ai_level *ai_level_find (const char *name);
+
+/**
+ * @brief Sets the budgets of the engines to those of a difficulty level.
+ *
+ * @param level The level.
+ */
+void ai_level_apply (const ai_level *level);
+
+/**
+ * @brief Prepares the current engine for the current board.
+ *
+ * Called once the board is set, before the game starts, so that a move
+ * never waits for work that does not depend on the position.
+ *
+ * @return true if the engine is ready, false if it will fall back to the pattern engine.
+ */
+bool ai_engine_prepare (void);
+
+/**
+ * @brief Chooses the move of the ai with the current engine.
+ *
+ * Positions of the opening book are played from it. If the current engine
+ * finds no move, the pattern engine plays instead. Pondering is stopped
+ * first.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the engine may think, in milliseconds, AI_NO_TIME_LIMIT for none.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over.
+ */
+bool ai_engine_move (const game_state *state, int time_budget_ms, int *row, int *col);
+
+/**
+ * @brief Starts pondering a position with the current engine.
+ *
+ * The search runs on a background thread until ai_ponder_stop() is called,
+ * or until the engine has nothing left to search.
+ *
+ * @param state The position, the opponent to move.
+ * @return true if pondering started, false if the engine cannot ponder or the game is over.
+ */
+bool ai_ponder_start (const game_state *state);
+
+/**
+ * @brief Stops pondering and waits for the background thread.
+ *
+ * Nothing happens if the ai is not pondering.
+ */
+void ai_ponder_stop (void);
+
+#endif /* AI_ENGINE_H */
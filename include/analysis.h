@@ -0,0 +1,101 @@
+/**
+ * @file analysis.h
+ * @brief Batch evaluation of Chomp positions.
+ *
+ * The analysis tools score many positions at once: for each one the legal
+ * moves, the deletion counts, the end game pattern found by the ai and the
+ * move the ai recommends. Nothing is shared between positions, so large
+ * batches are split across threads. Every position uses the current board
+ * configuration, which must not change during the call.
+ *
+ * Boards far larger than ROWS x COLS are analysed as corner boards: their
+ * legal moves are counted and the end game patterns are matched by the
+ * pattern rules of ai.c on 64-bit lengths. The game cannot be played on
+ * them, this API only evaluates them.
+ */
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <stdint.h>
+#include "const.h"
+#include "profile.h"
+#include "ai.h"
+#include "corner_board.h"
+
+/**
+ * @def ANALYSIS_MIN_POSITIONS_PER_THREAD
+ * @brief Smallest share of a batch worth starting a thread for.
+ */
+#define ANALYSIS_MIN_POSITIONS_PER_THREAD 64
+
+/**
+ * @def ANALYSIS_MAX_CORNER_MOVES
+ * @brief Number of legal moves of a corner board the recommended move is drawn from.
+ */
+#define ANALYSIS_MAX_CORNER_MOVES 4096
+
+/**
+ * @struct position_analysis
+ * @brief The evaluation of one position.
+ */
+typedef struct {
+    uint64_t legal[ROWS]; /**< Bit j of legal[i] is set if the cell (i, j) is a legal move. */
+    int num_legal_moves; /**< Number of legal moves. */
+    chomp_pattern pattern; /**< End game pattern, NO_PATTERN if none. */
+    int move_row; /**< Row of the recommended move, -1 if the game is over. */
+    int move_col; /**< Column of the recommended move, -1 if the game is over. */
+} position_analysis;
+
+/**
+ * @struct corner_analysis
+ * @brief The evaluation of a corner board.
+ */
+typedef struct {
+    int64_t num_cells; /**< Number of cells left. */
+    int num_corners; /**< Number of corners of the staircase. */
+    int64_t num_legal_moves; /**< Number of legal moves. */
+    chomp_pattern pattern; /**< End game pattern, NO_PATTERN if none. */
+    int64_t move_row; /**< Row of the recommended move, -1 if the game is over. */
+    int64_t move_col; /**< Column of the recommended move, -1 if the game is over. */
+} corner_analysis;
+
+/**
+ * @brief Evaluates a batch of positions given as int tables.
+ *
+ * @param tables The positions.
+ * @param num_positions The number of positions.
+ * @param results The array to fill, one entry per position.
+ * @param counts The deletion count of every cell of every position, NULL if not needed.
+ * @param num_threads The maximum number of threads, 0 for one per processor.
+ */
+void analyse_tables (int tables[][ROWS][COLS], int num_positions, position_analysis results[], int counts[][ROWS][COLS], int num_threads);
+
+/**
+ * @brief Evaluates a batch of positions given as profiles.
+ *
+ * @param profiles The positions.
+ * @param num_positions The number of positions.
+ * @param results The array to fill, one entry per position.
+ * @param counts The deletion count of every cell of every position, NULL if not needed.
+ * @param num_threads The maximum number of threads, 0 for one per processor.
+ */
+void analyse_profiles (const chomp_profile profiles[], int num_positions, position_analysis results[], int counts[][ROWS][COLS], int num_threads);
+
+/**
+ * @brief Evaluates a corner board of any size.
+ *
+ * The board carries its own size and deletion limit, the current board
+ * configuration is not used. The patterns and their moves come from
+ * match_pattern(), the rules find_pattern() applies to tables. Without a
+ * pattern, the recommended move is drawn from the first
+ * ANALYSIS_MAX_CORNER_MOVES legal moves, the poisoned cell only if it is the
+ * last one.
+ *
+ * @param board The board.
+ * @param result The result to fill.
+ * @return true on success, false if memory is missing.
+ */
+bool analyse_corner_board (const corner_board *board, corner_analysis *result);
+
+#endif /* ANALYSIS_H */
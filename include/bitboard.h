@@ -0,0 +1,163 @@
+/**
+ * @file bitboard.h
+ * @brief Bitboard representation of the Chomp game board.
+ *
+ * The 7x9 board has 63 cells, so the whole board fits in a single 64-bit
+ * word. Cell (row, col) is stored in bit row * board_cols + col, which keeps
+ * the bit order identical to the row-major order of the int table. Moves,
+ * deletion counts and legality checks become mask and popcount operations,
+ * and copying a board is a plain assignment.
+ *
+ * Bitboards can only be used while the board has at most 64 cells, see
+ * bitboard_fits(). The quadrant masks depend on the board dimensions and are
+ * rebuilt by bitboard_setup() whenever they change.
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "const.h"
+
+/**
+ * @typedef bitboard
+ * @brief A whole game board, one bit per cell (1 = cell still present).
+ */
+typedef uint64_t bitboard;
+
+/**
+ * @var bitboard_quadrant_masks
+ * @brief Mask of the cells eaten by a move, indexed by the bit of its cell.
+ */
+extern bitboard bitboard_quadrant_masks[64];
+
+/**
+ * @brief Rebuilds the quadrant masks for the current board dimensions.
+ *
+ * This function must be called after board_rows or board_cols change. It does
+ * nothing if the board does not fit in a bitboard.
+ */
+void bitboard_setup (void);
+
+/**
+ * @brief Checks if the current board fits in a bitboard.
+ *
+ * @return true if the board has at most 64 cells.
+ */
+static inline bool
+bitboard_fits (void)
+{
+    return board_rows * board_cols <= 64;
+}
+
+/**
+ * @brief Returns the bit of the specified cell.
+ *
+ * @param row The row of the cell.
+ * @param col The column of the cell.
+ * @return A bitboard with only the specified cell set.
+ */
+static inline bitboard
+bitboard_cell (int row, int col)
+{
+    return UINT64_C(1) << (row * board_cols + col);
+}
+
+/**
+ * @brief Returns the mask of the cells eaten by a move.
+ *
+ * The mask covers the specified cell and every cell to the right and below
+ * it.
+ *
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return The mask of the cells at or after (row, col) in both directions.
+ */
+static inline bitboard
+bitboard_quadrant_mask (int row, int col)
+{
+    return bitboard_quadrant_masks[row * board_cols + col];
+}
+
+/**
+ * @brief Returns a board with every cell present.
+ *
+ * @return The initial board.
+ */
+static inline bitboard
+bitboard_full (void)
+{
+    return bitboard_quadrant_masks[0];
+}
+
+/**
+ * @brief Checks if the specified cell is still present.
+ *
+ * @param board The board.
+ * @param row The row of the cell.
+ * @param col The column of the cell.
+ * @return true if the cell is present, false if it was eaten.
+ */
+static inline bool
+bitboard_is_cell_set (bitboard board, int row, int col)
+{
+    return (board & bitboard_cell(row, col)) != 0;
+}
+
+/**
+ * @brief Calculates the number of cells a move would delete.
+ *
+ * @param board The board.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return The number of cells to delete.
+ */
+static inline int
+bitboard_num_to_delete (bitboard board, int row, int col)
+{
+    return __builtin_popcountll(board & bitboard_quadrant_mask(row, col));
+}
+
+/**
+ * @brief Applies a move to a board.
+ *
+ * @param board The board.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return The board after the move.
+ */
+static inline bitboard
+bitboard_delete_cells (bitboard board, int row, int col)
+{
+    return board & ~bitboard_quadrant_mask(row, col);
+}
+
+/**
+ * @brief Converts an int table to a bitboard.
+ *
+ * @param table The game table.
+ * @return The bitboard holding the same cells.
+ */
+bitboard bitboard_from_table (int table[ROWS][COLS]);
+
+/**
+ * @brief Writes a bitboard back to an int table.
+ *
+ * @param board The bitboard.
+ * @param table The game table to fill.
+ */
+void bitboard_to_table (bitboard board, int table[ROWS][COLS]);
+
+/**
+ * @brief Calculates the legal moves of a board.
+ *
+ * A move is legal if its cell is present and it deletes at most
+ * num_max_to_delete cells.
+ *
+ * @param board The board.
+ * @return A bitboard with the cells of all legal moves set.
+ */
+bitboard bitboard_legal_moves (bitboard board);
+
+#endif /* BITBOARD_H */
@@ -0,0 +1,118 @@
+/**
+ * @file book.h
+ * @brief Opening book of the Chomp game.
+ *
+ * The first moves of a game are the most expensive ones to search: the board
+ * is full and the search is far from any proof. The book stores the move of
+ * every position reachable in the first plies of the game, searched offline
+ * with as much time and as many threads as wanted, so the ai plays them
+ * instantly.
+ *
+ * A book is built for one board size and deletion limit. Its entries are
+ * sorted by the hash of their position and looked up by binary search. In a
+ * file, a header (magic, version, board size, deletion limit, plies and
+ * number of entries) is followed by the entries, every field written in
+ * little-endian order.
+ */
+
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "const.h"
+#include "game_state.h"
+
+/**
+ * @def BOOK_MAGIC
+ * @brief First bytes of a book file.
+ */
+#define BOOK_MAGIC "CHOMPBK"
+
+/**
+ * @def BOOK_VERSION
+ * @brief Version of the book file format.
+ */
+#define BOOK_VERSION 1
+
+/**
+ * @def BOOK_DEFAULT_PLIES
+ * @brief Default number of plies covered by a book.
+ */
+#define BOOK_DEFAULT_PLIES 4
+
+/**
+ * @struct book_entry
+ * @brief The move of a position of the book.
+ */
+typedef struct {
+    uint64_t key; /**< Hash of the position, see profile_hash(). */
+    int16_t move; /**< The move, row * COLS + col. */
+    int8_t result; /**< 1 if the move is a proven win, -1 if the position is a proven loss, 0 otherwise. */
+} book_entry;
+
+/**
+ * @struct opening_book
+ * @brief An opening book.
+ */
+typedef struct {
+    int rows; /**< Board rows the book was built for, 0 if the book is empty. */
+    int cols; /**< Board columns the book was built for. */
+    int max_to_delete; /**< Deletion limit the book was built for. */
+    int plies; /**< Number of plies from the start covered by the book. */
+    uint32_t num_entries; /**< Number of positions. */
+    book_entry *entries; /**< The positions, sorted by key. */
+} opening_book;
+
+/**
+ * @brief Builds the book of the current board configuration.
+ *
+ * Every position reachable in fewer than plies moves from the full board is
+ * searched with the alpha-beta engine.
+ *
+ * @param book The book to fill, freed with book_free().
+ * @param plies The number of plies covered.
+ * @param max_depth The depth limit of the search of each position, 0 for none.
+ * @param time_budget_ms The time the search of each position may take, in milliseconds, 0 for no limit.
+ * @param num_threads The number of threads of the search, 0 for one per processor.
+ * @return true if the book was built, false if memory ran out.
+ */
+bool book_build (opening_book *book, int plies, int max_depth, int time_budget_ms, int num_threads);
+
+/**
+ * @brief Writes a book to a file.
+ *
+ * @param book The book.
+ * @param path The path of the file.
+ * @return true if the file was written, false otherwise.
+ */
+bool book_save (const opening_book *book, const char *path);
+
+/**
+ * @brief Reads a book from a file.
+ *
+ * @param book The book to fill, freed with book_free().
+ * @param path The path of the file.
+ * @return true if the file is a valid book, false otherwise.
+ */
+bool book_load (opening_book *book, const char *path);
+
+/**
+ * @brief Frees the entries of a book and empties it.
+ *
+ * @param book The book.
+ */
+void book_free (opening_book *book);
+
+/**
+ * @brief Finds the move of a position in a book.
+ *
+ * @param book The book.
+ * @param state The position.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if the position is in the book, false if it is not or the book is for another board.
+ */
+bool book_lookup (const opening_book *book, const game_state *state, int *row, int *col);
+
+#endif /* BOOK_H */
@@ -14,9 +14,83 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <ctype.h>
 #include "const.h"
 
+/**
+ * @brief Sets the board dimensions and the deletion limit.
+ *
+ * This function changes the size of the board used by every game started
+ * afterwards, and rebuilds the bitboard masks for the new size.
+ *
+ * @param rows The number of rows, between 1 and ROWS.
+ * @param cols The number of columns, between 1 and COLS.
+ * @param max_to_delete The maximum number of cells deleted in one move.
+ * @return true if the configuration is valid and was applied, false otherwise.
+ */
+bool set_board_config (int rows, int cols, int max_to_delete);
+
+/**
+ * @brief Writes the label of a column.
+ *
+ * Columns are labelled A to Z, then AA, AB and so on.
+ *
+ * @param col The column.
+ * @param label The buffer to fill, at least CELL_LABEL_SIZE bytes.
+ */
+void column_label (int col, char *label);
+
+/**
+ * @brief Writes the label of a cell, such as "A1".
+ *
+ * @param row The row of the cell.
+ * @param col The column of the cell.
+ * @param label The buffer to fill, at least CELL_LABEL_SIZE bytes.
+ */
+void format_cell (int row, int col, char *label);
+
+/**
+ * @brief Parses the label of a cell, such as "A1" or "b12".
+ *
+ * @param input The label to parse.
+ * @param row Where to store the row of the cell.
+ * @param col Where to store the column of the cell.
+ * @return true if the label names a cell of the board, false otherwise.
+ */
+bool parse_cell (const char *input, int *row, int *col);
+
+/**
+ * @brief Parses a board size, such as "7x9".
+ *
+ * The dimensions are not checked against the board limits, see set_board_config().
+ *
+ * @param input The size to parse.
+ * @param rows Where to store the number of rows.
+ * @param cols Where to store the number of columns.
+ * @return true if the input is exactly <rows>x<cols>, false otherwise.
+ */
+bool parse_board_size (const char *input, int *rows, int *cols);
+
+/**
+ * @brief Parses a deletion limit, such as "5".
+ *
+ * @param input The limit to parse.
+ * @param max_to_delete Where to store the limit.
+ * @return true if the input is exactly a number, false otherwise.
+ */
+bool parse_max_to_delete (const char *input, int *max_to_delete);
+
+/**
+ * @brief Parses a count given on the command line, such as "2000".
+ *
+ * @param input The count to parse.
+ * @param min The smallest valid count.
+ * @param value Where to store the count.
+ * @return true if the input is exactly a number of at least min, false otherwise.
+ */
+bool parse_count (const char *input, int min, int *value);
+
 /**
  * @brief Flushes and trims the input string.
  *
@@ -76,12 +150,41 @@ void delete_cells (int table[ROWS][COLS], int row, int col);
  */
 int calculate_num_to_delete (int table[ROWS][COLS], int row, int col);
 
+/**
+ * @brief Calculates the number of cells to delete for every cell at once.
+ *
+ * The quadrant of a cell is its own row suffix plus the quadrant of the cell
+ * below it, so the whole matrix is filled in a single O(rows * cols) pass
+ * instead of one walk per cell.
+ *
+ * @param table The game table.
+ * @param counts The matrix to fill with the number of cells each move would delete.
+ * @param legal The masks to fill, bit j of legal[i] is set if the cell (i, j) is a legal move.
+ */
+void calculate_all_num_to_delete (int table[ROWS][COLS], int counts[ROWS][COLS], uint64_t legal[ROWS]);
+
+/**
+ * @brief Lists the possible moves in a caller-provided buffer.
+ *
+ * This function is reentrant: it does not use any static storage, so it can
+ * be called from several threads at once as long as the board configuration
+ * does not change.
+ *
+ * @param table The game table.
+ * @param possible_moves The buffer to fill with the row and column of each move,
+ *        at least board_rows * board_cols entries.
+ * @return The number of possible moves.
+ */
+int calculate_possible_moves (int table[ROWS][COLS], int possible_moves[][2]);
+
 /**
  * @brief Calculates the possible moves.
  *
  * This function calculates the possible moves based on the current state of the
  * game table. It returns a pointer to a static array of possible moves, where each
  * move is represented by a pair of integers indicating the row and column.
+ * The moves are followed by -1 entries. It is a wrapper around
+ * calculate_possible_moves() and is not reentrant.
  *
  * @param table The game table.
  * @return A pointer to a static array of pairs of integers representing the possible moves.
@@ -102,7 +205,8 @@ void play_game (int table[ROWS][COLS], bool *flag);
 /**
  * @brief Initializes the game table.
  *
- * This function initializes the game table by setting all cells to 1.
+ * This function initializes the game table by setting all cells of the
+ * board to 1 and every cell outside the board to 0.
  *
  * @param table The game table.
  */
@@ -19,21 +19,39 @@
 
 /**
  * @def COLS
- * @brief Number of columns in the game board.
+ * @brief Maximum number of columns of the game board.
+ *
+ * Game tables are always allocated with this many columns; only the first
+ * board_cols of them are used.
  */
-#define COLS 9
+#define COLS 64
 
 /**
  * @def ROWS
- * @brief Number of rows in the game board.
+ * @brief Maximum number of rows of the game board.
+ *
+ * Game tables are always allocated with this many rows; only the first
+ * board_rows of them are used.
  */
-#define ROWS 7
+#define ROWS 64
 
 /**
- * @def NUM_MAX_TO_DELETE
- * @brief Maximum number of items to delete in one move.
+ * @def DEFAULT_COLS
+ * @brief Default number of columns in the game board.
+ */
+#define DEFAULT_COLS 9
+
+/**
+ * @def DEFAULT_ROWS
+ * @brief Default number of rows in the game board.
+ */
+#define DEFAULT_ROWS 7
+
+/**
+ * @def DEFAULT_NUM_MAX_TO_DELETE
+ * @brief Default maximum number of items to delete in one move.
  */
-#define NUM_MAX_TO_DELETE 5
+#define DEFAULT_NUM_MAX_TO_DELETE 5
 
 /**
  * @def MAX_INPUT_SIZE
@@ -47,6 +65,12 @@
  */
 #define MAX_VALID_INPUT_SIZE (ROWS * COLS * 5)
 
+/**
+ * @def CELL_LABEL_SIZE
+ * @brief Size of a buffer holding a cell label such as "BL64".
+ */
+#define CELL_LABEL_SIZE 8
+
 /**
  * @def BUFFER_SIZE
  * @brief Size of the buffer.
@@ -60,10 +84,22 @@
 #define MAX_NAME_SIZE 25
 
 /**
- * @var translate
- * @brief Array of strings for translation.
+ * @var board_rows
+ * @brief Number of rows in the game board.
+ */
+extern int board_rows;
+
+/**
+ * @var board_cols
+ * @brief Number of columns in the game board.
+ */
+extern int board_cols;
+
+/**
+ * @var num_max_to_delete
+ * @brief Maximum number of items to delete in one move.
  */
-extern const char *translate[];
+extern int num_max_to_delete;
 
 /**
  * @var player1
@@ -0,0 +1,188 @@
+/**
+ * @file corner_board.h
+ * @brief Sparse Chomp position stored by the corners of its staircase.
+ *
+ * A staircase position is a sequence of runs: consecutive rows that all have
+ * the same length. Each run ends with one corner of the staircase, so a
+ * position with k corners is stored in k nodes whatever the size of the
+ * board. The runs are kept in a treap ordered by their first row, every node
+ * also storing the number of rows and cells of its subtree. Looking up a
+ * cell, counting the cells a move deletes and applying a move then take
+ * O(log k) steps, plus the runs a move removes, and boards of 10^5 x 10^5
+ * cells and more fit in a few kilobytes.
+ *
+ * The moves, deletion counts and legal moves are those of chomp.c, with
+ * 64-bit coordinates instead of an int table. No front end plays on a corner
+ * board: the game and the ai engines use the int table, capped at ROWS x
+ * COLS, and corner boards are only evaluated by analyse_corner_board().
+ */
+
+#ifndef CORNER_BOARD_H
+#define CORNER_BOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "const.h"
+
+/**
+ * @struct corner_run
+ * @brief One run of rows of the same length, a node of the treap.
+ */
+typedef struct {
+    int64_t first_row; /**< First row of the run. */
+    int64_t end_row; /**< Row after the last row of the run. */
+    int64_t len; /**< Length of every row of the run. */
+    int64_t sum_rows; /**< Number of rows of the subtree. */
+    int64_t sum_cells; /**< Number of cells of the subtree. */
+    uint32_t priority; /**< Heap priority of the treap. */
+    int left; /**< Left child, -1 if none. */
+    int right; /**< Right child, -1 if none. */
+} corner_run;
+
+/**
+ * @struct corner_board
+ * @brief A staircase position of any size stored as a treap of runs.
+ *
+ * Removed nodes are chained through their left field and reused, so the
+ * node array only grows with the largest number of corners seen.
+ */
+typedef struct {
+    int64_t rows; /**< Number of rows of the board. */
+    int64_t cols; /**< Number of columns of the board. */
+    int64_t limit; /**< Maximum number of cells a move may delete. */
+    corner_run *nodes; /**< Node storage. */
+    int capacity; /**< Number of allocated nodes. */
+    int num_nodes; /**< Number of nodes ever used. */
+    int free_list; /**< First reusable node, -1 if none. */
+    int num_runs; /**< Number of nodes in the treap. */
+    int root; /**< Root of the treap, -1 for an empty board. */
+    uint32_t rng; /**< State of the priority generator. */
+} corner_board;
+
+/**
+ * @brief Initializes a full board.
+ *
+ * @param board The board to initialize.
+ * @param rows The number of rows, at least 1.
+ * @param cols The number of columns, at least 1.
+ * @param limit The maximum number of cells a move may delete, at least 1.
+ * @return true on success, false if a size is invalid or memory is missing.
+ */
+bool corner_board_init (corner_board *board, int64_t rows, int64_t cols, int64_t limit);
+
+/**
+ * @brief Frees the memory of a board.
+ *
+ * @param board The board.
+ */
+void corner_board_free (corner_board *board);
+
+/**
+ * @brief Builds a board from an int table of the current configuration.
+ *
+ * @param table The game table.
+ * @param board The board to initialize, freed with corner_board_free.
+ * @return true on success, false if memory is missing.
+ */
+bool corner_board_from_table (int table[ROWS][COLS], corner_board *board);
+
+/**
+ * @brief Writes a board back to an int table.
+ *
+ * @param board The board, no bigger than ROWS x COLS.
+ * @param table The game table to fill.
+ */
+void corner_board_to_table (const corner_board *board, int table[ROWS][COLS]);
+
+/**
+ * @brief Checks if the specified cell is still present.
+ *
+ * @param board The board.
+ * @param row The row of the cell.
+ * @param col The column of the cell.
+ * @return true if the cell is present, false if it was eaten or is outside.
+ */
+bool corner_board_is_cell_set (const corner_board *board, int64_t row, int64_t col);
+
+/**
+ * @brief Calculates the number of cells left in a row.
+ *
+ * @param board The board.
+ * @param row The row.
+ * @return The length of the row, 0 if it is empty or outside the board.
+ */
+int64_t corner_board_row_len (const corner_board *board, int64_t row);
+
+/**
+ * @brief Calculates the number of rows longer than a column.
+ *
+ * @param board The board.
+ * @param col The column.
+ * @return The number of cells left in the column.
+ */
+int64_t corner_board_col_len (const corner_board *board, int64_t col);
+
+/**
+ * @brief Calculates the number of cells a move would delete.
+ *
+ * @param board The board.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return The number of cells to delete, 0 if the cell is not present.
+ */
+int64_t corner_board_num_to_delete (const corner_board *board, int64_t row, int64_t col);
+
+/**
+ * @brief Checks if a move is legal.
+ *
+ * @param board The board.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return true if the cell is present and the move deletes at most limit cells.
+ */
+bool corner_board_is_legal_move (const corner_board *board, int64_t row, int64_t col);
+
+/**
+ * @brief Deletes the cells of a move.
+ *
+ * The runs cut by the move are replaced by a single run, merged with the
+ * run below it when they end up with the same length.
+ *
+ * @param board The board.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return true on success, false if memory is missing (the board is unchanged).
+ */
+bool corner_board_delete_cells (corner_board *board, int64_t row, int64_t col);
+
+/**
+ * @brief Calculates the number of cells left on the board.
+ *
+ * @param board The board.
+ * @return The number of cells present.
+ */
+int64_t corner_board_num_cells (const corner_board *board);
+
+/**
+ * @brief Calculates the number of corners of the staircase.
+ *
+ * @param board The board.
+ * @return The number of runs, 0 for an empty board.
+ */
+int corner_board_num_corners (const corner_board *board);
+
+/**
+ * @brief Lists the legal moves in row-major order.
+ *
+ * A legal move deletes at most limit cells, so it lies in one of the last
+ * limit rows of a run and within limit columns of its corner. Only those
+ * cells are looked at.
+ *
+ * @param board The board.
+ * @param possible_moves The buffer to fill with the row and column of each move.
+ * @param max_moves The size of the buffer, extra moves are counted but not written.
+ * @return The number of legal moves.
+ */
+int64_t corner_board_legal_moves (const corner_board *board, int64_t possible_moves[][2], int64_t max_moves);
+
+#endif /* CORNER_BOARD_H */
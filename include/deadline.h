@@ -0,0 +1,63 @@
+/**
+ * @file deadline.h
+ * @brief Deadlines of the engines that think within a time budget.
+ *
+ * A deadline is a point in time, in milliseconds, read from the monotonic
+ * clock: setting the system clock neither stretches nor cuts a budget. The
+ * Makefile defines _POSIX_C_SOURCE for clock_gettime().
+ * The search checks it every SEARCH_CLOCK_NODES positions and the
+ * Monte-Carlo engine after every iteration, a whole random game, so a
+ * check costs little next to the work between two of them.
+ */
+
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+/**
+ * @def NO_DEADLINE
+ * @brief Deadline of a search without time budget.
+ */
+#define NO_DEADLINE 0
+
+/**
+ * @brief Returns the current time.
+ *
+ * @return The current time, in milliseconds.
+ */
+static inline uint64_t
+current_time_ms (void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Computes the deadline of a time budget starting now.
+ *
+ * @param time_budget_ms The time budget, in milliseconds, 0 or less for none.
+ * @return The deadline, NO_DEADLINE if there is no time budget.
+ */
+static inline uint64_t
+deadline_from_budget (int time_budget_ms)
+{
+    return time_budget_ms > 0 ? current_time_ms() + (uint64_t) time_budget_ms : NO_DEADLINE;
+}
+
+/**
+ * @brief Checks if a deadline has passed.
+ *
+ * @param deadline The deadline, NO_DEADLINE for none.
+ * @return true if the deadline has passed.
+ */
+static inline bool
+deadline_passed (uint64_t deadline)
+{
+    return deadline != NO_DEADLINE && current_time_ms() >= deadline;
+}
+
+#endif /* DEADLINE_H */
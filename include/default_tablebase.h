@@ -0,0 +1,78 @@
+/**
+ * @file default_tablebase.h
+ * @brief Tablebase of the default board, generated at build time.
+ *
+ * The Makefile runs make_tablebase, which solves every position of the
+ * default board and writes the result as a C source file compiled into the
+ * game. Perfect play on that board then needs no solving and no file to
+ * read: the table is in the binary, ready from the first move.
+ *
+ * A position takes one byte: the result for the player to move in the high
+ * bit and the cell of an optimal move, row * cols + col, in the low seven.
+ * Positions are numbered in the order of the tablebase, the lexicographic
+ * order of their row lengths, so the entry of a position is at its rank,
+ * see staircase.h.
+ */
+
+#ifndef DEFAULT_TABLEBASE_H
+#define DEFAULT_TABLEBASE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "const.h"
+#include "profile.h"
+
+/**
+ * @def DEFAULT_TABLEBASE_WON
+ * @brief Bit of an entry set if the player to move wins.
+ */
+#define DEFAULT_TABLEBASE_WON 0x80
+
+/**
+ * @def DEFAULT_TABLEBASE_NO_MOVE
+ * @brief Cell of the move of the empty board.
+ */
+#define DEFAULT_TABLEBASE_NO_MOVE 0x7f
+
+/**
+ * @var default_tablebase_rows
+ * @brief Board rows the table was generated for.
+ */
+extern const int default_tablebase_rows;
+
+/**
+ * @var default_tablebase_cols
+ * @brief Board columns the table was generated for.
+ */
+extern const int default_tablebase_cols;
+
+/**
+ * @var default_tablebase_max_to_delete
+ * @brief Deletion limit the table was generated for.
+ */
+extern const int default_tablebase_max_to_delete;
+
+/**
+ * @var default_tablebase_num_positions
+ * @brief Number of positions of the table.
+ */
+extern const uint32_t default_tablebase_num_positions;
+
+/**
+ * @var default_tablebase_entries
+ * @brief Result and optimal move of every position.
+ */
+extern const uint8_t default_tablebase_entries[];
+
+/**
+ * @brief Looks a position up in the generated table.
+ *
+ * @param profile The position.
+ * @param won Where to store true if the player to move wins.
+ * @param row Where to store the row of an optimal move, -1 if the game is over.
+ * @param col Where to store the column of an optimal move, -1 if the game is over.
+ * @return true if the position was found, false if the current board is not the one of the table.
+ */
+bool default_tablebase_probe (const chomp_profile *profile, bool *won, int *row, int *col);
+
+#endif /* DEFAULT_TABLEBASE_H */
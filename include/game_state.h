@@ -0,0 +1,174 @@
+/**
+ * @file game_state.h
+ * @brief Game state keeping the set of legal moves up to date across moves.
+ *
+ * The legal moves of a row always form a suffix of the row: the deletion
+ * count only grows when the chosen cell moves left. The state therefore only
+ * stores, for every row, the first column that is a legal move. A move can
+ * only change that column for the rows it cuts and for the num_max_to_delete
+ * rows above them, so applying a move never rescans the whole board and the
+ * legal moves are listed without computing any deletion count.
+ */
+
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "const.h"
+#include "profile.h"
+
+/**
+ * @struct game_state
+ * @brief A staircase position and its legal moves.
+ *
+ * The legal moves of row i are the columns first_legal[i] to
+ * profile.row_len[i] - 1, the row has none if first_legal[i] equals its
+ * length.
+ */
+typedef struct {
+    chomp_profile profile; /**< Row lengths of the position. */
+    unsigned char first_legal[ROWS]; /**< First legal column of each row. */
+    int num_legal_moves; /**< Number of legal moves of the position. */
+} game_state;
+
+/**
+ * @struct game_state_move
+ * @brief A move played with game_state_make_move().
+ */
+typedef struct {
+    int num_legal_moves; /**< Number of legal moves before the move. */
+    unsigned char row; /**< Row of the chosen cell. */
+    unsigned char first_row; /**< First row whose legal moves were updated. */
+    unsigned char last_row; /**< Last row cut by the move. */
+} game_state_move;
+
+/**
+ * @struct game_state_undo
+ * @brief Undo stack of the moves played with game_state_make_move().
+ *
+ * A move only changes the rows it cuts and the num_max_to_delete rows above
+ * them, so it is undone from the old first legal column of those rows and
+ * the old length of the cut rows. A legal move cuts at most
+ * num_max_to_delete rows, so the stack is sized by the number of moves it
+ * holds, the depth of a search.
+ */
+typedef struct {
+    game_state_move *moves; /**< The moves, the last one on top. */
+    unsigned char *saved; /**< Old first legal columns and row lengths, move after move. */
+    int num_moves; /**< Number of moves on the stack. */
+    int num_saved; /**< Number of bytes of saved used. */
+    int max_moves; /**< Number of moves the stack can hold. */
+} game_state_undo;
+
+/**
+ * @brief Initializes a game state with every cell present.
+ *
+ * @param state The game state to initialize.
+ */
+void game_state_init (game_state *state);
+
+/**
+ * @brief Builds a game state from an int table.
+ *
+ * @param table The game table.
+ * @param state The game state to fill.
+ */
+void game_state_from_table (int table[ROWS][COLS], game_state *state);
+
+/**
+ * @brief Builds a game state from a profile.
+ *
+ * @param profile The row lengths of the position.
+ * @param state The game state to fill.
+ */
+void game_state_from_profile (const chomp_profile *profile, game_state *state);
+
+/**
+ * @brief Applies a move and updates the legal moves.
+ *
+ * Only the rows cut by the move and the num_max_to_delete rows above them
+ * are updated.
+ *
+ * @param state The game state.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ */
+void game_state_apply_move (game_state *state, int row, int col);
+
+/**
+ * @brief Creates an empty undo stack.
+ *
+ * The stack is sized for the current board configuration.
+ *
+ * @param undo The undo stack to initialize.
+ * @param max_moves The number of moves the stack can hold.
+ * @return true if the stack could be allocated, false otherwise.
+ */
+bool game_state_undo_init (game_state_undo *undo, int max_moves);
+
+/**
+ * @brief Frees the memory of an undo stack.
+ *
+ * @param undo The undo stack.
+ */
+void game_state_undo_free (game_state_undo *undo);
+
+/**
+ * @brief Plays a legal move and records how to undo it.
+ *
+ * Same as game_state_apply_move(), the rows it changes are saved first.
+ *
+ * @param state The game state.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @param undo The undo stack, not full.
+ */
+void game_state_make_move (game_state *state, int row, int col, game_state_undo *undo);
+
+/**
+ * @brief Undoes the last move played with game_state_make_move().
+ *
+ * @param state The game state.
+ * @param undo The undo stack, not empty.
+ */
+void game_state_unmake_move (game_state *state, game_state_undo *undo);
+
+/**
+ * @brief Checks if a move is legal.
+ *
+ * @param state The game state.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return true if the move is legal, false otherwise.
+ */
+static inline bool
+game_state_is_legal_move (const game_state *state, int row, int col)
+{
+    return row >= 0 && row < board_rows && col >= state->first_legal[row] && col < state->profile.row_len[row];
+}
+
+/**
+ * @brief Lists the legal moves in row-major order.
+ *
+ * @param state The game state.
+ * @param possible_moves The buffer to fill with the row and column of each move,
+ *        at least state->num_legal_moves entries.
+ * @return The number of legal moves.
+ */
+int game_state_legal_moves (const game_state *state, int possible_moves[][2]);
+
+/**
+ * @brief Chooses a random move in a list of legal moves in row-major order.
+ *
+ * The poisoned cell is the first move in row-major order, it is only chosen
+ * when it is the last legal move.
+ *
+ * @param num_moves The number of legal moves, at least 1.
+ * @param poisoned_first true if the first move is the poisoned cell.
+ * @param random A random number.
+ * @return The index of the chosen move.
+ */
+int64_t random_legal_move_index (int64_t num_moves, bool poisoned_first, uint64_t random);
+
+#endif /* GAME_STATE_H */
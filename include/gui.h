@@ -192,11 +192,21 @@ gboolean update_opponent_move_gui(gpointer data);
  * 
  * This function sets the sensitivity of the game board buttons.
  * It enables or disables the buttons based on the specified sensitivity.
+ * The cells that are not legal moves are greyed out and never enabled.
  *
  * @param sensitive TRUE to enable buttons, FALSE to disable.
  */
 void set_board_sensitive(gboolean sensitive);
 
+/**
+ * @brief Recolours the cells left on the board by legality.
+ * 
+ * The legal moves are shown in blue, the cells that would delete too many
+ * cells are greyed out and disabled. Whether the board is enabled is left
+ * as set by set_board_sensitive().
+ */
+void update_legal_cells();
+
 /**
  * @brief AI chooses its move.
  * 
@@ -0,0 +1,213 @@
+/**
+ * @file mcts.h
+ * @brief Monte-Carlo tree search engine for the Chomp game.
+ *
+ * The engine grows a game tree one path at a time: it walks down the tree
+ * choosing the move with the best UCT value, adds the moves of the leaf it
+ * reaches, plays random games from there and counts their result on every
+ * position of the path. The move played is the most visited one, so the
+ * more iterations the engine is given, the better it plays, on any board
+ * size.
+ *
+ * Random games tell little about a Chomp position, so the results known for
+ * sure are propagated too (MCTS-Solver): a move to a position lost for the
+ * opponent wins, and a position where every move loses is lost. Proven wins
+ * are always played, proven losses never, and the search stops early once
+ * the root is proven. Many move orders lead to the same staircase, so a
+ * position is stored once and shared by all of them, which lets the proofs
+ * and the statistics of a position serve every path reaching it.
+ *
+ * The positions and their moves live in two arenas, the moves of a position
+ * next to each other, with a hash index to find a position again. Once the
+ * game moved on, everything reachable from the new position is kept for the
+ * next search and the rest is dropped. With several threads, each thread
+ * grows its own tree from the same position (root parallelism) and the
+ * visits of the moves are added up.
+ */
+
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+
+/**
+ * @def MCTS_DEFAULT_ITERATIONS
+ * @brief Default number of iterations of each thread per move.
+ */
+#define MCTS_DEFAULT_ITERATIONS 20000
+
+/**
+ * @def MCTS_DEFAULT_NODES
+ * @brief Default number of positions of the arena of each thread.
+ */
+#define MCTS_DEFAULT_NODES (1 << 18)
+
+/**
+ * @def MCTS_EDGES_PER_NODE
+ * @brief Number of moves of the arena of each thread, per position.
+ */
+#define MCTS_EDGES_PER_NODE 8
+
+/**
+ * @def MCTS_MAX_THREADS
+ * @brief Maximum number of threads, and so of trees, of an engine.
+ */
+#define MCTS_MAX_THREADS 64
+
+/**
+ * @def MCTS_EXPLORATION
+ * @brief Weight of the exploration term of the UCT value.
+ */
+#define MCTS_EXPLORATION 1.4
+
+/**
+ * @struct mcts_node
+ * @brief A position of the tree.
+ *
+ * The statistics are counted for the player who moved into the position,
+ * that is the player not to move.
+ */
+typedef struct {
+    uint64_t key; /**< Hash of the position. */
+    uint32_t first_edge; /**< Index of the first move in the move arena, 0 while the position is not expanded. */
+    uint16_t num_edges; /**< Number of moves, one per legal move. */
+    int8_t proven; /**< 1 if the player not to move won for sure, -1 if they lost for sure, 0 otherwise. */
+    uint32_t visits; /**< Number of random games played through the position. */
+    uint32_t wins; /**< Games won by the player not to move. */
+} mcts_node;
+
+/**
+ * @struct mcts_edge
+ * @brief A move of a position.
+ */
+typedef struct {
+    int16_t move; /**< The move, row * COLS + col. */
+    uint32_t child; /**< Index of the position reached, 0 while the move was never played. */
+} mcts_edge;
+
+/**
+ * @struct mcts_tree
+ * @brief The tree grown by one thread.
+ *
+ * Index 0 of both arenas is never used, so that 0 means no position or no
+ * move.
+ */
+typedef struct {
+    mcts_node *nodes; /**< The position arena. */
+    mcts_edge *edges; /**< The move arena. */
+    uint32_t *index; /**< Open addressing hash index of the positions, 0 for a free slot. */
+    uint32_t num_nodes; /**< Number of positions used, index 0 included. */
+    uint32_t num_edges; /**< Number of moves used, index 0 included. */
+    uint32_t node_capacity; /**< Number of positions of the arena. */
+    uint32_t edge_capacity; /**< Number of moves of the arena. */
+    uint32_t index_mask; /**< Number of slots of the hash index minus one. */
+    uint32_t root; /**< Index of the root, 0 while the tree is empty. */
+    uint64_t rng; /**< State of the random number generator of the thread. */
+} mcts_tree;
+
+/**
+ * @struct mcts_engine
+ * @brief The state of a Monte-Carlo engine, kept from one move to the next.
+ */
+typedef struct {
+    mcts_tree *trees; /**< One tree per thread. */
+    int num_threads; /**< Number of threads of a search. */
+    int rows; /**< Board rows the trees were grown for. */
+    int cols; /**< Board columns the trees were grown for. */
+    int max_to_delete; /**< Deletion limit the trees were grown for. */
+    atomic_bool *stop; /**< Set by another thread to stop the running search, NULL if none. */
+    uint64_t playouts; /**< Number of random games played by the last call, all threads included. */
+} mcts_engine;
+
+/**
+ * @struct mcts_result
+ * @brief The move chosen by a Monte-Carlo search.
+ */
+typedef struct {
+    int row; /**< Row of the move, -1 if the game is over. */
+    int col; /**< Column of the move, -1 if the game is over. */
+    uint32_t visits; /**< Random games played through the move, all trees included. */
+    double win_rate; /**< Share of these games won by the player to move. */
+    int proven; /**< 1 if the move is a proven win, -1 if the position is a proven loss, 0 otherwise. */
+} mcts_result;
+
+/**
+ * @var mcts_iterations
+ * @brief Number of iterations of each thread of the ai per move.
+ */
+extern int mcts_iterations;
+
+/**
+ * @var mcts_threads
+ * @brief Number of threads of the ai, 0 for one per processor.
+ */
+extern int mcts_threads;
+
+/**
+ * @brief Creates a Monte-Carlo engine.
+ *
+ * @param engine The engine to initialize.
+ * @param num_nodes The number of positions of the arena of each thread.
+ * @param num_threads The number of threads of a search, 0 for one per processor.
+ * @param seed The seed of the random games.
+ * @return true if the arenas could be allocated, false otherwise.
+ */
+bool mcts_engine_init (mcts_engine *engine, uint32_t num_nodes, int num_threads, uint64_t seed);
+
+/**
+ * @brief Frees the arenas of a Monte-Carlo engine.
+ *
+ * @param engine The engine.
+ */
+void mcts_engine_free (mcts_engine *engine);
+
+/**
+ * @brief Searches the best move of a position.
+ *
+ * If the position is already in the trees, what is reachable from it is
+ * kept and the iterations are added to it. With a time budget, the threads
+ * stop at the deadline even if their iterations are not all done, and so
+ * they do when the stop flag of the engine is set.
+ *
+ * @param engine The engine.
+ * @param state The position.
+ * @param iterations The number of iterations of each thread.
+ * @param time_budget_ms The time the search may take, in milliseconds, 0 for no limit.
+ * @return The chosen move.
+ */
+mcts_result mcts_best_move (mcts_engine *engine, const game_state *state, int iterations, int time_budget_ms);
+
+/**
+ * @brief Chooses the move of the ai with the Monte-Carlo engine.
+ *
+ * The engine is created on the first call and kept for the whole game, so
+ * the tree grown for a move is reused for the next one. It runs
+ * mcts_iterations iterations on mcts_threads threads.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the search may take, in milliseconds, 0 for no limit.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over or the engine could not be created.
+ */
+bool mcts_ai_move (const game_state *state, int time_budget_ms, int *row, int *col);
+
+/**
+ * @brief Grows the trees of the ai from a position of the opponent while it waits.
+ *
+ * The engine of mcts_ai_move() runs mcts_iterations iterations or until stop
+ * is set. The tree is reused from the position the opponent moves to, so the
+ * most likely replies already have their statistics.
+ *
+ * @param state The position, the opponent to move.
+ * @param stop Set by another thread to stop the search.
+ * @return true if the position was searched, false if the game is over or the engine could not be created.
+ */
+bool mcts_ai_ponder (const game_state *state, atomic_bool *stop);
+
+#endif /* MCTS_H */
@@ -13,6 +13,12 @@
 #include <netinet/in.h>
 #include "chomp.h"
 
+/**
+ * @def NETWORK_CONFIG_MESSAGE_SIZE
+ * @brief Size of the message holding the board configuration, in bytes.
+ */
+#define NETWORK_CONFIG_MESSAGE_SIZE 32
+
 extern int last_col_played_term_serv;
 extern int last_row_played_term_serv;
 extern int client_socket;
@@ -35,7 +41,8 @@ int start_server (short port);
  *
  * This function initializes the client and connects it to the server
  * specified by the IP address and port number. It sets up the necessary
- * socket and establishes the connection.
+ * socket, establishes the connection and checks that the server plays on
+ * the same board, exiting the program if it does not.
  *
  * @param ip The IP address of the server.
  * @param port The port number of the server.
@@ -43,6 +50,29 @@ int start_server (short port);
  */
 int start_client (const char *ip, short port);
 
+/**
+ * @brief Accepts the connection of a client on the server socket.
+ *
+ * This function waits for a client and checks that it plays on the same
+ * board as the server, exiting the program if it does not.
+ *
+ * @param server_socket The server socket file descriptor.
+ * @return The client socket file descriptor.
+ */
+int accept_client (int server_socket);
+
+/**
+ * @brief Checks that both players use the same board configuration.
+ *
+ * This function sends the rows, columns and deletion limit of the board
+ * and compares them with those received from the other side. Both sides
+ * call it once, right after the connection is established.
+ *
+ * @param socket The socket file descriptor.
+ * @return true if the other side uses the same configuration, false otherwise.
+ */
+bool exchange_board_config (int socket);
+
 /**
  * @brief Sends a move to the specified socket.
  *
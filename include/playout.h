@@ -0,0 +1,73 @@
+/**
+ * @file playout.h
+ * @brief Random playouts, several games at once in SIMD lanes.
+ *
+ * A playout plays uniformly random legal moves from a position until the
+ * poisoned cell is eaten. The batch kernel keeps PLAYOUT_LANES bitboards in
+ * one vector and advances all of them in lock step: the legal moves, the
+ * random numbers and the choice of the move are computed for every lane with
+ * the same vector instructions. Finished games simply stop changing until
+ * the whole batch is over.
+ *
+ * The vector code uses the GCC vector extensions, so it is compiled to
+ * whatever the target supports (SSE2 by default, AVX2 or AVX-512 with the
+ * matching -m flags). Other compilers and boards of more than 64 cells use
+ * scalar playouts.
+ */
+
+#ifndef PLAYOUT_H
+#define PLAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "const.h"
+#include "bitboard.h"
+#include "game_state.h"
+
+/**
+ * @def PLAYOUT_LANES
+ * @brief Number of games advanced together by the batch kernel.
+ */
+#ifdef __AVX512F__
+#define PLAYOUT_LANES 16
+#else
+#define PLAYOUT_LANES 8
+#endif
+
+/**
+ * @brief Plays one random game from each board.
+ *
+ * The boards are processed PLAYOUT_LANES at a time. The result does not
+ * depend on the instruction set, only on the seed.
+ *
+ * @param boards The starting positions, the board must fit in a bitboard.
+ * @param num_boards The number of positions.
+ * @param seed The seed of the random moves.
+ * @param wins The array to fill, wins[i] is true if the player to move in boards[i] won.
+ */
+void playout_batch (const bitboard boards[], int num_boards, uint64_t seed, bool wins[]);
+
+/**
+ * @brief Plays one random game from a board, one move at a time.
+ *
+ * Reference implementation of the batch kernel, it picks the same moves
+ * as the lane that uses the same random number generator state.
+ *
+ * @param board The starting position.
+ * @param rng The state of the random number generator, updated.
+ * @return true if the player to move won.
+ */
+bool playout_scalar (bitboard board, uint64_t *rng);
+
+/**
+ * @brief Plays one random game from a game state.
+ *
+ * This is the fallback for boards that do not fit in a bitboard.
+ *
+ * @param state The starting position, left unchanged.
+ * @param rng The state of the random number generator, updated.
+ * @return true if the player to move won.
+ */
+bool playout_state (const game_state *state, uint64_t *rng);
+
+#endif /* PLAYOUT_H */
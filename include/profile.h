@@ -0,0 +1,145 @@
+/**
+ * @file profile.h
+ * @brief Staircase (row-length profile) representation of a Chomp position.
+ *
+ * Every reachable Chomp position is a monotone staircase: each row is a run
+ * of cells starting at column 0 and no row is longer than the row above it.
+ * A position is therefore fully described by its board_rows non-increasing
+ * row lengths. Moves, deletion counts and legality checks work directly on
+ * those lengths in O(board_rows), and the profile itself is a compact key
+ * for caching and hashing positions.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "const.h"
+
+/**
+ * @struct chomp_profile
+ * @brief Row lengths of a staircase position.
+ *
+ * row_len[i] is the number of cells left in row i. The lengths are
+ * non-increasing from row 0 downwards. Rows past board_rows are kept at zero
+ * so two profiles can be compared with memcmp.
+ */
+typedef struct {
+    unsigned char row_len[ROWS]; /**< Number of cells left in each row. */
+} chomp_profile;
+
+/**
+ * @brief Initializes a profile with every cell present.
+ *
+ * @param profile The profile to initialize.
+ */
+void profile_init (chomp_profile *profile);
+
+/**
+ * @brief Builds a profile from an int table.
+ *
+ * The length of a row is the number of consecutive cells present from
+ * column 0, which is the whole row for any staircase position.
+ *
+ * @param table The game table.
+ * @param profile The profile to fill.
+ */
+void profile_from_table (int table[ROWS][COLS], chomp_profile *profile);
+
+/**
+ * @brief Writes a profile back to an int table.
+ *
+ * @param profile The profile.
+ * @param table The game table to fill.
+ */
+void profile_to_table (const chomp_profile *profile, int table[ROWS][COLS]);
+
+/**
+ * @brief Checks if the specified cell is still present.
+ *
+ * @param profile The profile.
+ * @param row The row of the cell.
+ * @param col The column of the cell.
+ * @return true if the cell is present, false if it was eaten.
+ */
+static inline bool
+profile_is_cell_set (const chomp_profile *profile, int row, int col)
+{
+    return col < profile->row_len[row];
+}
+
+/**
+ * @brief Calculates the number of cells a move would delete.
+ *
+ * Only the rows from the chosen one that are longer than the chosen column
+ * contribute, and they form a contiguous block, so the walk stops at the
+ * first shorter row.
+ *
+ * @param profile The profile.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return The number of cells to delete.
+ */
+int profile_num_to_delete (const chomp_profile *profile, int row, int col);
+
+/**
+ * @brief Checks if a move is legal.
+ *
+ * A move is legal if its cell is present and it deletes at most
+ * num_max_to_delete cells. The count stops as soon as the limit is exceeded.
+ *
+ * @param profile The profile.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return true if the move is legal, false otherwise.
+ */
+bool profile_is_legal_move (const chomp_profile *profile, int row, int col);
+
+/**
+ * @brief Applies a move to a profile.
+ *
+ * Every row from the chosen one that is longer than the chosen column is
+ * cut down to that column.
+ *
+ * @param profile The profile.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ */
+void profile_delete_cells (chomp_profile *profile, int row, int col);
+
+/**
+ * @brief Calculates the number of cells left in a column.
+ *
+ * @param profile The profile.
+ * @param col The column.
+ * @return The number of rows longer than the column.
+ */
+int profile_col_len (const chomp_profile *profile, int col);
+
+/**
+ * @brief Calculates the number of cells left on the board.
+ *
+ * @param profile The profile.
+ * @return The number of cells present.
+ */
+int profile_num_cells (const chomp_profile *profile);
+
+/**
+ * @brief Hashes a profile.
+ *
+ * @param profile The profile.
+ * @return A 64-bit hash of the row lengths.
+ */
+uint64_t profile_hash (const chomp_profile *profile);
+
+/**
+ * @brief Compares two profiles.
+ *
+ * @param a The first profile.
+ * @param b The second profile.
+ * @return true if both profiles describe the same position.
+ */
+bool profile_equal (const chomp_profile *a, const chomp_profile *b);
+
+#endif /* PROFILE_H */
@@ -0,0 +1,230 @@
+/**
+ * @file search.h
+ * @brief Alpha-beta search engine for the Chomp game.
+ *
+ * The engine searches the game tree with negamax and alpha-beta pruning.
+ * The depth doubles from one iteration to the next (iterative deepening)
+ * until the result of the position is proven, the depth limit is reached or
+ * the time budget runs out.
+ * Every position searched is stored in a transposition table indexed by its
+ * Zobrist hash, and the best move found there is tried first the next time,
+ * followed by the killer moves of the ply.
+ *
+ * The search can run on several threads. Once the first move of a node close
+ * to the root has been searched, the other moves are pushed as tasks on the
+ * deque of the thread, where idle threads steal them (young brothers wait).
+ * The threads share the transposition table without any lock.
+ *
+ * A position is won or lost, there is no draw: a proven score is
+ * SEARCH_WIN_SCORE minus the number of plies before the poisoned cell is
+ * eaten, positive if the player to move wins. A position searched up to the
+ * depth limit without a proof scores 0. Proofs are reused from one search
+ * to the next whatever their length, so the number of plies is the one of
+ * the line found, not always the shortest win or the longest defence.
+ */
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "const.h"
+#include "game_state.h"
+
+/**
+ * @def SEARCH_WIN_SCORE
+ * @brief Score of a position won right away.
+ */
+#define SEARCH_WIN_SCORE 1000000
+
+/**
+ * @def SEARCH_MAX_PLY
+ * @brief Longest game, every move eats at least one cell.
+ */
+#define SEARCH_MAX_PLY (ROWS * COLS)
+
+/**
+ * @def SEARCH_DEFAULT_TABLE_BITS
+ * @brief Default transposition table size, as a power of two.
+ */
+#define SEARCH_DEFAULT_TABLE_BITS 20
+
+/**
+ * @def SEARCH_DEFAULT_DEPTH
+ * @brief Default depth limit of the search, in plies.
+ */
+#define SEARCH_DEFAULT_DEPTH 64
+
+/**
+ * @def SEARCH_PROVEN_DEPTH
+ * @brief Depth stored with a proven score, deeper than any search.
+ */
+#define SEARCH_PROVEN_DEPTH 16383
+
+/**
+ * @def SEARCH_MAX_THREADS
+ * @brief Maximum number of threads of a search.
+ */
+#define SEARCH_MAX_THREADS 64
+
+/**
+ * @def SEARCH_SPLIT_PLY
+ * @brief Only the nodes closer to the root than this ply share their moves.
+ */
+#define SEARCH_SPLIT_PLY 3
+
+/**
+ * @def SEARCH_SPLIT_DEPTH
+ * @brief Only the nodes searched at least this deep share their moves.
+ */
+#define SEARCH_SPLIT_DEPTH 4
+
+/**
+ * @enum search_bound
+ * @brief What a stored score says about the real score.
+ */
+typedef enum {
+    SEARCH_EXACT = 0, /**< The score is exact. */
+    SEARCH_LOWER, /**< The real score is at least the stored one. */
+    SEARCH_UPPER /**< The real score is at most the stored one. */
+} search_bound;
+
+/**
+ * @struct search_entry
+ * @brief A position stored in the transposition table.
+ *
+ * The score (proven scores counted from this position), the best move
+ * (row * COLS + col), the depth searched (SEARCH_PROVEN_DEPTH if the score is
+ * proven) and the bound are packed in one word. The hash is stored xor that
+ * word, so an entry torn by two threads writing it at once matches no
+ * position and is ignored.
+ */
+typedef struct {
+    _Atomic uint64_t check; /**< Zobrist hash of the position xor data. */
+    _Atomic uint64_t data; /**< Packed score, move, depth and bound. */
+} search_entry;
+
+/**
+ * @struct search_engine
+ * @brief The state of a search engine, kept from one move to the next.
+ */
+typedef struct {
+    search_entry *table; /**< The transposition table. */
+    uint64_t mask; /**< Number of entries minus one. */
+    int rows; /**< Board rows the table was filled for. */
+    int cols; /**< Board columns the table was filled for. */
+    int max_to_delete; /**< Deletion limit the table was filled for. */
+    int num_threads; /**< Number of threads of a search. */
+    atomic_bool *stop; /**< Set by another thread to stop the running search, NULL if none. */
+    uint64_t nodes; /**< Number of positions searched by the last call, all threads included. */
+} search_engine;
+
+/**
+ * @struct search_result
+ * @brief The move chosen by a search.
+ */
+typedef struct {
+    int row; /**< Row of the move, -1 if the game is over or the search could not start. */
+    int col; /**< Column of the move, -1 if the game is over or the search could not start. */
+    int score; /**< Score of the position for the player to move. */
+    int depth; /**< Depth of the last complete iteration. */
+} search_result;
+
+/**
+ * @var search_depth
+ * @brief Depth limit of the ai search, in plies, 0 for none.
+ */
+extern int search_depth;
+
+/**
+ * @var search_threads
+ * @brief Number of threads of the ai search, 0 for one per processor.
+ */
+extern int search_threads;
+
+/**
+ * @brief Creates a search engine.
+ *
+ * @param engine The engine to initialize.
+ * @param table_bits The transposition table holds 2^table_bits entries.
+ * @param num_threads The number of threads of a search, 0 for one per processor.
+ * @return true if the table could be allocated, false otherwise.
+ */
+bool search_engine_init (search_engine *engine, int table_bits, int num_threads);
+
+/**
+ * @brief Frees the transposition table of a search engine.
+ *
+ * @param engine The engine.
+ */
+void search_engine_free (search_engine *engine);
+
+/**
+ * @brief Empties the transposition table.
+ *
+ * @param engine The engine.
+ */
+void search_engine_clear (search_engine *engine);
+
+/**
+ * @brief Computes the Zobrist hash of a position.
+ *
+ * The hash is the xor of one random key per row and row length, so a move
+ * only updates the keys of the rows it cuts.
+ *
+ * @param profile The position.
+ * @return The hash of the position.
+ */
+uint64_t search_hash (const chomp_profile *profile);
+
+/**
+ * @brief Searches the best move of a position.
+ *
+ * The transposition table is kept between calls, it is only emptied when
+ * the board configuration changed since the last call.
+ *
+ * With a time budget, the iteration running when the deadline passes is
+ * dropped and the move of the last complete one is returned. The first
+ * iteration always completes, so there is a move however small the budget.
+ * The same happens when the stop flag of the engine is set.
+ *
+ * @param engine The engine.
+ * @param state The position.
+ * @param max_depth The depth limit, in plies.
+ * @param time_budget_ms The time the search may take, in milliseconds, 0 for no limit.
+ * @return The best move found and its score.
+ */
+search_result search_best_move (search_engine *engine, const game_state *state, int max_depth, int time_budget_ms);
+
+/**
+ * @brief Chooses the move of the ai with the search engine.
+ *
+ * The engine is created on the first call and kept for the whole game, the
+ * search and the solver engines of the ai share it. It runs on
+ * search_threads threads.
+ *
+ * @param state The position.
+ * @param max_depth The depth limit, in plies, 0 to search until the result is proven.
+ * @param time_budget_ms The time the search may take, in milliseconds, 0 for no limit.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over or the engine could not be created.
+ */
+bool search_ai_move (const game_state *state, int max_depth, int time_budget_ms, int *row, int *col);
+
+/**
+ * @brief Searches a position of the opponent for the ai while it waits.
+ *
+ * The search runs on the engine of search_ai_move() until it is over or
+ * stop is set. Everything it proves stays in the transposition table, so
+ * the reply to the move the opponent plays is found faster.
+ *
+ * @param state The position, the opponent to move.
+ * @param max_depth The depth limit, in plies, 0 to search until the result is proven.
+ * @param stop Set by another thread to stop the search.
+ * @return true if the position was searched, false if the game is over or the engine could not be created.
+ */
+bool search_ai_ponder (const game_state *state, int max_depth, atomic_bool *stop);
+
+#endif /* SEARCH_H */
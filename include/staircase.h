@@ -0,0 +1,97 @@
+/**
+ * @file staircase.h
+ * @brief Dense numbering of the staircase positions of a board.
+ *
+ * A board of R rows and C columns has C(R + C, R) staircase positions. They
+ * are numbered from 0 to C(R + C, R) - 1 in lexicographic order of their row
+ * lengths, row 0 first, with the combinatorial number system: the positions
+ * coming before one because its row i has len cells instead of fewer are the
+ * non-increasing sequences of R - i lengths up to len - 1, and there are
+ * C(R - i - 1 + len, R - i) of them. The rank of a position is the sum of
+ * those counts over its rows, read from a table of binomial coefficients.
+ *
+ * The rank is a perfect hash: every position of the board has its own slot
+ * in a flat array of C(R + C, R) entries, with no key to store and no
+ * collision to resolve. A move only shortens rows, so it always leads to a
+ * position of smaller rank, and the ranks are a topological order of the
+ * game.
+ */
+
+#ifndef STAIRCASE_H
+#define STAIRCASE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "const.h"
+#include "profile.h"
+
+/**
+ * @def STAIRCASE_TOO_MANY
+ * @brief Binomial coefficient, or number of positions, too large for 64 bits.
+ */
+#define STAIRCASE_TOO_MANY UINT64_MAX
+
+/**
+ * @var staircase_binomials
+ * @brief Binomial coefficients C(n, k), STAIRCASE_TOO_MANY when they do not fit in 64 bits.
+ *
+ * Built at startup, C(n, k) is 0 when k > n.
+ */
+extern uint64_t staircase_binomials[ROWS + COLS + 1][ROWS + 1];
+
+/**
+ * @brief Counts the staircase positions of a board.
+ *
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @return C(rows + cols, rows), or STAIRCASE_TOO_MANY if it does not fit in 64 bits.
+ */
+static inline uint64_t
+staircase_count (int rows, int cols)
+{
+    return staircase_binomials[rows + cols][rows];
+}
+
+/**
+ * @brief Returns the number of a position in lexicographic order of its row lengths.
+ *
+ * Only exact when staircase_count(rows, cols) is not STAIRCASE_TOO_MANY.
+ *
+ * @param profile The position, whose rows past rows are ignored.
+ * @param rows The number of rows of the board.
+ * @return The rank of the position, below staircase_count(rows, cols).
+ */
+static inline uint64_t
+staircase_rank (const chomp_profile *profile, int rows)
+{
+    uint64_t rank = 0;
+    for (int i = 0; i < rows && profile->row_len[i] != 0; i++) {
+        rank += staircase_binomials[rows - i - 1 + profile->row_len[i]][rows - i];
+    }
+    return rank;
+}
+
+/**
+ * @brief Builds the position of a rank.
+ *
+ * @param rank The rank, below staircase_count(rows, cols).
+ * @param rows The number of rows of the board.
+ * @param cols The number of columns of the board.
+ * @param profile Where to store the position, its rows past rows emptied.
+ */
+void staircase_unrank (uint64_t rank, int rows, int cols, chomp_profile *profile);
+
+/**
+ * @brief Moves to the position of the next rank.
+ *
+ * The last row that can be lengthened is, and the rows below it are
+ * emptied.
+ *
+ * @param profile The position, changed in place.
+ * @param rows The number of rows of the board.
+ * @param cols The number of columns of the board.
+ * @return true if there is a next position, false if the board is full.
+ */
+bool staircase_next (chomp_profile *profile, int rows, int cols);
+
+#endif /* STAIRCASE_H */
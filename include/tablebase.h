@@ -0,0 +1,129 @@
+/**
+ * @file tablebase.h
+ * @brief Perfect play tablebase of the Chomp game.
+ *
+ * A position is a staircase, so a board of R rows and C columns has only
+ * C(R + C, R) of them: 11440 on the default 7x9 board. The tablebase solves
+ * all of them once and then answers any position instantly, with its result,
+ * its distance to the end and an optimal move.
+ *
+ * The positions are numbered in lexicographic order of their row lengths.
+ * A move only shortens rows, so every position reached by a move comes
+ * before the position it was played from: solving the positions in that
+ * order, from the empty board up, is a retrograde analysis where every move
+ * leads to a position already solved. The winner plays the fastest win and
+ * the loser the longest defence. The results are flat arrays indexed by
+ * the rank of the positions, see staircase.h.
+ */
+
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+
+/**
+ * @def TABLEBASE_MAX_POSITIONS
+ * @brief Largest number of positions of a board the tablebase solves.
+ */
+#define TABLEBASE_MAX_POSITIONS (1u << 22)
+
+/**
+ * @def TABLEBASE_NO_MOVE
+ * @brief Best move of the empty board.
+ */
+#define TABLEBASE_NO_MOVE (-1)
+
+/**
+ * @struct tablebase
+ * @brief The solved positions of a board.
+ *
+ * The distance of a position is the number of plies left before the
+ * poisoned cell is eaten, with perfect play. The empty board, whose player
+ * to move won, is at distance 0, so a position is won for the player to
+ * move if and only if its distance is even.
+ */
+typedef struct {
+    int rows; /**< Board rows the tablebase was solved for, 0 if it is empty. */
+    int cols; /**< Board columns the tablebase was solved for. */
+    int max_to_delete; /**< Deletion limit the tablebase was solved for. */
+    uint32_t num_positions; /**< Number of positions, C(rows + cols, rows). */
+    uint16_t *distance; /**< Distance to the end of each position. */
+    int16_t *best_move; /**< Optimal move of each position, row * COLS + col, TABLEBASE_NO_MOVE for the empty board. */
+} tablebase;
+
+/**
+ * @struct tablebase_result
+ * @brief What the tablebase knows of a position.
+ */
+typedef struct {
+    bool won; /**< true if the player to move wins with perfect play. */
+    int distance; /**< Number of plies left before the poisoned cell is eaten. */
+    int row; /**< Row of an optimal move, -1 if the game is over. */
+    int col; /**< Column of an optimal move, -1 if the game is over. */
+} tablebase_result;
+
+/**
+ * @brief Counts the positions of a board.
+ *
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @return C(rows + cols, rows), or TABLEBASE_MAX_POSITIONS + 1 if there are more.
+ */
+uint32_t tablebase_num_positions (int rows, int cols);
+
+/**
+ * @brief Solves every position of the current board configuration.
+ *
+ * @param tb The tablebase to fill, freed with tablebase_free().
+ * @return true if the tablebase was solved, false if the board has too many positions or memory ran out.
+ */
+bool tablebase_solve (tablebase *tb);
+
+/**
+ * @brief Frees a tablebase and empties it.
+ *
+ * @param tb The tablebase.
+ */
+void tablebase_free (tablebase *tb);
+
+/**
+ * @brief Looks a position up in a tablebase.
+ *
+ * @param tb The tablebase.
+ * @param profile The position.
+ * @param result Where to store the result, distance and optimal move.
+ * @return true if the position was found, false if the tablebase is for another board.
+ */
+bool tablebase_probe (const tablebase *tb, const chomp_profile *profile, tablebase_result *result);
+
+/**
+ * @brief Solves the tablebase of the ai for the current board.
+ *
+ * The tablebase is kept until the board changes, so it is only solved again
+ * after a change of board.
+ *
+ * @return true if the tablebase of the current board is ready, false if the board is too large or memory is missing.
+ */
+bool tablebase_ai_prepare (void);
+
+/**
+ * @brief Chooses the move of the ai with the tablebase.
+ *
+ * Without a time budget, the tablebase of the current board is solved on
+ * the first call. With one, it is only read if tablebase_ai_prepare() solved
+ * it beforehand: solving a large board takes seconds, far more than a move
+ * may last.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the ai may think, in milliseconds, 0 for none.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over, the board is too large or the tablebase is not solved in time.
+ */
+bool tablebase_ai_move (const game_state *state, int time_budget_ms, int *row, int *col);
+
+#endif /* TABLEBASE_H */
@@ -0,0 +1,159 @@
+/**
+ * @file tablebase_file.h
+ * @brief Tablebase files, mapped in memory and read on demand.
+ *
+ * The tablebase of a large board takes seconds to solve, so it is solved
+ * once and written to a file. A file holds a header (magic, version, board
+ * size, deletion limit, indexing scheme, number of positions, compression
+ * and block size) followed by one bit per position, set if the player to
+ * move wins, every field written in little-endian order.
+ *
+ * The file is opened with mmap: opening it reads nothing but the header, the
+ * pages are only loaded when a position is probed, and every process
+ * reading the same file shares one copy of it in the page cache. The
+ * optimal move is not stored: it is found by probing the positions reached
+ * by the legal moves, a winning move being one that leaves a lost position.
+ *
+ * The bits can be compressed by blocks of positions. Most positions are won,
+ * so a block stores which of its positions have the rarer result, as the
+ * gaps between them in a Rice code. An index of the offsets of the blocks
+ * follows the header, a probe decodes one block only, and the last blocks
+ * decoded are kept in a small cache, the moves of a position often leading
+ * to the same blocks.
+ */
+
+#ifndef TABLEBASE_FILE_H
+#define TABLEBASE_FILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+#include "tablebase.h"
+
+/**
+ * @def TABLEBASE_FILE_MAGIC
+ * @brief First bytes of a tablebase file.
+ */
+#define TABLEBASE_FILE_MAGIC "CHOMPTB"
+
+/**
+ * @def TABLEBASE_FILE_VERSION
+ * @brief Version of the tablebase file format.
+ *
+ * Version 1 files have no compression nor block size in their header, they
+ * are read as uncompressed files.
+ */
+#define TABLEBASE_FILE_VERSION 2
+
+/**
+ * @def TABLEBASE_FILE_HEADER_SIZE
+ * @brief Size of the header of a tablebase file, in bytes.
+ */
+#define TABLEBASE_FILE_HEADER_SIZE 40
+
+/**
+ * @def TABLEBASE_INDEX_LEXICOGRAPHIC
+ * @brief Indexing scheme numbering the positions in lexicographic order of their row lengths.
+ */
+#define TABLEBASE_INDEX_LEXICOGRAPHIC 1
+
+/**
+ * @def TABLEBASE_COMPRESSION_NONE
+ * @brief The bits of the positions are stored as they are.
+ */
+#define TABLEBASE_COMPRESSION_NONE 0
+
+/**
+ * @def TABLEBASE_COMPRESSION_RICE
+ * @brief Blocks storing the gaps between the positions of the rarer result in a Rice code.
+ */
+#define TABLEBASE_COMPRESSION_RICE 1
+
+/**
+ * @def TABLEBASE_BLOCK_POSITIONS
+ * @brief Number of positions of a compressed block, a multiple of 8.
+ */
+#define TABLEBASE_BLOCK_POSITIONS 4096
+
+/**
+ * @def TABLEBASE_CACHE_BLOCKS
+ * @brief Number of decoded blocks kept by a tablebase file.
+ */
+#define TABLEBASE_CACHE_BLOCKS 64
+
+/**
+ * @struct tablebase_file
+ * @brief A tablebase file mapped in memory.
+ *
+ * The cache of the decoded blocks is changed by the probes, so a file is
+ * probed by one thread at a time.
+ */
+typedef struct {
+    int rows; /**< Board rows of the tablebase, 0 if no file is open. */
+    int cols; /**< Board columns of the tablebase. */
+    int max_to_delete; /**< Deletion limit of the tablebase. */
+    uint32_t num_positions; /**< Number of positions. */
+    int compression; /**< TABLEBASE_COMPRESSION_NONE or TABLEBASE_COMPRESSION_RICE. */
+    uint32_t block_positions; /**< Number of positions of a compressed block. */
+    uint32_t num_blocks; /**< Number of compressed blocks. */
+    const unsigned char *block_index; /**< Offset of each block from the data, and the end of the last one, in the mapping. */
+    const unsigned char *data; /**< The bits of the positions or the blocks, in the mapping. */
+    size_t data_size; /**< Size of the data, in bytes. */
+    void *mapping; /**< The whole file, mapped read-only. */
+    size_t mapping_size; /**< Size of the mapping, in bytes. */
+    unsigned char *cache_bits; /**< The bits of the decoded blocks, block_positions / 8 bytes each. */
+    uint32_t cache_block[TABLEBASE_CACHE_BLOCKS]; /**< Block decoded in each entry of the cache, UINT32_MAX for none. */
+    uint64_t cache_used[TABLEBASE_CACHE_BLOCKS]; /**< Last use of each entry of the cache. */
+    uint64_t cache_clock; /**< Number of blocks read, dating the uses of the entries. */
+    uint64_t blocks_decoded; /**< Number of blocks decoded since the file was opened. */
+} tablebase_file;
+
+/**
+ * @brief Writes a solved tablebase to a file.
+ *
+ * @param tb The tablebase.
+ * @param path The path of the file.
+ * @param compression TABLEBASE_COMPRESSION_NONE or TABLEBASE_COMPRESSION_RICE.
+ * @return true if the file was written, false otherwise.
+ */
+bool tablebase_file_write (const tablebase *tb, const char *path, int compression);
+
+/**
+ * @brief Maps a tablebase file in memory.
+ *
+ * Only the header is read, the results are loaded by the system when they
+ * are probed.
+ *
+ * @param file The tablebase file to fill, closed with tablebase_file_close().
+ * @param path The path of the file.
+ * @return true if the file is a valid tablebase, false otherwise.
+ */
+bool tablebase_file_open (tablebase_file *file, const char *path);
+
+/**
+ * @brief Unmaps a tablebase file.
+ *
+ * @param file The tablebase file.
+ */
+void tablebase_file_close (tablebase_file *file);
+
+/**
+ * @brief Looks a position up in a tablebase file.
+ *
+ * The move is a winning one if there is one. Otherwise it is the legal
+ * move eating the fewest cells, the poisoned cell only if it is the last
+ * one.
+ *
+ * @param file The tablebase file.
+ * @param state The position.
+ * @param won Where to store true if the player to move wins.
+ * @param row Where to store the row of an optimal move, -1 if the game is over.
+ * @param col Where to store the column of an optimal move, -1 if the game is over.
+ * @return true if the position was found, false if the file is for another board or a block is corrupted.
+ */
+bool tablebase_file_probe (tablebase_file *file, const game_state *state, bool *won, int *row, int *col);
+
+#endif /* TABLEBASE_FILE_H */
@@ -15,6 +15,8 @@
 #include <ctype.h>
 #include "chomp.h"
 #include "const.h"
+#include "ai.h"
+#include "profile.h"
 
 /**
  * @brief Calculate the number of cells in a row.
@@ -29,7 +31,7 @@ int
 number_of_cells_in_row (int table[ROWS][COLS], int row)
 {
     int num_cell_in_row = 0;
-    for (int i = 0; i < COLS; i++) {
+    for (int i = 0; i < board_cols; i++) {
         if (table[row][i] == 1) {
             num_cell_in_row++;
         } else {
@@ -52,7 +54,7 @@ int
 number_of_cells_in_col (int table[ROWS][COLS], int col)
 {
     int num_cell_in_col = 0;
-    for (int i = 0; i < ROWS; i++) {
+    for (int i = 0; i < board_rows; i++) {
         if (table[i][col] == 1) {
             num_cell_in_col++;
         } else {
@@ -87,22 +89,123 @@ number_of_cells_in_square (int table[ROWS][COLS], int row, int col)
     return num_cell_in_square;
 }
 
+/**
+ * @brief Builds the board profile of a table.
+ * 
+ * This function reads every row once, since the table is a staircase
+ * position, which every position of a game is.
+ * 
+ * @param table A 2D array representing the game table.
+ * @param profile The board profile to fill.
+ */
+void
+board_profile_from_table (int table[ROWS][COLS], board_profile *profile)
+{
+    chomp_profile position;
+    profile_from_table(table, &position);
+    board_profile_from_profile(&position, profile);
+}
+
+/**
+ * @brief Builds the board profile of a position given by its row lengths.
+ * 
+ * The column lengths and the number of cells inside the corner are derived
+ * from the row lengths, without any table.
+ * 
+ * @param position The row lengths of the position.
+ * @param profile The board profile to fill.
+ */
+void
+board_profile_from_profile (const chomp_profile *position, board_profile *profile)
+{
+    profile->row_len[0] = position->row_len[0];
+    profile->row_len[1] = position->row_len[1];
+    profile->col_len[0] = profile_col_len(position, 0);
+    profile->col_len[1] = profile_col_len(position, 1);
+    profile->num_cells_inside = 0;
+    if (profile->col_len[0] > 0) {
+        profile->num_cells_inside = profile_num_cells(position) - profile->row_len[0] - (profile->col_len[0] - 1);
+    }
+    profile->cols = board_cols;
+    profile->max_to_delete = num_max_to_delete;
+}
+
+/**
+ * @brief Reduces the length of an arm modulo the deletion limit.
+ * 
+ * An arm of a line or of a corner is a subtraction game where each move
+ * removes 1 to max_to_delete cells, so only its length modulo
+ * max_to_delete + 1 matters.
+ * 
+ * @param profile The board profile, for its deletion limit.
+ * @param num_cells The number of cells of the arm, the poisoned cell excluded.
+ * @return The length of the arm modulo max_to_delete + 1.
+ */
+static int64_t
+arm_residue (const board_profile *profile, int64_t num_cells)
+{
+    return num_cells % (profile->max_to_delete + 1);
+}
+
+/**
+ * @brief Checks if a two rows or two columns position is lost.
+ * 
+ * With lengths a >= b, the player to move loses exactly when
+ * a - b - 1 is a multiple of max_to_delete + 1.
+ * 
+ * @param profile The board profile, for its deletion limit.
+ * @param longer The length of the longer line.
+ * @param shorter The length of the shorter line.
+ * @return True if the player to move loses, otherwise false.
+ */
+static bool
+is_losing_rectangle (const board_profile *profile, int64_t longer, int64_t shorter)
+{
+    return longer > shorter && arm_residue(profile, longer - shorter - 1) == 0;
+}
+
+/**
+ * @brief Returns the cell of the winning move of a two lines position.
+ * 
+ * If both lines have the same length, the last cell of the second line is
+ * taken. Otherwise the first line is cut so that it is one cell longer than
+ * the second line modulo max_to_delete + 1.
+ * 
+ * @param profile The board profile, for its deletion limit.
+ * @param longer The length of the first line.
+ * @param shorter The length of the second line.
+ * @param line Where to store the line of the move, 0 or 1.
+ * @param cell Where to store the position of the move along the line.
+ */
+static void
+rectangle_move (const board_profile *profile, int64_t longer, int64_t shorter, int64_t *line, int64_t *cell)
+{
+    if (longer == shorter) {
+        *line = 1;
+        *cell = shorter - 1;
+    } else {
+        *line = 0;
+        *cell = longer - arm_residue(profile, longer - shorter - 1);
+    }
+}
+
 //pattern recognition functions
 
 /**
  * @brief Detects if the table has a row line pattern.
  * 
- * This function checks if the table has a row line pattern.
+ * This function checks if the table has a row line pattern
+ * that the player to move wins.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
 bool
-row_line_pattern (int table[ROWS][COLS])
+row_line_pattern (const board_profile *profile)
 {
-    int num_cell_in_row = number_of_cells_in_row(table, 0);
-    int num_cell_in_col = number_of_cells_in_col(table, 0);
-    if (num_cell_in_col == 1 && num_cell_in_row <= 6 && num_cell_in_row > 1) {
+    int64_t num_cell_in_row = profile->row_len[0];
+    int64_t num_cell_in_col = profile->col_len[0];
+    if (num_cell_in_col == 1 && num_cell_in_row > 1 && arm_residue(profile, num_cell_in_row - 1) != 0) {
         return true;
     } else {
         return false;
@@ -112,17 +215,18 @@ row_line_pattern (int table[ROWS][COLS])
 /**
  * @brief Detects if the table has a column line pattern.
  * 
- * This function checks if the table has a column line pattern.
+ * This function checks if the table has a column line pattern
+ * that the player to move wins.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
 bool
-col_line_pattern (int table[ROWS][COLS])
+col_line_pattern (const board_profile *profile)
 {
-    int num_cell_in_row = number_of_cells_in_row(table, 0);
-    int num_cell_in_col = number_of_cells_in_col(table, 0);
-    if (num_cell_in_row == 1 && num_cell_in_col <= 6 && num_cell_in_col > 1) {
+    int64_t num_cell_in_row = profile->row_len[0];
+    int64_t num_cell_in_col = profile->col_len[0];
+    if (num_cell_in_row == 1 && num_cell_in_col > 1 && arm_residue(profile, num_cell_in_col - 1) != 0) {
         return true;
     } else {
         return false;
@@ -134,15 +238,17 @@ col_line_pattern (int table[ROWS][COLS])
  * 
  * This function checks if the table has a square pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
 bool
-square_pattern (int table[ROWS][COLS])
+square_pattern (const board_profile *profile)
 {
-    int num_cell_in_row = number_of_cells_in_row(table, 0);
-    int num_cell_in_col = number_of_cells_in_col(table, 0);
-    if (num_cell_in_col == num_cell_in_row && num_cell_in_col <= 3 && table[1][1] == 1) {
+    int64_t num_cell_in_row = profile->row_len[0];
+    int64_t num_cell_in_col = profile->col_len[0];
+    // The side is bounded first so that its square cannot overflow
+    if (num_cell_in_col == num_cell_in_row && num_cell_in_col - 1 <= profile->max_to_delete
+        && (num_cell_in_col - 1) * (num_cell_in_col - 1) <= profile->max_to_delete && profile->row_len[1] > 1) {
         return true;
     } else {
         return false;
@@ -152,16 +258,17 @@ square_pattern (int table[ROWS][COLS])
 /**
  * @brief Detects if the table has a row rectangle pattern.
  * 
- * This function checks if the table has a row rectangle pattern.
+ * This function checks if the table has a row rectangle pattern
+ * that the player to move wins.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
 bool
-row_rectangle_pattern (int table[ROWS][COLS])
+row_rectangle_pattern (const board_profile *profile)
 {
-    int num_cell_in_col = number_of_cells_in_col(table, 0);
-    if (num_cell_in_col == 2 && abs(number_of_cells_in_row(table, 0) - number_of_cells_in_row(table, 1)) != 1 && abs(number_of_cells_in_row(table, 0) - number_of_cells_in_row(table, 1)) <= 6) {
+    int64_t num_cell_in_col = profile->col_len[0];
+    if (num_cell_in_col == 2 && !is_losing_rectangle(profile, profile->row_len[0], profile->row_len[1])) {
         return true;
     } else {
         return false;
@@ -171,17 +278,18 @@ row_rectangle_pattern (int table[ROWS][COLS])
 /**
  * @brief Detects if the table has a column rectangle pattern.
  * 
- * This function checks if the table has a column rectangle pattern.
+ * This function checks if the table has a column rectangle pattern
+ * that the player to move wins.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
 bool
-col_rectangle_pattern (int table[ROWS][COLS])
+col_rectangle_pattern (const board_profile *profile)
 {
-    int num_cell_in_row = number_of_cells_in_row(table, 0);
+    int64_t num_cell_in_row = profile->row_len[0];
 
-    if (num_cell_in_row == 2 && abs(number_of_cells_in_col(table, 0) - number_of_cells_in_col(table, 1)) != 1 && abs(number_of_cells_in_col(table, 0) - number_of_cells_in_col(table, 1)) <= 6) {
+    if (num_cell_in_row == 2 && !is_losing_rectangle(profile, profile->col_len[0], profile->col_len[1])) {
         return true;
     } else {
         return false;
@@ -191,18 +299,20 @@ col_rectangle_pattern (int table[ROWS][COLS])
 /**
  * @brief Detects if the table has a corner pattern.
  * 
- * This function checks if the table has a corner pattern.
+ * This function checks if the table has a corner pattern that the
+ * player to move wins: both arms are independent subtraction games, lost
+ * when they have the same length modulo max_to_delete + 1.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
 bool
-corner_pattern (int table[ROWS][COLS])
+corner_pattern (const board_profile *profile)
 {
-    int num_cell_in_row = number_of_cells_in_row(table, 0);
-    int num_cell_in_col = number_of_cells_in_col(table, 0);
+    int64_t num_cell_in_row = profile->row_len[0];
+    int64_t num_cell_in_col = profile->col_len[0];
 
-    if (table[1][1] == 0 && num_cell_in_col != num_cell_in_row && num_cell_in_col != 1 && num_cell_in_row != 1 && abs(num_cell_in_col - num_cell_in_row) <= 5) {
+    if (profile->row_len[1] <= 1 && num_cell_in_col != 1 && num_cell_in_row != 1 && arm_residue(profile, num_cell_in_col - 1) != arm_residue(profile, num_cell_in_row - 1)) {
         return true;
     } else {
         return false;
@@ -212,19 +322,20 @@ corner_pattern (int table[ROWS][COLS])
 /**
  * @brief Detects if the table has a gun pattern.
  * 
- * This function checks if the table has a gun pattern.
+ * This function checks if the table has a gun pattern that the player to
+ * move wins: a corner with at most max_to_delete cells inside, whose arms
+ * have the same length modulo max_to_delete + 1. Eating the inside leaves a
+ * corner lost for the opponent.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return True if the pattern is detected, otherwise false.
  */
 bool
-gun_pattern (int table[ROWS][COLS])
+gun_pattern (const board_profile *profile)
 {
-    int num_cell_in_row = number_of_cells_in_row(table, 6);
-    int num_cell_in_col = number_of_cells_in_col(table, 6);
-    int num_cell_in_square = number_of_cells_in_square(table, 1, 1);
-    
-    if (num_cell_in_square > 0 && num_cell_in_square <= 5 && num_cell_in_col <= 1 && num_cell_in_row <= 1 && abs(number_of_cells_in_col(table, 0) - number_of_cells_in_row(table, 0)) <= 3) {
+    int64_t num_cell_inside = profile->num_cells_inside;
+
+    if (num_cell_inside > 0 && num_cell_inside <= profile->max_to_delete && arm_residue(profile, profile->row_len[0] - 1) == arm_residue(profile, profile->col_len[0] - 1)) {
         return true;
     } else {
         return false;
@@ -237,26 +348,34 @@ gun_pattern (int table[ROWS][COLS])
  * @brief Strategy for row line pattern.
  * 
  * This function returns the move coordinates for the row line pattern.
+ * The row is cut so that the number of cells left after the poisoned one is
+ * a multiple of max_to_delete + 1.
  * 
+ * @param profile The board profile of the table.
  * @return The move coordinates.
  */
-int
-row_line_strategy ()
+int64_t
+row_line_strategy (const board_profile *profile)
 {
-    return 0 * COLS + 1;
+    int64_t num_cell_in_row = profile->row_len[0];
+    return 0 * profile->cols + (num_cell_in_row - arm_residue(profile, num_cell_in_row - 1));
 }
 
 /**
  * @brief Strategy for column line pattern.
  * 
  * This function returns the move coordinates for the column line pattern.
+ * The column is cut so that the number of cells left after the poisoned one
+ * is a multiple of max_to_delete + 1.
  * 
+ * @param profile The board profile of the table.
  * @return The move coordinates.
  */
-int
-col_line_strategy ()
+int64_t
+col_line_strategy (const board_profile *profile)
 {
-    return 1 * COLS + 0;
+    int64_t num_cell_in_col = profile->col_len[0];
+    return (num_cell_in_col - arm_residue(profile, num_cell_in_col - 1)) * profile->cols + 0;
 }
 
 /**
@@ -264,12 +383,13 @@ col_line_strategy ()
  * 
  * This function returns the move coordinates for the square pattern.
  * 
+ * @param profile The board profile of the table.
  * @return The move coordinates.
  */
-int
-square_strategy ()
+int64_t
+square_strategy (const board_profile *profile)
 {
-    return 1 * COLS + 1;
+    return 1 * profile->cols + 1;
 }
 
 /**
@@ -277,17 +397,15 @@ square_strategy ()
  * 
  * This function returns the move coordinates for the row rectangle pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return The move coordinates.
  */
-int
-row_rectangle_strategy (int table[ROWS][COLS])
+int64_t
+row_rectangle_strategy (const board_profile *profile)
 {
-    if (number_of_cells_in_row(table, 0) == number_of_cells_in_row(table, 1)) {
-        return 1 * COLS + (number_of_cells_in_row(table, 0) - 1);
-    } else {
-        return 0 * COLS + (number_of_cells_in_row(table, 1) + 1);
-    }
+    int64_t row, col;
+    rectangle_move(profile, profile->row_len[0], profile->row_len[1], &row, &col);
+    return row * profile->cols + col;
 }
 
 /**
@@ -295,134 +413,163 @@ row_rectangle_strategy (int table[ROWS][COLS])
  * 
  * This function returns the move coordinates for the column rectangle pattern.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return The move coordinates.
  */
-int
-col_rectangle_strategy (int table[ROWS][COLS])
+int64_t
+col_rectangle_strategy (const board_profile *profile)
 {
-    if (number_of_cells_in_col(table, 0) == number_of_cells_in_col(table, 1)) {
-        return (number_of_cells_in_col(table, 0) - 1) * COLS + 1;
-    } else {
-        return (number_of_cells_in_col(table, 1) + 1) * COLS + 0;
-    }
+    int64_t row, col;
+    rectangle_move(profile, profile->col_len[0], profile->col_len[1], &col, &row);
+    return row * profile->cols + col;
 }
 
 /**
  * @brief Strategy for corner pattern.
  * 
  * This function returns the move coordinates for the corner pattern.
+ * The longer arm modulo max_to_delete + 1 is cut down to the other one.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return The move coordinates.
  */
-int
-corner_strategy(int table[ROWS][COLS])
+int64_t
+corner_strategy(const board_profile *profile)
 {
-    if (number_of_cells_in_col(table, 0) > number_of_cells_in_row(table, 0)) {
-        return number_of_cells_in_row(table, 0) * COLS + 0;
+    int64_t row_residue = arm_residue(profile, profile->row_len[0] - 1);
+    int64_t col_residue = arm_residue(profile, profile->col_len[0] - 1);
+    if (col_residue > row_residue) {
+        return (profile->col_len[0] - (col_residue - row_residue)) * profile->cols + 0;
     } else {
-        return 0 * COLS + number_of_cells_in_col(table, 0);
+        return 0 * profile->cols + (profile->row_len[0] - (row_residue - col_residue));
     }
 }
 
 /**
  * @brief Strategy for gun pattern.
  * 
- * This function returns the move coordinates for the gun pattern.
+ * This function returns the move coordinates for the gun pattern: the
+ * inside of the corner is eaten, leaving arms of the same length modulo
+ * max_to_delete + 1.
  * 
- * @param table A 2D array representing the game table.
+ * @param profile The board profile of the table.
  * @return The move coordinates.
  */
-int
-gun_strategy (int table[ROWS][COLS])
+int64_t
+gun_strategy (const board_profile *profile)
 {
-    if (number_of_cells_in_col(table, 0) == number_of_cells_in_row(table, 0)) {
-        return 1 * COLS + 1;
-    } else if(number_of_cells_in_col(table, 0) > number_of_cells_in_row(table, 0)) {
-        if(table[number_of_cells_in_row(table, 0) - 1][1] != 1) {
-            return (number_of_cells_in_row(table, 0) - 1) * COLS + 0;
-        } else {
-            return (number_of_cells_in_row(table, 0) - 1) * COLS + 1;
-        }
-    } else {
-        if(table[1][number_of_cells_in_col(table, 0) - 1] != 1) {
-            return 0 * COLS + number_of_cells_in_col(table, 0) - 1;
-        } else {
-            return 1 * COLS + number_of_cells_in_col(table, 0) - 1;
+    return 1 * profile->cols + 1;
+}
+
+/**
+ * @struct pattern_rule
+ * @brief An end game pattern and its winning strategy.
+ */
+typedef struct {
+    chomp_pattern pattern; /**< The pattern. */
+    bool (*matches)(const board_profile *profile); /**< Detects the pattern. */
+    int64_t (*strategy)(const board_profile *profile); /**< Returns the move of the pattern. */
+} pattern_rule;
+
+/**
+ * @var pattern_rules
+ * @brief The patterns, in the order they are tried.
+ */
+static const pattern_rule pattern_rules[] = {
+    {ROW_LINE_PATTERN, row_line_pattern, row_line_strategy},
+    {COL_LINE_PATTERN, col_line_pattern, col_line_strategy},
+    {SQUARE_PATTERN, square_pattern, square_strategy},
+    {ROW_RECTANGLE_PATTERN, row_rectangle_pattern, row_rectangle_strategy},
+    {COL_RECTANGLE_PATTERN, col_rectangle_pattern, col_rectangle_strategy},
+    {CORNER_PATTERN, corner_pattern, corner_strategy},
+    {GUN_PATTERN, gun_pattern, gun_strategy},
+};
+
+/**
+ * @brief Classifies a position with the pattern rules.
+ * 
+ * Only the first rule that matches is used. Its move is not checked against
+ * the position, the caller does it.
+ * 
+ * @param profile The board profile of the position.
+ * @param row Where to store the row of the move, left unchanged if there is no pattern.
+ * @param col Where to store the column of the move, left unchanged if there is no pattern.
+ * @return The detected pattern, NO_PATTERN if there is none.
+ */
+chomp_pattern
+match_pattern (const board_profile *profile, int64_t *row, int64_t *col)
+{
+    for (size_t k = 0; k < sizeof(pattern_rules) / sizeof(pattern_rules[0]); k++) {
+        if (pattern_rules[k].matches(profile)) {
+            int64_t coordinates = pattern_rules[k].strategy(profile);
+            *row = coordinates / profile->cols;
+            *col = coordinates % profile->cols;
+            return pattern_rules[k].pattern;
         }
     }
+    return NO_PATTERN;
 }
 
-int current_pattern = 0;
 /**
- * @brief Detects the current pattern in the table.
+ * @brief Finds the pattern of a position given by its row lengths and its move.
  * 
- * This function checks for various patterns in the table and sets the current pattern.
+ * This function does not touch any global state, so several positions can
+ * be classified at the same time. A position already in the cache is found
+ * from its row lengths alone, the board profile is only built to try the
+ * rules on a new one.
  * 
- * @param table A 2D array representing the game table.
- * @return True if a pattern is detected, otherwise false.
+ * @param position The row lengths of the position.
+ * @param move The move coordinates to fill, left unchanged if there is no pattern.
+ * @param cache The cache of the caller, NULL to classify the position without one.
+ * @return The detected pattern, NO_PATTERN if there is none.
  */
-bool
-detect_pattern (int table[ROWS][COLS])
+chomp_pattern
+find_pattern_profile (const chomp_profile *position, int *move, pattern_cache *cache)
 {
-    if (row_line_pattern(table)) {
-        current_pattern = 1;
-        return true;
-    } else if (col_line_pattern(table)) {
-        current_pattern = 2;
-        return true;
-    } else if (square_pattern(table)) {
-        current_pattern = 3;
-        return true;
-    } else if (row_rectangle_pattern(table)) {
-        current_pattern = 4;
-        return true;
-    } else if (col_rectangle_pattern(table)) {
-        current_pattern = 5;
-        return true;
-    } else if (corner_pattern(table)) {
-        current_pattern = 6;
-        return true;
-    } else if (gun_pattern(table)) {
-        current_pattern = 7;
-        return true;
-    } else {
-        return false;
+    pattern_cache_entry uncached;
+    pattern_cache_entry *entry = &uncached;
+    bool cached = false;
+    if (cache != NULL) {
+        entry = &cache->entries[profile_hash(position) % PATTERN_CACHE_SIZE];
+        cached = entry->rows == board_rows && entry->cols == board_cols && entry->max_to_delete == num_max_to_delete && profile_equal(&entry->key, position);
+    }
+    if (!cached) {
+        board_profile profile;
+        int64_t row, col;
+        board_profile_from_profile(position, &profile);
+        entry->key = *position;
+        entry->rows = board_rows;
+        entry->cols = board_cols;
+        entry->max_to_delete = num_max_to_delete;
+        entry->move = 0;
+        entry->pattern = match_pattern(&profile, &row, &col);
+        // Every rule is proven, but a wrong one must never make the ai play an illegal move
+        if (entry->pattern != NO_PATTERN && (row >= board_rows || !profile_is_legal_move(position, (int) row, (int) col))) {
+            entry->pattern = NO_PATTERN;
+        } else if (entry->pattern != NO_PATTERN) {
+            entry->move = (int) (row * board_cols + col);
+        }
     }
+    if (entry->pattern != NO_PATTERN) {
+        *move = entry->move;
+    }
+    return entry->pattern;
 }
+
 /**
- * @brief Returns the move coordinates based on the detected pattern.
+ * @brief Finds the pattern of the table and its move.
  * 
- * This function returns the move coordinates based on the detected pattern.
+ * The table is read into row lengths and classified without a cache, see
+ * find_pattern_profile().
  * 
  * @param table A 2D array representing the game table.
- * @return The move coordinates.
+ * @param move The move coordinates to fill, left unchanged if there is no pattern.
+ * @return The detected pattern, NO_PATTERN if there is none.
  */
-int
-pattern_move (int table[ROWS][COLS])
+chomp_pattern
+find_pattern (int table[ROWS][COLS], int *move)
 {
-    int coordinates=0;
-    if (current_pattern == 1) {
-        coordinates = row_line_strategy();
-    } else if (current_pattern == 2) {
-        coordinates = col_line_strategy();
-    } else if (current_pattern == 3) {
-        coordinates = square_strategy();
-    } else if (current_pattern == 4) {
-        coordinates = row_rectangle_strategy(table);
-    } else if (current_pattern == 5) {
-        coordinates = col_rectangle_strategy(table);
-    } else if (current_pattern == 6) {
-        coordinates = corner_strategy(table);
-    } else if (current_pattern == 7) {
-        coordinates = gun_strategy(table);
-    }
-
-    if (coordinates != 0) {
-        return coordinates;
-    } else {
-        printf("big error");
-        return 0;
-    }
-}
\ No newline at end of file
+    chomp_profile position;
+    profile_from_table(table, &position);
+    return find_pattern_profile(&position, move, NULL);
+}
@@ -0,0 +1,438 @@
+/**
+ * @file ai_engine.c
+ * @brief Implementation of the ai engines and of their table.
+ *
+ * This file contains the pattern and random engines, the wrappers of the
+ * search, solver, Monte-Carlo and tablebase engines, the table listing all
+ * of them, the difficulty levels, the choice of the move with the opening
+ * book or the current engine and the background thread pondering during the
+ * turn of the opponent.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "ai_engine.h"
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+#include "ai.h"
+#include "search.h"
+#include "mcts.h"
+#include "book.h"
+#include "tablebase.h"
+#include "default_tablebase.h"
+#include "tablebase_file.h"
+
+/**
+ * @brief Chooses a random legal move.
+ *
+ * The poisoned cell is only eaten when it is the last legal move.
+ *
+ * @param state The position.
+ * @param time_budget_ms Unused, the move is immediate.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over.
+ */
+static bool
+random_engine_move (const game_state *state, int time_budget_ms, int *row, int *col)
+{
+    (void) time_budget_ms;
+    static _Thread_local int possible_moves[ROWS * COLS][2];
+    int num_moves = game_state_legal_moves(state, possible_moves);
+    if (num_moves == 0) {
+        return false;
+    }
+
+    bool poisoned_first = possible_moves[0][0] == 0 && possible_moves[0][1] == 0;
+    int index = (int) random_legal_move_index(num_moves, poisoned_first, (uint64_t) rand());
+    *row = possible_moves[index][0];
+    *col = possible_moves[index][1];
+    return true;
+}
+
+/**
+ * @var pattern_cache_key
+ * @brief Key of the pattern cache of each thread playing with the pattern engine.
+ */
+static pthread_key_t pattern_cache_key;
+
+/**
+ * @var pattern_cache_once
+ * @brief Creates pattern_cache_key once.
+ */
+static pthread_once_t pattern_cache_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @var pattern_cache_key_created
+ * @brief True if pattern_cache_key could be created.
+ */
+static bool pattern_cache_key_created = false;
+
+/**
+ * @brief Creates the key of the pattern caches, freed when their thread exits.
+ */
+static void
+create_pattern_cache_key (void)
+{
+    pattern_cache_key_created = pthread_key_create(&pattern_cache_key, free) == 0;
+}
+
+/**
+ * @brief Returns the pattern cache of the calling thread.
+ *
+ * The cache is allocated on the first move of the thread, so the threads
+ * that never play with the pattern engine, such as the search workers, do
+ * not pay for it.
+ *
+ * @return The cache, NULL if memory is missing.
+ */
+static pattern_cache *
+thread_pattern_cache (void)
+{
+    pthread_once(&pattern_cache_once, create_pattern_cache_key);
+    if (!pattern_cache_key_created) {
+        return NULL;
+    }
+    pattern_cache *cache = pthread_getspecific(pattern_cache_key);
+    if (cache == NULL) {
+        cache = calloc(1, sizeof(pattern_cache));
+        if (cache != NULL && pthread_setspecific(pattern_cache_key, cache) != 0) {
+            free(cache);
+            cache = NULL;
+        }
+    }
+    return cache;
+}
+
+/**
+ * @brief Chooses the move of the end game pattern of a position.
+ *
+ * Positions without a known pattern get a random move.
+ *
+ * @param state The position.
+ * @param time_budget_ms Unused, the move is immediate.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over.
+ */
+static bool
+pattern_engine_move (const game_state *state, int time_budget_ms, int *row, int *col)
+{
+    int move;
+    chomp_pattern pattern = find_pattern_profile(&state->profile, &move, thread_pattern_cache()); // Without a cache, the position is classified uncached
+    if (pattern == NO_PATTERN) {
+        return random_engine_move(state, time_budget_ms, row, col);
+    }
+    *row = move / board_cols;
+    *col = move % board_cols;
+    return true;
+}
+
+/**
+ * @brief Chooses a move with the alpha-beta search, up to search_depth plies.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the engine may think, in milliseconds.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false otherwise.
+ */
+static bool
+search_engine_move (const game_state *state, int time_budget_ms, int *row, int *col)
+{
+    return search_ai_move(state, search_depth, time_budget_ms, row, col);
+}
+
+/**
+ * @brief Chooses a move with the alpha-beta search, until the result is proven.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the engine may think, in milliseconds.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false otherwise.
+ */
+static bool
+solver_engine_move (const game_state *state, int time_budget_ms, int *row, int *col)
+{
+    return search_ai_move(state, 0, time_budget_ms, row, col);
+}
+
+/**
+ * @brief Chooses a move with the Monte-Carlo tree search.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the engine may think, in milliseconds.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false otherwise.
+ */
+static bool
+mcts_engine_move (const game_state *state, int time_budget_ms, int *row, int *col)
+{
+    return mcts_ai_move(state, time_budget_ms, row, col);
+}
+
+/**
+ * @brief Chooses the optimal move read from the tablebase of the board.
+ *
+ * The default board reads the table compiled in, then the tablebase file
+ * is used if it is for the current board, otherwise the tablebase solved by
+ * perfect_engine_prepare(). Without it, the tablebase is only solved on the
+ * first move when the move has no time budget.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the engine may think, in milliseconds, AI_NO_TIME_LIMIT for none.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the board is too large for a tablebase.
+ */
+static bool
+perfect_engine_move (const game_state *state, int time_budget_ms, int *row, int *col)
+{
+    bool won;
+    if (default_tablebase_probe(&state->profile, &won, row, col)) {
+        return *row >= 0;
+    }
+    if (tablebase_file_probe(&ai_tablebase_file, state, &won, row, col)) {
+        return *row >= 0;
+    }
+    return tablebase_ai_move(state, time_budget_ms, row, col);
+}
+
+/**
+ * @brief Solves the tablebase of the board, unless the table compiled in or the tablebase file holds it.
+ *
+ * @return true if every position of the board can be read, false if the board is too large for a tablebase.
+ */
+static bool
+perfect_engine_prepare (void)
+{
+    if (default_tablebase_rows == board_rows && default_tablebase_cols == board_cols
+        && default_tablebase_max_to_delete == num_max_to_delete) {
+        return true;
+    }
+    if (ai_tablebase_file.rows == board_rows && ai_tablebase_file.cols == board_cols
+        && ai_tablebase_file.max_to_delete == num_max_to_delete) {
+        return true;
+    }
+    return tablebase_ai_prepare();
+}
+
+/**
+ * @brief Ponders with the alpha-beta search, up to search_depth plies.
+ *
+ * @param state The position, the opponent to move.
+ * @param stop Set by another thread to stop the search.
+ * @return true if the position was searched, false otherwise.
+ */
+static bool
+search_engine_ponder (const game_state *state, atomic_bool *stop)
+{
+    return search_ai_ponder(state, search_depth, stop);
+}
+
+/**
+ * @brief Ponders with the alpha-beta search, until the result is proven.
+ *
+ * @param state The position, the opponent to move.
+ * @param stop Set by another thread to stop the search.
+ * @return true if the position was searched, false otherwise.
+ */
+static bool
+solver_engine_ponder (const game_state *state, atomic_bool *stop)
+{
+    return search_ai_ponder(state, 0, stop);
+}
+
+const ai_engine ai_engines[] = {
+    {"pattern", "End game patterns, random moves otherwise", pattern_engine_move, NULL, NULL},
+    {"random", "Random legal moves", random_engine_move, NULL, NULL},
+    {"search", "Alpha-beta search up to the depth limit", search_engine_move, search_engine_ponder, NULL},
+    {"solver", "Alpha-beta search until the result is proven", solver_engine_move, solver_engine_ponder, NULL},
+    {"mcts", "Monte-Carlo tree search", mcts_engine_move, mcts_ai_ponder, NULL},
+    {"perfect", "Tablebase of every position, optimal and instant once solved", perfect_engine_move, NULL, perfect_engine_prepare}
+};
+
+const int num_ai_engines = sizeof(ai_engines) / sizeof(ai_engines[0]);
+
+const ai_engine *current_ai_engine = &ai_engines[0];
+
+int ai_time_budget = AI_NO_TIME_LIMIT;
+
+opening_book ai_book;
+
+tablebase_file ai_tablebase_file;
+
+const ai_level ai_levels[] = {
+    {"easy", 50, 2, 500},
+    {"medium", 250, 8, 5000},
+    {"hard", 1000, 24, 50000},
+    {"expert", 5000, 0, 1000000}
+};
+
+const int num_ai_levels = sizeof(ai_levels) / sizeof(ai_levels[0]);
+
+/**
+ * @brief The position pondered, copied for the background thread.
+ */
+static game_state ponder_state;
+
+/**
+ * @brief The engine pondering.
+ */
+static const ai_engine *ponder_engine;
+
+/**
+ * @brief Set to stop pondering.
+ */
+static atomic_bool ponder_stop;
+
+/**
+ * @brief The background thread pondering.
+ */
+static pthread_t ponder_thread;
+
+/**
+ * @brief True while the background thread runs or is not joined yet.
+ */
+static bool pondering = false;
+
+/**
+ * @brief Finds an engine by name.
+ *
+ * @param name The name of the engine.
+ * @return The engine, NULL if there is no engine with that name.
+ */
+const ai_engine *
+ai_engine_find (const char *name)
+{
+    for (int i = 0; i < num_ai_engines; i++) {
+        if (strcmp(ai_engines[i].name, name) == 0) {
+            return &ai_engines[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Finds a difficulty level by name.
+ *
+ * @param name The name of the level.
+ * @return The level, NULL if there is no level with that name.
+ */
+const ai_level *
+ai_level_find (const char *name)
+{
+    for (int i = 0; i < num_ai_levels; i++) {
+        if (strcmp(ai_levels[i].name, name) == 0) {
+            return &ai_levels[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Sets the budgets of the engines to those of a difficulty level.
+ *
+ * @param level The level.
+ */
+void
+ai_level_apply (const ai_level *level)
+{
+    ai_time_budget = level->time_budget_ms;
+    search_depth = level->depth;
+    mcts_iterations = level->iterations;
+}
+
+/**
+ * @brief Prepares the current engine for the current board.
+ *
+ * @return true if the engine is ready, false if it will fall back to the pattern engine.
+ */
+bool
+ai_engine_prepare (void)
+{
+    return current_ai_engine->prepare == NULL || current_ai_engine->prepare();
+}
+
+/**
+ * @brief Chooses the move of the ai with the current engine.
+ *
+ * Positions of the opening book are played from it. If the current engine
+ * finds no move, the pattern engine plays instead. Pondering is stopped
+ * first.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the engine may think, in milliseconds, AI_NO_TIME_LIMIT for none.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over.
+ */
+bool
+ai_engine_move (const game_state *state, int time_budget_ms, int *row, int *col)
+{
+    ai_ponder_stop(); // The engines are not shared between threads
+    if (book_lookup(&ai_book, state, row, col)) {
+        return true;
+    }
+    if (current_ai_engine->choose_move(state, time_budget_ms, row, col)) {
+        return true;
+    }
+    return pattern_engine_move(state, time_budget_ms, row, col);
+}
+
+/**
+ * @brief Runs the ponder function of the engine on the background thread.
+ *
+ * @param arg Unused.
+ * @return NULL
+ */
+static void *
+ponder_loop (void *arg)
+{
+    (void) arg;
+    ponder_engine->ponder(&ponder_state, &ponder_stop);
+    return NULL;
+}
+
+/**
+ * @brief Starts pondering a position with the current engine.
+ *
+ * The search runs on a background thread until ai_ponder_stop() is called,
+ * or until the engine has nothing left to search.
+ *
+ * @param state The position, the opponent to move.
+ * @return true if pondering started, false if the engine cannot ponder or the game is over.
+ */
+bool
+ai_ponder_start (const game_state *state)
+{
+    ai_ponder_stop();
+    if (current_ai_engine->ponder == NULL || state->profile.row_len[0] == 0) {
+        return false;
+    }
+    ponder_state = *state;
+    ponder_engine = current_ai_engine;
+    atomic_store(&ponder_stop, false);
+    pondering = pthread_create(&ponder_thread, NULL, ponder_loop, NULL) == 0;
+    return pondering;
+}
+
+/**
+ * @brief Stops pondering and waits for the background thread.
+ *
+ * Nothing happens if the ai is not pondering.
+ */
+void
+ai_ponder_stop (void)
+{
+    if (!pondering) {
+        return;
+    }
+    atomic_store(&ponder_stop, true);
+    pthread_join(ponder_thread, NULL);
+    pondering = false;
+}
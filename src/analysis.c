@@ -0,0 +1,286 @@
+/**
+ * @file analysis.c
+ * @brief Implementation of the batch evaluation of Chomp positions.
+ *
+ * This file contains the evaluation of a single position and the split of a
+ * batch over threads. Each thread works on its own contiguous slice of the
+ * batch with its own buffers, so no lock is needed. It also evaluates the
+ * corner boards, too large for a table.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "analysis.h"
+#include "chomp.h"
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+#include "ai.h"
+#include "corner_board.h"
+
+/**
+ * @struct analysis_job
+ * @brief The slice of a batch evaluated by one thread.
+ */
+typedef struct {
+    int (*tables)[ROWS][COLS]; /**< The positions as tables, NULL if given as profiles. */
+    const chomp_profile *profiles; /**< The positions as profiles, NULL if given as tables. */
+    int first; /**< Index of the first position of the slice. */
+    int last; /**< Index after the last position of the slice. */
+    position_analysis *results; /**< The results of the whole batch. */
+    int (*counts)[ROWS][COLS]; /**< The deletion counts of the whole batch, NULL if not needed. */
+} analysis_job;
+
+/**
+ * @brief Picks the move of a position without any pattern.
+ *
+ * The ai plays a random legal move, the poisoned cell only if it is the last
+ * one. The choice is drawn from a generator seeded with the position, so a
+ * position always gets the same recommendation, whatever the thread that
+ * evaluates it.
+ *
+ * @param profile The row lengths of the position.
+ * @param legal The legal move masks of the position.
+ * @param num_legal_moves The number of legal moves.
+ * @param result The result to fill.
+ */
+static void
+random_move (const chomp_profile *profile, const uint64_t legal[ROWS], int num_legal_moves, position_analysis *result)
+{
+    int index = (int) random_legal_move_index(num_legal_moves, (legal[0] & 1) != 0, profile_hash(profile));
+    for (int i = 0; i < board_rows; i++) {
+        int row_count = __builtin_popcountll(legal[i]);
+        if (index < row_count) {
+            uint64_t row_legal = legal[i];
+            while (index-- > 0) {
+                row_legal &= row_legal - 1;
+            }
+            result->move_row = i;
+            result->move_col = __builtin_ctzll(row_legal);
+            return;
+        }
+        index -= row_count;
+    }
+}
+
+/**
+ * @brief Evaluates one position.
+ *
+ * @param table The game table.
+ * @param counts The matrix to fill with the deletion counts.
+ * @param cache The pattern cache of the thread, NULL if none.
+ * @param result The result to fill.
+ */
+static void
+analyse_table (int table[ROWS][COLS], int counts[ROWS][COLS], pattern_cache *cache, position_analysis *result)
+{
+    calculate_all_num_to_delete(table, counts, result->legal);
+    result->num_legal_moves = 0;
+    for (int i = 0; i < board_rows; i++) {
+        result->num_legal_moves += __builtin_popcountll(result->legal[i]);
+    }
+    for (int i = board_rows; i < ROWS; i++) {
+        result->legal[i] = 0;
+    }
+
+    if (table[0][0] == 0) {
+        result->pattern = NO_PATTERN;
+        result->move_row = -1;
+        result->move_col = -1;
+        return;
+    }
+    chomp_profile profile;
+    int move;
+    profile_from_table(table, &profile);
+    result->pattern = find_pattern_profile(&profile, &move, cache);
+    if (result->pattern != NO_PATTERN) {
+        result->move_row = move / board_cols;
+        result->move_col = move % board_cols;
+    } else {
+        random_move(&profile, result->legal, result->num_legal_moves, result);
+    }
+}
+
+/**
+ * @brief Evaluates the slice of a batch of a job.
+ *
+ * @param arg The job.
+ * @return NULL
+ */
+static void *
+analysis_worker (void *arg)
+{
+    analysis_job *job = arg;
+    int table[ROWS][COLS];
+    int counts[ROWS][COLS];
+    pattern_cache *cache = calloc(1, sizeof(pattern_cache)); // Without memory, the positions are classified uncached
+
+    for (int k = job->first; k < job->last; k++) {
+        int (*position)[COLS] = table;
+        if (job->tables != NULL) {
+            position = job->tables[k];
+        } else {
+            profile_to_table(&job->profiles[k], table);
+        }
+        analyse_table(position, job->counts != NULL ? job->counts[k] : counts, cache, &job->results[k]);
+    }
+    free(cache);
+    return NULL;
+}
+
+/**
+ * @brief Splits a batch over threads and waits for the result.
+ *
+ * Only as many threads as there are slices of ANALYSIS_MIN_POSITIONS_PER_THREAD
+ * positions are started, and the calling thread evaluates the first slice.
+ * If a thread cannot be created, its slice is evaluated by the caller.
+ */
+static void
+analyse_batch (int tables[][ROWS][COLS], const chomp_profile profiles[], int num_positions, position_analysis results[], int counts[][ROWS][COLS], int num_threads)
+{
+    if (num_threads <= 0) {
+        long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = num_cpus > 0 ? (int) num_cpus : 1;
+    }
+    int max_threads = (num_positions + ANALYSIS_MIN_POSITIONS_PER_THREAD - 1) / ANALYSIS_MIN_POSITIONS_PER_THREAD;
+    if (num_threads > max_threads) {
+        num_threads = max_threads;
+    }
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+
+    analysis_job *jobs = malloc(num_threads * sizeof(analysis_job));
+    pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+    bool *started = calloc(num_threads, sizeof(bool));
+    if (jobs == NULL || threads == NULL || started == NULL) {
+        analysis_job job = {tables, profiles, 0, num_positions, results, counts};
+        analysis_worker(&job); // Not enough memory to split the batch
+        free(jobs);
+        free(threads);
+        free(started);
+        return;
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        jobs[t] = (analysis_job) {
+            tables, profiles,
+            (int) ((long long) num_positions * t / num_threads),
+            (int) ((long long) num_positions * (t + 1) / num_threads),
+            results, counts
+        };
+    }
+    for (int t = 1; t < num_threads; t++) {
+        started[t] = pthread_create(&threads[t], NULL, analysis_worker, &jobs[t]) == 0;
+    }
+    analysis_worker(&jobs[0]);
+    for (int t = 1; t < num_threads; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            analysis_worker(&jobs[t]);
+        }
+    }
+    free(jobs);
+    free(threads);
+    free(started);
+}
+
+/**
+ * @brief Evaluates a batch of positions given as int tables.
+ *
+ * @param tables The positions.
+ * @param num_positions The number of positions.
+ * @param results The array to fill, one entry per position.
+ * @param counts The deletion count of every cell of every position, NULL if not needed.
+ * @param num_threads The maximum number of threads, 0 for one per processor.
+ */
+void
+analyse_tables (int tables[][ROWS][COLS], int num_positions, position_analysis results[], int counts[][ROWS][COLS], int num_threads)
+{
+    analyse_batch(tables, NULL, num_positions, results, counts, num_threads);
+}
+
+/**
+ * @brief Evaluates a batch of positions given as profiles.
+ *
+ * @param profiles The positions.
+ * @param num_positions The number of positions.
+ * @param results The array to fill, one entry per position.
+ * @param counts The deletion count of every cell of every position, NULL if not needed.
+ * @param num_threads The maximum number of threads, 0 for one per processor.
+ */
+void
+analyse_profiles (const chomp_profile profiles[], int num_positions, position_analysis results[], int counts[][ROWS][COLS], int num_threads)
+{
+    analyse_batch(NULL, profiles, num_positions, results, counts, num_threads);
+}
+
+/**
+ * @brief Builds the board profile of a corner board.
+ *
+ * The lengths of the first two rows and columns can be far larger than a
+ * table, the pattern rules of ai.c read them on 64 bits.
+ *
+ * @param board The board, not empty.
+ * @param profile The board profile to fill.
+ */
+static void
+board_profile_from_corner_board (const corner_board *board, board_profile *profile)
+{
+    profile->row_len[0] = corner_board_row_len(board, 0);
+    profile->row_len[1] = corner_board_row_len(board, 1);
+    profile->col_len[0] = corner_board_col_len(board, 0);
+    profile->col_len[1] = corner_board_col_len(board, 1);
+    profile->num_cells_inside = corner_board_num_cells(board) - profile->row_len[0] - (profile->col_len[0] - 1);
+    profile->cols = board->cols;
+    profile->max_to_delete = board->limit;
+}
+
+/**
+ * @brief Evaluates a corner board of any size.
+ *
+ * The move without a pattern is drawn from a generator seeded with the
+ * number of cells and corners, so a position always gets the same
+ * recommendation.
+ *
+ * @param board The board.
+ * @param result The result to fill.
+ * @return true on success, false if memory is missing.
+ */
+bool
+analyse_corner_board (const corner_board *board, corner_analysis *result)
+{
+    result->num_cells = corner_board_num_cells(board);
+    result->num_corners = corner_board_num_corners(board);
+    result->num_legal_moves = corner_board_legal_moves(board, NULL, 0);
+    result->pattern = NO_PATTERN;
+    result->move_row = -1;
+    result->move_col = -1;
+    if (result->num_cells == 0) {
+        return true;
+    }
+    board_profile profile;
+    board_profile_from_corner_board(board, &profile);
+    result->pattern = match_pattern(&profile, &result->move_row, &result->move_col);
+    if (result->pattern != NO_PATTERN && corner_board_is_legal_move(board, result->move_row, result->move_col)) {
+        return true;
+    }
+    result->pattern = NO_PATTERN; // A wrong rule must never recommend an illegal move
+
+    int64_t num_moves = result->num_legal_moves < ANALYSIS_MAX_CORNER_MOVES ? result->num_legal_moves : ANALYSIS_MAX_CORNER_MOVES;
+    int64_t (*possible_moves)[2] = malloc((size_t) num_moves * sizeof(*possible_moves));
+    if (possible_moves == NULL) {
+        return false;
+    }
+    corner_board_legal_moves(board, possible_moves, num_moves);
+    bool poisoned_first = possible_moves[0][0] == 0 && possible_moves[0][1] == 0;
+    uint64_t seed = (uint64_t) result->num_cells * UINT64_C(0x9e3779b97f4a7c15) ^ (uint64_t) result->num_corners;
+    int64_t index = random_legal_move_index(num_moves, poisoned_first, seed);
+    result->move_row = possible_moves[index][0];
+    result->move_col = possible_moves[index][1];
+    free(possible_moves);
+    return true;
+}
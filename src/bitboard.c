@@ -0,0 +1,134 @@
+/**
+ * @file bitboard.c
+ * @brief Implementation of the bitboard representation of the Chomp board.
+ *
+ * This file contains the quadrant mask table, the conversions between the
+ * int table used by the front ends and the 64-bit bitboard, and the legal
+ * move generation on bitboards.
+ */
+
+#include "bitboard.h"
+#include "const.h"
+
+bitboard bitboard_quadrant_masks[64];
+
+/**
+ * @brief Rebuilds the quadrant masks for the current board dimensions.
+ *
+ * Each mask is the row part of the quadrant replicated on every row from
+ * the chosen one; the row parts never overlap so the multiplication cannot
+ * carry.
+ */
+void
+bitboard_setup (void)
+{
+    if (!bitboard_fits()) {
+        return;
+    }
+    bitboard row_mask = board_cols == 64 ? ~UINT64_C(0) : (UINT64_C(1) << board_cols) - 1;
+    for (int i = 0; i < board_rows; i++) {
+        bitboard rows_from = 0;
+        for (int k = i; k < board_rows; k++) {
+            rows_from |= UINT64_C(1) << (k * board_cols);
+        }
+        for (int j = 0; j < board_cols; j++) {
+            bitboard row_part = row_mask & ~((UINT64_C(1) << j) - 1);
+            bitboard_quadrant_masks[i * board_cols + j] = row_part * rows_from;
+        }
+    }
+}
+
+/**
+ * @brief Builds the quadrant masks of the default board at startup.
+ */
+static void __attribute__((constructor))
+bitboard_default_setup (void)
+{
+    bitboard_setup();
+}
+
+/**
+ * @brief Converts the first rows x cols cells of a table to a bitboard.
+ *
+ * Called with constant dimensions for the default board so the compiler
+ * can unroll the loops.
+ */
+static inline bitboard
+from_table_sized (int table[ROWS][COLS], int rows, int cols)
+{
+    bitboard board = 0;
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            board |= (bitboard) (table[i][j] != 0) << (i * cols + j);
+        }
+    }
+    return board;
+}
+
+/**
+ * @brief Writes a bitboard to the first rows x cols cells of a table.
+ */
+static inline void
+to_table_sized (bitboard board, int table[ROWS][COLS], int rows, int cols)
+{
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            table[i][j] = (int) ((board >> (i * cols + j)) & 1);
+        }
+    }
+}
+
+/**
+ * @brief Converts an int table to a bitboard.
+ *
+ * @param table The game table.
+ * @return The bitboard holding the same cells.
+ */
+bitboard
+bitboard_from_table (int table[ROWS][COLS])
+{
+    if (board_rows == DEFAULT_ROWS && board_cols == DEFAULT_COLS) {
+        return from_table_sized(table, DEFAULT_ROWS, DEFAULT_COLS);
+    }
+    return from_table_sized(table, board_rows, board_cols);
+}
+
+/**
+ * @brief Writes a bitboard back to an int table.
+ *
+ * @param board The bitboard.
+ * @param table The game table to fill.
+ */
+void
+bitboard_to_table (bitboard board, int table[ROWS][COLS])
+{
+    if (board_rows == DEFAULT_ROWS && board_cols == DEFAULT_COLS) {
+        to_table_sized(board, table, DEFAULT_ROWS, DEFAULT_COLS);
+    } else {
+        to_table_sized(board, table, board_rows, board_cols);
+    }
+}
+
+/**
+ * @brief Calculates the legal moves of a board.
+ *
+ * A move is legal if its cell is present and it deletes at most
+ * num_max_to_delete cells.
+ *
+ * @param board The board.
+ * @return A bitboard with the cells of all legal moves set.
+ */
+bitboard
+bitboard_legal_moves (bitboard board)
+{
+    bitboard legal = 0;
+    bitboard cells = board;
+    while (cells) {
+        int index = __builtin_ctzll(cells);
+        cells &= cells - 1; // Clear the lowest cell
+        if (__builtin_popcountll(board & bitboard_quadrant_masks[index]) <= num_max_to_delete) {
+            legal |= UINT64_C(1) << index;
+        }
+    }
+    return legal;
+}
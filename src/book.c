@@ -0,0 +1,400 @@
+/**
+ * @file book.c
+ * @brief Implementation of the opening book.
+ *
+ * This file contains the enumeration and search of the positions of the
+ * book, the reading and writing of book files and the lookup of a position.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "book.h"
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+#include "search.h"
+
+/**
+ * @def BOOK_HEADER_SIZE
+ * @brief Size of the header of a book file, in bytes.
+ */
+#define BOOK_HEADER_SIZE 32
+
+/**
+ * @def BOOK_ENTRY_SIZE
+ * @brief Size of an entry of a book file, in bytes.
+ */
+#define BOOK_ENTRY_SIZE 11
+
+/**
+ * @struct book_position
+ * @brief A position to search while the book is built.
+ */
+typedef struct {
+    uint64_t key; /**< Hash of the position. */
+    game_state state; /**< The position. */
+} book_position;
+
+/**
+ * @struct position_list
+ * @brief A growing array of positions.
+ */
+typedef struct {
+    book_position *positions; /**< The positions. */
+    uint32_t count; /**< Number of positions. */
+    uint32_t capacity; /**< Number of positions allocated. */
+} position_list;
+
+/**
+ * @brief Adds a position to a list, growing it if needed.
+ *
+ * @param list The list.
+ * @param state The position.
+ * @return true if the position was added, false if memory ran out.
+ */
+static bool
+position_list_add (position_list *list, const game_state *state)
+{
+    if (list->count == list->capacity) {
+        uint32_t capacity = list->capacity ? 2 * list->capacity : 256;
+        book_position *positions = realloc(list->positions, capacity * sizeof(book_position));
+        if (positions == NULL) {
+            return false;
+        }
+        list->positions = positions;
+        list->capacity = capacity;
+    }
+    list->positions[list->count].key = profile_hash(&state->profile);
+    list->positions[list->count].state = *state;
+    list->count++;
+    return true;
+}
+
+/**
+ * @brief Compares two positions by key, for qsort().
+ *
+ * @param a The first position.
+ * @param b The second position.
+ * @return A negative, zero or positive value if a is before, equal to or after b.
+ */
+static int
+compare_positions (const void *a, const void *b)
+{
+    uint64_t key_a = ((const book_position *) a)->key;
+    uint64_t key_b = ((const book_position *) b)->key;
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+/**
+ * @brief Sorts the positions of a list from an index and drops the duplicates.
+ *
+ * @param list The list.
+ * @param begin The index of the first position to sort.
+ */
+static void
+position_list_unique (position_list *list, uint32_t begin)
+{
+    if (list->count - begin < 2) {
+        return;
+    }
+    qsort(list->positions + begin, list->count - begin, sizeof(book_position), compare_positions);
+    uint32_t kept = begin + 1;
+    for (uint32_t i = begin + 1; i < list->count; i++) {
+        if (list->positions[i].key != list->positions[kept - 1].key) {
+            list->positions[kept++] = list->positions[i];
+        }
+    }
+    list->count = kept;
+}
+
+/**
+ * @brief Lists the positions reachable in fewer than plies moves from the full board.
+ *
+ * Finished games are left out, they have no move to store.
+ *
+ * @param list The list to fill, sorted by key and without duplicates.
+ * @param plies The number of plies covered.
+ * @return true if the positions were listed, false if memory ran out.
+ */
+static bool
+list_book_positions (position_list *list, int plies)
+{
+    static int possible_moves[ROWS * COLS][2];
+    game_state start;
+    game_state_init(&start);
+    if (!position_list_add(list, &start)) {
+        return false;
+    }
+
+    uint32_t level_begin = 0;
+    for (int ply = 1; ply < plies; ply++) {
+        uint32_t level_end = list->count;
+        for (uint32_t i = level_begin; i < level_end; i++) {
+            game_state state = list->positions[i].state;
+            int num_moves = game_state_legal_moves(&state, possible_moves);
+            for (int m = 0; m < num_moves; m++) {
+                game_state next = state;
+                game_state_apply_move(&next, possible_moves[m][0], possible_moves[m][1]);
+                if (next.profile.row_len[0] == 0) {
+                    continue;
+                }
+                if (!position_list_add(list, &next)) {
+                    return false;
+                }
+            }
+        }
+        position_list_unique(list, level_end);
+        level_begin = level_end;
+    }
+
+    // A position can be reached after different numbers of plies
+    position_list_unique(list, 0);
+    return true;
+}
+
+/**
+ * @brief Builds the book of the current board configuration.
+ *
+ * Every position reachable in fewer than plies moves from the full board is
+ * searched with the alpha-beta engine.
+ *
+ * @param book The book to fill, freed with book_free().
+ * @param plies The number of plies covered.
+ * @param max_depth The depth limit of the search of each position, 0 for none.
+ * @param time_budget_ms The time the search of each position may take, in milliseconds, 0 for no limit.
+ * @param num_threads The number of threads of the search, 0 for one per processor.
+ * @return true if the book was built, false if memory ran out.
+ */
+bool
+book_build (opening_book *book, int plies, int max_depth, int time_budget_ms, int num_threads)
+{
+    memset(book, 0, sizeof(*book));
+    position_list list = {NULL, 0, 0};
+    search_engine engine;
+    if (!search_engine_init(&engine, SEARCH_DEFAULT_TABLE_BITS, num_threads)) {
+        return false;
+    }
+    if (!list_book_positions(&list, plies)) {
+        free(list.positions);
+        search_engine_free(&engine);
+        return false;
+    }
+
+    book->entries = malloc(list.count * sizeof(book_entry));
+    if (book->entries == NULL) {
+        free(list.positions);
+        search_engine_free(&engine);
+        return false;
+    }
+
+    // The transposition table is kept from one position to the next, most of them share their subtrees
+    for (uint32_t i = 0; i < list.count; i++) {
+        search_result result = search_best_move(&engine, &list.positions[i].state, max_depth, time_budget_ms);
+        book_entry *entry = &book->entries[book->num_entries];
+        if (result.row < 0) {
+            continue;
+        }
+        entry->key = list.positions[i].key;
+        entry->move = (int16_t) (result.row * COLS + result.col);
+        entry->result = result.score >= SEARCH_WIN_SCORE - SEARCH_MAX_PLY ? 1
+                      : result.score <= -(SEARCH_WIN_SCORE - SEARCH_MAX_PLY) ? -1 : 0;
+        book->num_entries++;
+    }
+
+    book->rows = board_rows;
+    book->cols = board_cols;
+    book->max_to_delete = num_max_to_delete;
+    book->plies = plies;
+    free(list.positions);
+    search_engine_free(&engine);
+    return true;
+}
+
+/**
+ * @brief Writes an unsigned integer in little-endian order.
+ *
+ * @param buffer Where to write it.
+ * @param value The value.
+ * @param size The number of bytes written.
+ */
+static void
+put_le (unsigned char *buffer, uint64_t value, int size)
+{
+    for (int i = 0; i < size; i++) {
+        buffer[i] = (unsigned char) (value >> (8 * i));
+    }
+}
+
+/**
+ * @brief Reads an unsigned integer written in little-endian order.
+ *
+ * @param buffer Where to read it.
+ * @param size The number of bytes read.
+ * @return The value.
+ */
+static uint64_t
+get_le (const unsigned char *buffer, int size)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++) {
+        value |= (uint64_t) buffer[i] << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Writes a book to a file.
+ *
+ * @param book The book.
+ * @param path The path of the file.
+ * @return true if the file was written, false otherwise.
+ */
+bool
+book_save (const opening_book *book, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    unsigned char header[BOOK_HEADER_SIZE] = {0};
+    memcpy(header, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    put_le(header + 8, BOOK_VERSION, 4);
+    put_le(header + 12, (uint64_t) book->rows, 4);
+    put_le(header + 16, (uint64_t) book->cols, 4);
+    put_le(header + 20, (uint64_t) book->max_to_delete, 4);
+    put_le(header + 24, (uint64_t) book->plies, 4);
+    put_le(header + 28, book->num_entries, 4);
+    bool written = fwrite(header, sizeof(header), 1, file) == 1;
+
+    for (uint32_t i = 0; written && i < book->num_entries; i++) {
+        unsigned char buffer[BOOK_ENTRY_SIZE];
+        put_le(buffer, book->entries[i].key, 8);
+        put_le(buffer + 8, (uint16_t) book->entries[i].move, 2);
+        buffer[10] = (unsigned char) book->entries[i].result;
+        written = fwrite(buffer, sizeof(buffer), 1, file) == 1;
+    }
+
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * @brief Reads a book from a file.
+ *
+ * @param book The book to fill, freed with book_free().
+ * @param path The path of the file.
+ * @return true if the file is a valid book, false otherwise.
+ */
+bool
+book_load (opening_book *book, const char *path)
+{
+    memset(book, 0, sizeof(*book));
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    unsigned char header[BOOK_HEADER_SIZE];
+    if (fread(header, sizeof(header), 1, file) != 1
+        || memcmp(header, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0
+        || get_le(header + 8, 4) != BOOK_VERSION) {
+        fclose(file);
+        return false;
+    }
+    int rows = (int) get_le(header + 12, 4);
+    int cols = (int) get_le(header + 16, 4);
+    int max_to_delete = (int) get_le(header + 20, 4);
+    uint32_t num_entries = (uint32_t) get_le(header + 28, 4);
+    if (rows < 1 || rows > ROWS || cols < 1 || cols > COLS || max_to_delete < 1) {
+        fclose(file);
+        return false;
+    }
+
+    book->entries = malloc(((size_t) num_entries + 1) * sizeof(book_entry));
+    if (book->entries == NULL) {
+        fclose(file);
+        return false;
+    }
+    for (uint32_t i = 0; i < num_entries; i++) {
+        unsigned char buffer[BOOK_ENTRY_SIZE];
+        book_entry *entry = &book->entries[i];
+        if (fread(buffer, sizeof(buffer), 1, file) != 1) {
+            break;
+        }
+        entry->key = get_le(buffer, 8);
+        entry->move = (int16_t) get_le(buffer + 8, 2);
+        entry->result = (int8_t) buffer[10];
+        // The binary search needs the keys sorted, and the moves must be on the board
+        if ((i > 0 && entry->key <= book->entries[i - 1].key)
+            || entry->move < 0 || entry->move / COLS >= rows || entry->move % COLS >= cols) {
+            break;
+        }
+        book->num_entries++;
+    }
+    fclose(file);
+
+    if (book->num_entries != num_entries) {
+        book_free(book);
+        return false;
+    }
+    book->rows = rows;
+    book->cols = cols;
+    book->max_to_delete = max_to_delete;
+    book->plies = (int) get_le(header + 24, 4);
+    return true;
+}
+
+/**
+ * @brief Frees the entries of a book and empties it.
+ *
+ * @param book The book.
+ */
+void
+book_free (opening_book *book)
+{
+    free(book->entries);
+    memset(book, 0, sizeof(*book));
+}
+
+/**
+ * @brief Finds the move of a position in a book.
+ *
+ * @param book The book.
+ * @param state The position.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if the position is in the book, false if it is not or the book is for another board.
+ */
+bool
+book_lookup (const opening_book *book, const game_state *state, int *row, int *col)
+{
+    if (book->num_entries == 0 || book->rows != board_rows || book->cols != board_cols
+        || book->max_to_delete != num_max_to_delete) {
+        return false;
+    }
+
+    uint64_t key = profile_hash(&state->profile);
+    uint32_t low = 0;
+    uint32_t high = book->num_entries;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (book->entries[middle].key < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == book->num_entries || book->entries[low].key != key) {
+        return false;
+    }
+
+    // A position missing from the book can share the hash of one inside it, its move may not be legal
+    int move = book->entries[low].move;
+    if (!game_state_is_legal_move(state, move / COLS, move % COLS)) {
+        return false;
+    }
+    *row = move / COLS;
+    *col = move % COLS;
+    return true;
+}
@@ -9,13 +9,191 @@
  */
 
 #include "chomp.h"
+#include "bitboard.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include "const.h"
 
-const char *translate[] = {"A", "B", "C", "D", "E", "F", "G", "H", "I"};
+int board_rows = DEFAULT_ROWS;
+int board_cols = DEFAULT_COLS;
+int num_max_to_delete = DEFAULT_NUM_MAX_TO_DELETE;
+
+/**
+ * @brief Sets the board dimensions and the deletion limit.
+ *
+ * This function changes the size of the board used by every game started
+ * afterwards, and rebuilds the bitboard masks for the new size.
+ *
+ * @param rows The number of rows, between 1 and ROWS.
+ * @param cols The number of columns, between 1 and COLS.
+ * @param max_to_delete The maximum number of cells deleted in one move.
+ * @return true if the configuration is valid and was applied, false otherwise.
+ */
+bool
+set_board_config (int rows, int cols, int max_to_delete)
+{
+    if (rows < 1 || rows > ROWS || cols < 1 || cols > COLS || max_to_delete < 1) {
+        return false;
+    }
+    board_rows = rows;
+    board_cols = cols;
+    num_max_to_delete = max_to_delete;
+    bitboard_setup(); // Masks depend on the board dimensions
+    return true;
+}
+
+/**
+ * @brief Writes the label of a column.
+ *
+ * Columns are labelled A to Z, then AA, AB and so on.
+ *
+ * @param col The column.
+ * @param label The buffer to fill, at least CELL_LABEL_SIZE bytes.
+ */
+void
+column_label (int col, char *label)
+{
+    if (col < 26) {
+        label[0] = (char) ('A' + col);
+        label[1] = '\0';
+    } else {
+        label[0] = (char) ('A' + col / 26 - 1);
+        label[1] = (char) ('A' + col % 26);
+        label[2] = '\0';
+    }
+}
+
+/**
+ * @brief Writes the label of a cell, such as "A1".
+ *
+ * @param row The row of the cell.
+ * @param col The column of the cell.
+ * @param label The buffer to fill, at least CELL_LABEL_SIZE bytes.
+ */
+void
+format_cell (int row, int col, char *label)
+{
+    column_label(col, label);
+    snprintf(label + strlen(label), CELL_LABEL_SIZE - strlen(label), "%d", row + 1);
+}
+
+/**
+ * @brief Parses the label of a cell, such as "A1" or "b12".
+ *
+ * @param input The label to parse.
+ * @param row Where to store the row of the cell.
+ * @param col Where to store the column of the cell.
+ * @return true if the label names a cell of the board, false otherwise.
+ */
+bool
+parse_cell (const char *input, int *row, int *col)
+{
+    int i = 0;
+    int col_tmp = 0;
+    while (isalpha((unsigned char) input[i]) && i < 2) {
+        col_tmp = col_tmp * 26 + (toupper((unsigned char) input[i]) - 'A' + 1);
+        i++;
+    }
+    if (i == 0 || !isdigit((unsigned char) input[i])) {
+        return false;
+    }
+    char *end;
+    long row_tmp = strtol(input + i, &end, 10);
+    if (*end != '\0' || row_tmp < 1 || row_tmp > board_rows || col_tmp > board_cols) {
+        return false;
+    }
+    *row = (int) row_tmp - 1;
+    *col = col_tmp - 1;
+    return true;
+}
+
+/**
+ * @brief Reads a positive decimal number at the start of a string.
+ *
+ * @param input The string to read.
+ * @param end Where to store the first character after the number.
+ * @param value Where to store the number.
+ * @return true if the string starts with a digit and the number fits in an int, false otherwise.
+ */
+static bool
+parse_number (const char *input, char **end, int *value)
+{
+    if (!isdigit((unsigned char) input[0])) {
+        return false;
+    }
+    errno = 0;
+    long value_tmp = strtol(input, end, 10);
+    if (errno == ERANGE || value_tmp > INT_MAX) {
+        return false;
+    }
+    *value = (int) value_tmp;
+    return true;
+}
+
+/**
+ * @brief Parses a board size, such as "7x9".
+ *
+ * @param input The size to parse.
+ * @param rows Where to store the number of rows.
+ * @param cols Where to store the number of columns.
+ * @return true if the input is exactly <rows>x<cols>, false otherwise.
+ */
+bool
+parse_board_size (const char *input, int *rows, int *cols)
+{
+    char *end;
+    int rows_tmp, cols_tmp;
+    if (!parse_number(input, &end, &rows_tmp) || *end != 'x' || !parse_number(end + 1, &end, &cols_tmp) || *end != '\0') {
+        return false;
+    }
+    *rows = rows_tmp;
+    *cols = cols_tmp;
+    return true;
+}
+
+/**
+ * @brief Parses a deletion limit, such as "5".
+ *
+ * @param input The limit to parse.
+ * @param max_to_delete Where to store the limit.
+ * @return true if the input is exactly a number, false otherwise.
+ */
+bool
+parse_max_to_delete (const char *input, int *max_to_delete)
+{
+    char *end;
+    int max_to_delete_tmp;
+    if (!parse_number(input, &end, &max_to_delete_tmp) || *end != '\0') {
+        return false;
+    }
+    *max_to_delete = max_to_delete_tmp;
+    return true;
+}
+
+/**
+ * @brief Parses a count given on the command line, such as "2000".
+ *
+ * @param input The count to parse.
+ * @param min The smallest valid count.
+ * @param value Where to store the count.
+ * @return true if the input is exactly a number of at least min, false otherwise.
+ */
+bool
+parse_count (const char *input, int min, int *value)
+{
+    char *end;
+    int value_tmp;
+    if (!parse_number(input, &end, &value_tmp) || *end != '\0' || value_tmp < min) {
+        return false;
+    }
+    *value = value_tmp;
+    return true;
+}
 
 /**
  * @brief Flushes and trims the input string.
@@ -77,10 +255,18 @@ is_this_cell_1_or_0 (int table[ROWS][COLS], int row, int col)
 void
 print_table (int table[ROWS][COLS], int col, int row)
 {
-    printf("\n\033[1;34m    A    B    C    D    E    F    G    H    I\033[0m\n");
-    for (int i = 0; i < ROWS; i++) {
-        printf("\033[1;34m%d \033[0m", i + 1);
-        for (int j = 0; j < COLS; j++) {
+    char label[CELL_LABEL_SIZE];
+    int row_width = (board_rows >= 10) ? 2 : 1;
+
+    printf("\n\033[1;34m%*s", row_width + 1, "");
+    for (int j = 0; j < board_cols; j++) {
+        column_label(j, label);
+        printf("  %-3s", label);
+    }
+    printf("\033[0m\n");
+    for (int i = 0; i < board_rows; i++) {
+        printf("\033[1;34m%*d \033[0m", row_width, i + 1);
+        for (int j = 0; j < board_cols; j++) {
             if (col == j && row == i) {
                 printf(" \033[1;33;43;1m   \033[0m "); // Highlight selected cell
             } else {
@@ -125,8 +311,13 @@ print_table (int table[ROWS][COLS], int col, int row)
 void
 delete_cells (int table[ROWS][COLS], int row, int col)
 {
-    int tmp_col = COLS;
-    for (int i = row; i < ROWS; i++) {
+    if (bitboard_fits()) {
+        bitboard board = bitboard_from_table(table);
+        bitboard_to_table(bitboard_delete_cells(board, row, col), table); // Clear the quadrant mask
+        return;
+    }
+    int tmp_col = board_cols;
+    for (int i = row; i < board_rows; i++) {
         for (int j = col; j < tmp_col; j++) {
             if (table[i][j] == 0) {
                 tmp_col = j; // Stop deleting if a cell is already deleted
@@ -151,30 +342,156 @@ delete_cells (int table[ROWS][COLS], int row, int col)
 int
 calculate_num_to_delete (int table[ROWS][COLS], int row, int col)
 {
-    int tmp_col = COLS;
+    if (bitboard_fits()) {
+        return bitboard_num_to_delete(bitboard_from_table(table), row, col); // Popcount of the quadrant
+    }
     int num_cell_to_delete = 0;
-    for (int i = row; i < ROWS; i++) {
-        for (int j = col; j < tmp_col; j++) {
-            if (table[i][j] == 1) {
-                num_cell_to_delete++; // Count cells to delete
-            } else {
-                if (i == 0) {
-                    break; // Stop if top row is reached
-                }
-                tmp_col = j; // Update column limit
-                break;
-            }
+    for (int i = row; i < board_rows && table[i][col] == 1; i++) {
+        for (int j = col; j < board_cols && table[i][j] == 1; j++) {
+            num_cell_to_delete++; // Count cells to delete
         }
     }
     return num_cell_to_delete;
 }
 
+/**
+ * @brief Lists the moves of a legal move mask in row-major order.
+ *
+ * Called with the constant column count of the default board so the
+ * division and modulo become multiplications.
+ */
+static inline int
+moves_from_mask (bitboard legal, int cols, int possible_moves[][2])
+{
+    int move_index = 0;
+    while (legal) {
+        int index = __builtin_ctzll(legal); // Cells come out in row-major order
+        legal &= legal - 1;
+        possible_moves[move_index][0] = index / cols;
+        possible_moves[move_index][1] = index % cols;
+        move_index++;
+    }
+    return move_index;
+}
+
+/**
+ * @brief Fills the deletion count matrix of the first rows x cols cells.
+ *
+ * Called with the constant dimensions of the default board so the compiler
+ * can unroll the loops.
+ */
+static inline void
+all_num_to_delete_sized (int table[ROWS][COLS], int counts[ROWS][COLS], uint64_t legal[ROWS], int rows, int cols)
+{
+    for (int i = rows - 1; i >= 0; i--) {
+        int row_sum = 0; // Cells present from column j to the end of row i
+        legal[i] = 0;
+        for (int j = cols - 1; j >= 0; j--) {
+            row_sum += table[i][j] != 0;
+            counts[i][j] = row_sum + (i + 1 < rows ? counts[i + 1][j] : 0);
+            if (table[i][j] != 0 && counts[i][j] <= num_max_to_delete) {
+                legal[i] |= UINT64_C(1) << j;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Calculates the number of cells to delete for every cell at once.
+ *
+ * The quadrant of a cell is its own row suffix plus the quadrant of the cell
+ * below it, so the whole matrix is filled in a single pass from the
+ * bottom-right corner.
+ *
+ * @param table The game table.
+ * @param counts The matrix to fill with the number of cells each move would delete.
+ * @param legal The masks to fill, bit j of legal[i] is set if the cell (i, j) is a legal move.
+ */
+void
+calculate_all_num_to_delete (int table[ROWS][COLS], int counts[ROWS][COLS], uint64_t legal[ROWS])
+{
+    if (board_rows == DEFAULT_ROWS && board_cols == DEFAULT_COLS) {
+        all_num_to_delete_sized(table, counts, legal, DEFAULT_ROWS, DEFAULT_COLS);
+    } else {
+        all_num_to_delete_sized(table, counts, legal, board_rows, board_cols);
+    }
+}
+
+/**
+ * @brief Lists the moves of per-row legal move masks in row-major order.
+ */
+static int
+moves_from_row_masks (const uint64_t legal[ROWS], int possible_moves[][2])
+{
+    int move_index = 0;
+    for (int i = 0; i < board_rows; i++) {
+        uint64_t row_legal = legal[i];
+        while (row_legal) {
+            possible_moves[move_index][0] = i;
+            possible_moves[move_index][1] = __builtin_ctzll(row_legal);
+            row_legal &= row_legal - 1;
+            move_index++;
+        }
+    }
+    return move_index;
+}
+
+/**
+ * @brief Fills the legal move masks of a table that does not fit in a bitboard.
+ *
+ * Same pass as calculate_all_num_to_delete() but only one row of counts is
+ * kept, so the stack stays small enough for search threads.
+ */
+static void
+legal_row_masks (int table[ROWS][COLS], uint64_t legal[ROWS])
+{
+    int counts[COLS] = {0}; // Deletion counts of the row below
+    for (int i = board_rows - 1; i >= 0; i--) {
+        int row_sum = 0;
+        legal[i] = 0;
+        for (int j = board_cols - 1; j >= 0; j--) {
+            row_sum += table[i][j] != 0;
+            counts[j] += row_sum;
+            if (table[i][j] != 0 && counts[j] <= num_max_to_delete) {
+                legal[i] |= UINT64_C(1) << j;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Lists the possible moves in a caller-provided buffer.
+ *
+ * This function is reentrant: it does not use any static storage, so it can
+ * be called from several threads at once as long as the board configuration
+ * does not change.
+ *
+ * @param table The game table.
+ * @param possible_moves The buffer to fill with the row and column of each move,
+ *        at least board_rows * board_cols entries.
+ * @return The number of possible moves.
+ */
+int
+calculate_possible_moves (int table[ROWS][COLS], int possible_moves[][2])
+{
+    if (board_rows == DEFAULT_ROWS && board_cols == DEFAULT_COLS) {
+        return moves_from_mask(bitboard_legal_moves(bitboard_from_table(table)), DEFAULT_COLS, possible_moves);
+    } else if (bitboard_fits()) {
+        return moves_from_mask(bitboard_legal_moves(bitboard_from_table(table)), board_cols, possible_moves);
+    }
+    uint64_t legal[ROWS];
+    legal_row_masks(table, legal);
+    return moves_from_row_masks(legal, possible_moves);
+}
+
 /**
  * @brief Calculates the possible moves.
  *
  * This function calculates the possible moves based on the current state of the
  * game table. It returns a pointer to a static array of possible moves, where each
  * move is represented by a pair of integers indicating the row and column.
+ * The moves are followed by -1 entries. It is a wrapper around
+ * calculate_possible_moves() and is not reentrant.
  *
  * @param table The game table.
  * @return A pointer to a static array of pairs of integers representing the possible moves.
@@ -182,19 +499,10 @@ calculate_num_to_delete (int table[ROWS][COLS], int row, int col)
 int
 (*calculate_possibility (int table[ROWS][COLS]))[2]
 {
-    static int possible_moves[ROWS * COLS][2];
-    int move_index = 0;
+    static int possible_moves[ROWS * COLS + 1][2]; // Room for the end marker
+    int move_index = calculate_possible_moves(table, possible_moves);
 
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
-            if (table[i][j] == 1 && calculate_num_to_delete(table, i, j) <= NUM_MAX_TO_DELETE) {
-                possible_moves[move_index][0] = i;
-                possible_moves[move_index][1] = j;
-                move_index++;
-            }
-        }
-    }
-    for (int i = move_index; i < ROWS * COLS; i++) {
+    for (int i = move_index; i <= board_rows * board_cols; i++) {
         possible_moves[i][0] = -1; // Mark remaining moves as invalid
         possible_moves[i][1] = -1;
     }
@@ -219,33 +527,18 @@ play_game (int table[ROWS][COLS], bool *flag)
     char user_input[MAX_INPUT_SIZE + 1];
 
     while (*flag) {  // Main game loop
-        int col_ok = 0;
         print_table(table, col, row); // Print current game state
-        calculate_possibility(table); // Calculate possible moves
         if (tour_number % 2 == 0) {
             printf("\033[1m%s, it's your turn\033[0m\n", player1);
         } else {
             printf("\033[1m%s, it's your turn\033[0m\n", player2);
         }
-        printf("Enter cell id (between A-I and 1-7): ");
+        char last_cell[CELL_LABEL_SIZE];
+        format_cell(board_rows - 1, board_cols - 1, last_cell);
+        printf("Enter cell id (between A1 and %s): ", last_cell);
         flush_and_trim_input(user_input, sizeof(user_input)); // Get user input
-        if (strlen(user_input) != 2) {
-            printf("\033[1;31m\nInvalid input.\nInput must be exactly two characters.\033[0m\n");
-            continue;
-        }
-        user_input[0] = toupper(user_input[0]); // Convert column to uppercase
-
-        for (int j = 0; j < COLS; j++) {
-            if (user_input[0] == translate[j][0]) {
-                col_tmp = j;
-                col_ok = 1;
-                break;
-            }
-        }
-        row_tmp = user_input[1] - '0' - 1; // Convert row to integer
-
-        if (col_ok == 0 || row_tmp < 0 || row_tmp >= ROWS) {
-            printf("\033[1;31m\nInvalid input.\n%s is not in the range A1 to I7.\033[0m\n", user_input);
+        if (!parse_cell(user_input, &row_tmp, &col_tmp)) {
+            printf("\033[1;31m\nInvalid input.\n%s is not in the range A1 to %s.\033[0m\n", user_input, last_cell);
             continue;
         }
         if (is_this_cell_1_or_0(table, row_tmp, col_tmp) == 1) {
@@ -253,13 +546,13 @@ play_game (int table[ROWS][COLS], bool *flag)
             continue;
         }
 
-        if (calculate_num_to_delete(table, row_tmp, col_tmp) <= NUM_MAX_TO_DELETE) {
+        if (calculate_num_to_delete(table, row_tmp, col_tmp) <= num_max_to_delete) {
             row = row_tmp;
             col = col_tmp;
             delete_cells(table, row, col); // Delete selected cells
             tour_number++;
         } else {
-            printf("\033[1;31m\nInvalid input.\nYou can delete at most 5 cells.\033[0m\n");
+            printf("\033[1;31m\nInvalid input.\nYou can delete at most %d cells.\033[0m\n", num_max_to_delete);
         }
 
         if (table[0][0] == 0) { // Check if game is over
@@ -272,14 +565,20 @@ play_game (int table[ROWS][COLS], bool *flag)
 /**
  * @brief Initializes the game table.
  *
- * This function initializes the game table by setting all cells to 1.
+ * This function initializes the game table by setting all cells of the
+ * board to 1 and every cell outside the board to 0.
  *
  * @param table The game table.
  */
 void init_table (int table[ROWS][COLS])
 {
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
+    memset(table, 0, sizeof(int[ROWS][COLS])); // Cells outside the board stay deleted
+    if (bitboard_fits()) {
+        bitboard_to_table(bitboard_full(), table); // Set all cells to active
+        return;
+    }
+    for (int i = 0; i < board_rows; i++) {
+        for (int j = 0; j < board_cols; j++) {
             table[i][j] = 1; // Set all cells to active
         }
     }
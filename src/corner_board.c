@@ -0,0 +1,604 @@
+/**
+ * @file corner_board.c
+ * @brief Implementation of the sparse corner-list position.
+ *
+ * This file contains the treap of runs (split, merge and node reuse), the
+ * queries answered from the subtree sums and the moves, which replace every
+ * run cut by a move with one run in a single split and merge pass.
+ */
+
+#include "corner_board.h"
+#include <stdlib.h>
+#include <string.h>
+#include "const.h"
+
+/**
+ * @brief Draws the priority of a new node.
+ *
+ * @param board The board.
+ * @return A pseudo-random priority.
+ */
+static uint32_t
+next_priority (corner_board *board)
+{
+    uint32_t x = board->rng; // xorshift32
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    board->rng = x;
+    return x;
+}
+
+/**
+ * @brief Makes sure the next new nodes will not need any allocation.
+ *
+ * A move creates at most two nodes, reserving them first keeps the board
+ * unchanged when memory is missing.
+ *
+ * @param board The board.
+ * @param count The number of nodes needed.
+ * @return true on success, false if memory is missing.
+ */
+static bool
+reserve_nodes (corner_board *board, int count)
+{
+    if (board->num_nodes + count <= board->capacity) {
+        return true;
+    }
+    int capacity = board->capacity * 2;
+    if (capacity < board->num_nodes + count) {
+        capacity = board->num_nodes + count;
+    }
+    corner_run *nodes = realloc(board->nodes, (size_t) capacity * sizeof(corner_run));
+    if (nodes == NULL) {
+        return false;
+    }
+    board->nodes = nodes;
+    board->capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Recomputes the subtree sums of a node from its children.
+ *
+ * @param board The board.
+ * @param t The node.
+ */
+static void
+update_node (corner_board *board, int t)
+{
+    corner_run *node = &board->nodes[t];
+    node->sum_rows = node->end_row - node->first_row;
+    node->sum_cells = node->sum_rows * node->len;
+    if (node->left != -1) {
+        node->sum_rows += board->nodes[node->left].sum_rows;
+        node->sum_cells += board->nodes[node->left].sum_cells;
+    }
+    if (node->right != -1) {
+        node->sum_rows += board->nodes[node->right].sum_rows;
+        node->sum_cells += board->nodes[node->right].sum_cells;
+    }
+}
+
+/**
+ * @brief Creates a node, from the free list if possible.
+ *
+ * The caller reserves the memory first with reserve_nodes.
+ *
+ * @param board The board.
+ * @param first_row The first row of the run.
+ * @param end_row The row after the last row of the run.
+ * @param len The length of the rows of the run.
+ * @return The new node.
+ */
+static int
+new_node (corner_board *board, int64_t first_row, int64_t end_row, int64_t len)
+{
+    int t = board->free_list;
+    if (t != -1) {
+        board->free_list = board->nodes[t].left;
+    } else {
+        t = board->num_nodes++;
+    }
+    corner_run *node = &board->nodes[t];
+    node->first_row = first_row;
+    node->end_row = end_row;
+    node->len = len;
+    node->priority = next_priority(board);
+    node->left = -1;
+    node->right = -1;
+    update_node(board, t);
+    board->num_runs++;
+    return t;
+}
+
+/**
+ * @brief Puts every node of a subtree back in the free list.
+ *
+ * @param board The board.
+ * @param t The subtree, -1 for none.
+ */
+static void
+release_tree (corner_board *board, int t)
+{
+    while (t != -1) {
+        int right = board->nodes[t].right;
+        release_tree(board, board->nodes[t].left);
+        board->nodes[t].left = board->free_list;
+        board->free_list = t;
+        board->num_runs--;
+        t = right;
+    }
+}
+
+/**
+ * @brief Joins two treaps, every run of the first one being above the second one.
+ *
+ * @param board The board.
+ * @param a The upper treap, -1 for none.
+ * @param b The lower treap, -1 for none.
+ * @return The root of the joined treap.
+ */
+static int
+merge_trees (corner_board *board, int a, int b)
+{
+    if (a == -1) {
+        return b;
+    }
+    if (b == -1) {
+        return a;
+    }
+    if (board->nodes[a].priority > board->nodes[b].priority) {
+        board->nodes[a].right = merge_trees(board, board->nodes[a].right, b);
+        update_node(board, a);
+        return a;
+    }
+    board->nodes[b].left = merge_trees(board, a, board->nodes[b].left);
+    update_node(board, b);
+    return b;
+}
+
+/**
+ * @brief Splits a treap on the first row of its runs.
+ *
+ * @param board The board.
+ * @param t The treap, -1 for none.
+ * @param row The first row of the lower part.
+ * @param upper The runs starting before row.
+ * @param lower The runs starting at or after row.
+ */
+static void
+split_tree (corner_board *board, int t, int64_t row, int *upper, int *lower)
+{
+    if (t == -1) {
+        *upper = -1;
+        *lower = -1;
+    } else if (board->nodes[t].first_row < row) {
+        split_tree(board, board->nodes[t].right, row, &board->nodes[t].right, lower);
+        update_node(board, t);
+        *upper = t;
+    } else {
+        split_tree(board, board->nodes[t].left, row, upper, &board->nodes[t].left);
+        update_node(board, t);
+        *lower = t;
+    }
+}
+
+/**
+ * @brief Ends the last run of a treap at the given row.
+ *
+ * @param board The board.
+ * @param t The treap, not empty.
+ * @param row The new end of the last run.
+ */
+static void
+cut_last_run (corner_board *board, int t, int64_t row)
+{
+    if (board->nodes[t].right != -1) {
+        cut_last_run(board, board->nodes[t].right, row);
+    } else {
+        board->nodes[t].end_row = row;
+    }
+    update_node(board, t);
+}
+
+/**
+ * @brief Finds the run containing a row.
+ *
+ * @param board The board.
+ * @param row The row.
+ * @return The node of the run, -1 if the row is empty or outside the board.
+ */
+static int
+find_run (const corner_board *board, int64_t row)
+{
+    int t = board->root;
+    while (t != -1) {
+        const corner_run *node = &board->nodes[t];
+        if (row < node->first_row) {
+            t = node->left;
+        } else if (row >= node->end_row) {
+            t = node->right;
+        } else {
+            return t;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Counts the cells of the rows above a row.
+ *
+ * @param board The board.
+ * @param row The row.
+ * @return The number of cells in rows 0 to row - 1.
+ */
+static int64_t
+cells_before (const corner_board *board, int64_t row)
+{
+    int64_t total = 0;
+    int t = board->root;
+    while (t != -1) {
+        const corner_run *node = &board->nodes[t];
+        if (row <= node->first_row) {
+            t = node->left;
+            continue;
+        }
+        if (node->left != -1) {
+            total += board->nodes[node->left].sum_cells;
+        }
+        int64_t end = row < node->end_row ? row : node->end_row;
+        total += (end - node->first_row) * node->len;
+        if (row <= node->end_row) {
+            break;
+        }
+        t = node->right;
+    }
+    return total;
+}
+
+/**
+ * @brief Initializes a full board.
+ *
+ * @param board The board to initialize.
+ * @param rows The number of rows, at least 1.
+ * @param cols The number of columns, at least 1.
+ * @param limit The maximum number of cells a move may delete, at least 1.
+ * @return true on success, false if a size is invalid or memory is missing.
+ */
+bool
+corner_board_init (corner_board *board, int64_t rows, int64_t cols, int64_t limit)
+{
+    memset(board, 0, sizeof(*board));
+    board->free_list = -1;
+    board->root = -1;
+    board->rng = 0x9E3779B9u;
+    if (rows < 1 || cols < 1 || limit < 1 || rows > INT64_MAX / cols) {
+        return false;
+    }
+    board->rows = rows;
+    board->cols = cols;
+    board->limit = limit;
+    if (!reserve_nodes(board, 16)) {
+        return false;
+    }
+    board->root = new_node(board, 0, rows, cols);
+    return true;
+}
+
+/**
+ * @brief Frees the memory of a board.
+ *
+ * @param board The board.
+ */
+void
+corner_board_free (corner_board *board)
+{
+    free(board->nodes);
+    board->nodes = NULL;
+    board->capacity = 0;
+    board->num_nodes = 0;
+    board->num_runs = 0;
+    board->free_list = -1;
+    board->root = -1;
+}
+
+/**
+ * @brief Builds a board from an int table of the current configuration.
+ *
+ * @param table The game table.
+ * @param board The board to initialize, freed with corner_board_free.
+ * @return true on success, false if memory is missing.
+ */
+bool
+corner_board_from_table (int table[ROWS][COLS], corner_board *board)
+{
+    if (!corner_board_init(board, board_rows, board_cols, num_max_to_delete)) {
+        return false;
+    }
+    release_tree(board, board->root);
+    board->root = -1;
+
+    int first_row = 0;
+    int64_t run_len = -1;
+    for (int i = 0; i <= board_rows; i++) {
+        int len = 0;
+        while (i < board_rows && len < board_cols && table[i][len] == 1) {
+            len++;
+        }
+        if (len != run_len) {
+            if (run_len > 0) {
+                if (!reserve_nodes(board, 1)) {
+                    corner_board_free(board);
+                    return false;
+                }
+                board->root = merge_trees(board, board->root, new_node(board, first_row, i, run_len));
+            }
+            first_row = i;
+            run_len = len;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a board back to an int table.
+ *
+ * @param board The board, no bigger than ROWS x COLS.
+ * @param table The game table to fill.
+ */
+void
+corner_board_to_table (const corner_board *board, int table[ROWS][COLS])
+{
+    for (int i = 0; i < ROWS; i++) {
+        for (int j = 0; j < COLS; j++) {
+            table[i][j] = corner_board_is_cell_set(board, i, j) ? 1 : 0;
+        }
+    }
+}
+
+/**
+ * @brief Checks if the specified cell is still present.
+ *
+ * @param board The board.
+ * @param row The row of the cell.
+ * @param col The column of the cell.
+ * @return true if the cell is present, false if it was eaten or is outside.
+ */
+bool
+corner_board_is_cell_set (const corner_board *board, int64_t row, int64_t col)
+{
+    if (col < 0) {
+        return false;
+    }
+    int t = find_run(board, row);
+    return t != -1 && col < board->nodes[t].len;
+}
+
+/**
+ * @brief Calculates the number of cells left in a row.
+ *
+ * @param board The board.
+ * @param row The row.
+ * @return The length of the row, 0 if it is empty or outside the board.
+ */
+int64_t
+corner_board_row_len (const corner_board *board, int64_t row)
+{
+    int t = find_run(board, row);
+    return t == -1 ? 0 : board->nodes[t].len;
+}
+
+/**
+ * @brief Calculates the number of rows longer than a column.
+ *
+ * The runs are ordered by row and their lengths decrease, so the rows longer
+ * than the column end with the last run longer than it.
+ *
+ * @param board The board.
+ * @param col The column.
+ * @return The number of cells left in the column.
+ */
+int64_t
+corner_board_col_len (const corner_board *board, int64_t col)
+{
+    int64_t col_len = 0;
+    int t = board->root;
+    while (t != -1) {
+        if (board->nodes[t].len > col) {
+            col_len = board->nodes[t].end_row;
+            t = board->nodes[t].right;
+        } else {
+            t = board->nodes[t].left;
+        }
+    }
+    return col_len;
+}
+
+/**
+ * @brief Calculates the number of cells a move would delete.
+ *
+ * The cut rows are row to col_len(col) - 1, the count is their cells minus
+ * the col cells each of them keeps.
+ *
+ * @param board The board.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return The number of cells to delete, 0 if the cell is not present.
+ */
+int64_t
+corner_board_num_to_delete (const corner_board *board, int64_t row, int64_t col)
+{
+    if (!corner_board_is_cell_set(board, row, col)) {
+        return 0;
+    }
+    int64_t end_row = corner_board_col_len(board, col);
+    return cells_before(board, end_row) - cells_before(board, row) - col * (end_row - row);
+}
+
+/**
+ * @brief Checks if a move is legal.
+ *
+ * @param board The board.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return true if the cell is present and the move deletes at most limit cells.
+ */
+bool
+corner_board_is_legal_move (const corner_board *board, int64_t row, int64_t col)
+{
+    int64_t num_cell_to_delete = corner_board_num_to_delete(board, row, col);
+    return num_cell_to_delete > 0 && num_cell_to_delete <= board->limit;
+}
+
+/**
+ * @brief Deletes the cells of a move.
+ *
+ * The treap is split into the runs above the move, the cut runs and the runs
+ * below them. The cut runs are freed and replaced by one run of length col,
+ * which takes over the first run below when it has the same length.
+ *
+ * @param board The board.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return true on success, false if memory is missing (the board is unchanged).
+ */
+bool
+corner_board_delete_cells (corner_board *board, int64_t row, int64_t col)
+{
+    if (!corner_board_is_cell_set(board, row, col)) {
+        return true;
+    }
+    if (!reserve_nodes(board, 2)) {
+        return false;
+    }
+    int64_t end_row = corner_board_col_len(board, col);
+
+    int upper, middle, lower;
+    split_tree(board, board->root, row, &upper, &middle);
+    if (upper != -1) {
+        int last = upper;
+        while (board->nodes[last].right != -1) {
+            last = board->nodes[last].right;
+        }
+        if (board->nodes[last].end_row > row) { // The move cuts this run in two
+            int64_t old_end = board->nodes[last].end_row;
+            int64_t len = board->nodes[last].len;
+            cut_last_run(board, upper, row);
+            middle = merge_trees(board, new_node(board, row, old_end, len), middle);
+        }
+    }
+    split_tree(board, middle, end_row, &middle, &lower);
+    release_tree(board, middle);
+
+    if (col == 0) { // Every row from the chosen one is empty
+        release_tree(board, lower);
+        board->root = upper;
+        return true;
+    }
+    int64_t new_end = end_row;
+    if (lower != -1) {
+        int first = lower;
+        while (board->nodes[first].left != -1) {
+            first = board->nodes[first].left;
+        }
+        if (board->nodes[first].len == col) { // Same length, both runs become one
+            new_end = board->nodes[first].end_row;
+            int same;
+            split_tree(board, lower, board->nodes[first].first_row + 1, &same, &lower);
+            release_tree(board, same);
+        }
+    }
+    int run = new_node(board, row, new_end, col);
+    board->root = merge_trees(board, upper, merge_trees(board, run, lower));
+    return true;
+}
+
+/**
+ * @brief Calculates the number of cells left on the board.
+ *
+ * @param board The board.
+ * @return The number of cells present.
+ */
+int64_t
+corner_board_num_cells (const corner_board *board)
+{
+    return board->root == -1 ? 0 : board->nodes[board->root].sum_cells;
+}
+
+/**
+ * @brief Calculates the number of corners of the staircase.
+ *
+ * @param board The board.
+ * @return The number of runs, 0 for an empty board.
+ */
+int
+corner_board_num_corners (const corner_board *board)
+{
+    return board->num_runs;
+}
+
+/**
+ * @brief Lists the legal moves of the runs of a subtree.
+ *
+ * In a row, the deletion count grows by col_len(j) - row for each step left,
+ * so the walk from the end of the row stops as soon as the limit is
+ * exceeded. Rows more than limit rows above the end of their run have no
+ * legal move at all.
+ *
+ * @param board The board.
+ * @param t The subtree, -1 for none.
+ * @param possible_moves The buffer to fill.
+ * @param max_moves The size of the buffer.
+ * @param num_moves The number of moves found so far, updated.
+ */
+static void
+legal_moves_of_tree (const corner_board *board, int t, int64_t possible_moves[][2], int64_t max_moves, int64_t *num_moves)
+{
+    if (t == -1) {
+        return;
+    }
+    const corner_run *node = &board->nodes[t];
+    legal_moves_of_tree(board, node->left, possible_moves, max_moves, num_moves);
+
+    int64_t first_row = node->end_row - board->limit;
+    if (first_row < node->first_row) {
+        first_row = node->first_row;
+    }
+    for (int64_t i = first_row; i < node->end_row; i++) {
+        int64_t col = node->len;
+        int64_t num_cell_to_delete = 0;
+        while (col > 0) {
+            num_cell_to_delete += corner_board_col_len(board, col - 1) - i;
+            if (num_cell_to_delete > board->limit) {
+                break;
+            }
+            col--;
+        }
+        for (int64_t j = col; j < node->len; j++) {
+            if (*num_moves < max_moves) {
+                possible_moves[*num_moves][0] = i;
+                possible_moves[*num_moves][1] = j;
+            }
+            (*num_moves)++;
+        }
+    }
+
+    legal_moves_of_tree(board, node->right, possible_moves, max_moves, num_moves);
+}
+
+/**
+ * @brief Lists the legal moves in row-major order.
+ *
+ * @param board The board.
+ * @param possible_moves The buffer to fill with the row and column of each move.
+ * @param max_moves The size of the buffer, extra moves are counted but not written.
+ * @return The number of legal moves.
+ */
+int64_t
+corner_board_legal_moves (const corner_board *board, int64_t possible_moves[][2], int64_t max_moves)
+{
+    int64_t num_moves = 0;
+    legal_moves_of_tree(board, board->root, possible_moves, max_moves, &num_moves);
+    return num_moves;
+}
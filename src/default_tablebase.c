@@ -0,0 +1,37 @@
+/**
+ * @file default_tablebase.c
+ * @brief Lookup in the tablebase of the default board.
+ *
+ * The table itself is generated by make_tablebase into the build directory,
+ * this file only reads it.
+ */
+
+#include "default_tablebase.h"
+#include "const.h"
+#include "profile.h"
+#include "staircase.h"
+
+/**
+ * @brief Looks a position up in the generated table.
+ *
+ * @param profile The position.
+ * @param won Where to store true if the player to move wins.
+ * @param row Where to store the row of an optimal move, -1 if the game is over.
+ * @param col Where to store the column of an optimal move, -1 if the game is over.
+ * @return true if the position was found, false if the current board is not the one of the table.
+ */
+bool
+default_tablebase_probe (const chomp_profile *profile, bool *won, int *row, int *col)
+{
+    if (board_rows != default_tablebase_rows || board_cols != default_tablebase_cols
+        || num_max_to_delete != default_tablebase_max_to_delete) {
+        return false;
+    }
+
+    uint8_t entry = default_tablebase_entries[staircase_rank(profile, board_rows)];
+    int cell = entry & DEFAULT_TABLEBASE_NO_MOVE;
+    *won = (entry & DEFAULT_TABLEBASE_WON) != 0;
+    *row = cell == DEFAULT_TABLEBASE_NO_MOVE ? -1 : cell / board_cols;
+    *col = cell == DEFAULT_TABLEBASE_NO_MOVE ? -1 : cell % board_cols;
+    return true;
+}
@@ -12,9 +12,15 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "gestion_user.h"
+#include "chomp.h"
 #include "main_func.h"
 #include "terminal.h"
 #include "gui.h"
+#include "search.h"
+#include "mcts.h"
+#include "ai_engine.h"
+#include "book.h"
+#include "tablebase_file.h"
 
 /**
  * @brief Main function.
@@ -40,6 +46,16 @@ main (int argc, char *argv[])
     char *server_ip = NULL;
     short server_port = 0;
 
+    int rows = DEFAULT_ROWS;
+    int cols = DEFAULT_COLS;
+    int max_to_delete = DEFAULT_NUM_MAX_TO_DELETE;
+
+    bool engine_given = false; // A difficulty level picks the search engine unless an engine was given
+    bool level_given = false;
+
+    char *book_path = NULL; // Opening book of the AI, read once the board is set
+    char *tablebase_path = NULL; // Tablebase file of the perfect engine, mapped once the board is set
+
     // Array to keep track of used arguments (to avoid assigning them multiple times)
     bool used_args[argc];
     for (int i = 0; i < argc; i++) {
@@ -58,6 +74,181 @@ main (int argc, char *argv[])
         } else if (strcmp(argv[i], "-ia") == 0) {
             ai_mode = 1; // Enable AI mode
             used_args[i] = true;
+        } else if (strcmp(argv[i], "-time") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the time budget
+            bool time_found = false;
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    // Get the time the AI may think per move, in milliseconds, 0 for no limit
+                    if (!parse_count(argv[j], 0, &ai_time_budget)) {
+                        fprintf(stderr, "Error: Invalid time budget, use a number of milliseconds.\n");
+                        return 1;
+                    }
+                    used_args[j] = true;
+                    time_found = true;
+                    break;
+                }
+            }
+
+            if (!time_found) {
+                fprintf(stderr, "Error: No time budget specified.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-level") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the difficulty level
+            const ai_level *level = NULL;
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    level = ai_level_find(argv[j]); // Get the difficulty level of the AI
+                    used_args[j] = true;
+                    break;
+                }
+            }
+
+            if (level == NULL) {
+                fprintf(stderr, "Error: No valid level specified. Levels:");
+                for (int l = 0; l < num_ai_levels; l++) {
+                    fprintf(stderr, " %s", ai_levels[l].name);
+                }
+                fprintf(stderr, "\n");
+                return 1;
+            }
+            ai_level_apply(level); // The budgets given after the level override it
+            level_given = true;
+        } else if (strcmp(argv[i], "-engine") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the engine name
+            const ai_engine *engine = NULL;
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    engine = ai_engine_find(argv[j]); // Get the engine the AI plays with
+                    used_args[j] = true;
+                    break;
+                }
+            }
+
+            if (engine == NULL) {
+                fprintf(stderr, "Error: No valid engine specified. Engines:");
+                for (int e = 0; e < num_ai_engines; e++) {
+                    fprintf(stderr, " %s", ai_engines[e].name);
+                }
+                fprintf(stderr, "\n");
+                return 1;
+            }
+            current_ai_engine = engine;
+            engine_given = true;
+        } else if (strcmp(argv[i], "-search") == 0) {
+            current_ai_engine = ai_engine_find("search"); // Same as -engine search
+            engine_given = true;
+            used_args[i] = true;
+        } else if (strcmp(argv[i], "-mcts") == 0) {
+            current_ai_engine = ai_engine_find("mcts"); // Same as -engine mcts
+            engine_given = true;
+            used_args[i] = true;
+        } else if (strcmp(argv[i], "-iterations") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the number of iterations
+            bool iterations_found = false;
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    // Get the number of iterations of each thread per move
+                    if (!parse_count(argv[j], 1, &mcts_iterations)) {
+                        fprintf(stderr, "Error: Invalid number of iterations, use a positive number.\n");
+                        return 1;
+                    }
+                    used_args[j] = true;
+                    iterations_found = true;
+                    break;
+                }
+            }
+
+            if (!iterations_found) {
+                fprintf(stderr, "Error: No number of iterations specified.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-depth") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the search depth
+            bool depth_found = false;
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    // Get the depth limit of the search, in plies, 0 for none
+                    if (!parse_count(argv[j], 0, &search_depth)) {
+                        fprintf(stderr, "Error: Invalid search depth, use a number of plies.\n");
+                        return 1;
+                    }
+                    used_args[j] = true;
+                    depth_found = true;
+                    break;
+                }
+            }
+
+            if (!depth_found) {
+                fprintf(stderr, "Error: No search depth specified.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-threads") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the number of threads
+            bool threads_found = false;
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    // Get the number of threads of the engines, 0 for one per processor
+                    if (!parse_count(argv[j], 0, &search_threads)) {
+                        fprintf(stderr, "Error: Invalid number of threads, use a number, 0 for one per processor.\n");
+                        return 1;
+                    }
+                    mcts_threads = search_threads;
+                    used_args[j] = true;
+                    threads_found = true;
+                    break;
+                }
+            }
+
+            if (!threads_found) {
+                fprintf(stderr, "Error: No number of threads specified.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-book") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the path of the opening book
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    book_path = argv[j]; // Get the path of the opening book
+                    used_args[j] = true;
+                    break;
+                }
+            }
+
+            if (book_path == NULL) {
+                fprintf(stderr, "Error: No opening book specified.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-tablebase") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the path of the tablebase file
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    tablebase_path = argv[j]; // Get the path of the tablebase file
+                    used_args[j] = true;
+                    break;
+                }
+            }
+
+            if (tablebase_path == NULL) {
+                fprintf(stderr, "Error: No tablebase file specified.\n");
+                return 1;
+            }
         } else if (strcmp(argv[i], "-l") == 0) {
             local_mode = 1; // Set mode to local
             used_args[i] = true;
@@ -109,12 +300,92 @@ main (int argc, char *argv[])
                 fprintf(stderr, "Error: No IP:Port specified for client mode.\n");
                 return 1;
             }
+        } else if (strcmp(argv[i], "-size") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the board size
+            bool size_found = false;
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    if (!parse_board_size(argv[j], &rows, &cols)) {
+                        fprintf(stderr, "Error: Invalid board size format, use <rows>x<cols>.\n");
+                        return 1;
+                    }
+                    used_args[j] = true;
+                    size_found = true;
+                    break;
+                }
+            }
+
+            if (!size_found) {
+                fprintf(stderr, "Error: No board size specified.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-limit") == 0) {
+            used_args[i] = true;
+
+            // Search for the next unused non-flag argument as the deletion limit
+            bool limit_found = false;
+            for (int j = i + 1; j < argc; j++) {
+                if (!used_args[j] && argv[j][0] != '-') {
+                    // Get the maximum number of cells deleted by a move
+                    if (!parse_max_to_delete(argv[j], &max_to_delete)) {
+                        fprintf(stderr, "Error: Invalid deletion limit, use a positive number.\n");
+                        return 1;
+                    }
+                    used_args[j] = true;
+                    limit_found = true;
+                    break;
+                }
+            }
+
+            if (!limit_found) {
+                fprintf(stderr, "Error: No deletion limit specified.\n");
+                return 1;
+            }
         } else {
             fprintf(stderr, "Invalid argument: %s\n", argv[i]); // Invalid argument
             return 1;
         }
     }
 
+    if (level_given && !engine_given) {
+        current_ai_engine = ai_engine_find("search");
+    }
+
+    if (!set_board_config(rows, cols, max_to_delete)) {
+        fprintf(stderr, "Error: The board must be between 1x1 and %dx%d and the deletion limit at least 1.\n", ROWS, COLS);
+        return 1;
+    }
+
+    if (book_path != NULL) {
+        if (!book_load(&ai_book, book_path)) {
+            fprintf(stderr, "Error: Could not read the opening book %s.\n", book_path);
+            return 1;
+        }
+        if (ai_book.rows != rows || ai_book.cols != cols || ai_book.max_to_delete != max_to_delete) {
+            fprintf(stderr, "Warning: The opening book is for a %dx%d board with limit %d, it is not used.\n",
+                    ai_book.rows, ai_book.cols, ai_book.max_to_delete);
+        }
+    }
+
+    if (tablebase_path != NULL) {
+        if (!tablebase_file_open(&ai_tablebase_file, tablebase_path)) {
+            fprintf(stderr, "Error: Could not read the tablebase %s.\n", tablebase_path);
+            return 1;
+        }
+        if (ai_tablebase_file.rows != rows || ai_tablebase_file.cols != cols
+            || ai_tablebase_file.max_to_delete != max_to_delete) {
+            fprintf(stderr, "Warning: The tablebase is for a %dx%d board with limit %d, it is not used.\n",
+                    ai_tablebase_file.rows, ai_tablebase_file.cols, ai_tablebase_file.max_to_delete);
+        }
+    }
+
+    // Solve what the engine needs before the game, so no move of the AI waits for it
+    if (ai_mode && !ai_engine_prepare()) {
+        fprintf(stderr, "Warning: The %s engine cannot play this board, the pattern engine plays instead.\n", current_ai_engine->name);
+    }
+
     // Debugging output to verify flag states
     printf("AI Mode: %d, GUI Mode: %d, Server Mode: %d, Client Mode: %d\n", ai_mode, gui_mode, server_mode, client_mode);
 
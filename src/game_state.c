@@ -0,0 +1,289 @@
+/**
+ * @file game_state.c
+ * @brief Implementation of the game state with incremental legal moves.
+ *
+ * This file contains the computation of the first legal column of a row,
+ * the incremental update applied after each move, the undo stack that
+ * takes moves back, the listing of the legal moves and the random choice
+ * of one of them.
+ */
+
+#include "game_state.h"
+#include <stdlib.h>
+#include <string.h>
+#include "const.h"
+#include "profile.h"
+
+/**
+ * @brief Computes the first legal column of a row.
+ *
+ * Walking left from the end of the row, each step adds the cells of the new
+ * column from this row downwards to the deletion count. The walk stops as
+ * soon as the count exceeds the limit, so it takes at most
+ * num_max_to_delete steps. The legal moves of the row are added to the
+ * count of the state, the caller removes the old ones first.
+ *
+ * @param state The game state.
+ * @param row The row to update.
+ */
+static void
+update_row (game_state *state, int row)
+{
+    int col = state->profile.row_len[row];
+    int num_cell_to_delete = 0;
+    while (col > 0) {
+        num_cell_to_delete += profile_col_len(&state->profile, col - 1) - row;
+        if (num_cell_to_delete > num_max_to_delete) {
+            break;
+        }
+        col--;
+    }
+    state->first_legal[row] = (unsigned char) col;
+    state->num_legal_moves += state->profile.row_len[row] - col;
+}
+
+/**
+ * @brief Recomputes the legal moves of every row.
+ *
+ * @param state The game state, with its profile already set.
+ */
+static void
+update_all_rows (game_state *state)
+{
+    state->num_legal_moves = 0;
+    for (int i = 0; i < ROWS; i++) {
+        state->first_legal[i] = 0;
+    }
+    for (int i = 0; i < board_rows; i++) {
+        update_row(state, i);
+    }
+}
+
+/**
+ * @brief Initializes a game state with every cell present.
+ *
+ * @param state The game state to initialize.
+ */
+void
+game_state_init (game_state *state)
+{
+    profile_init(&state->profile);
+    update_all_rows(state);
+}
+
+/**
+ * @brief Builds a game state from an int table.
+ *
+ * @param table The game table.
+ * @param state The game state to fill.
+ */
+void
+game_state_from_table (int table[ROWS][COLS], game_state *state)
+{
+    profile_from_table(table, &state->profile);
+    update_all_rows(state);
+}
+
+/**
+ * @brief Builds a game state from a profile.
+ *
+ * @param profile The row lengths of the position.
+ * @param state The game state to fill.
+ */
+void
+game_state_from_profile (const chomp_profile *profile, game_state *state)
+{
+    state->profile = *profile;
+    update_all_rows(state);
+}
+
+/**
+ * @brief Finds the rows whose legal moves a move changes.
+ *
+ * A cell above the cut rows can only become legal if its quadrant lost
+ * cells, which needs every row between them to be longer than its column:
+ * more than num_max_to_delete rows above the move, the quadrant is still too
+ * big. Rows below the cut are not affected at all.
+ *
+ * @param state The game state.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @param first_row Where to store the first row to update.
+ * @param last_row Where to store the last row cut by the move.
+ */
+static void
+move_rows (const game_state *state, int row, int col, int *first_row, int *last_row)
+{
+    *last_row = row;
+    while (*last_row + 1 < board_rows && state->profile.row_len[*last_row + 1] > col) {
+        (*last_row)++;
+    }
+    *first_row = row - num_max_to_delete;
+    if (*first_row < 0) {
+        *first_row = 0;
+    }
+}
+
+/**
+ * @brief Applies a move to the rows it changes.
+ *
+ * @param state The game state.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @param first_row The first row to update.
+ * @param last_row The last row cut by the move.
+ */
+static void
+apply_move_rows (game_state *state, int row, int col, int first_row, int last_row)
+{
+    for (int i = first_row; i <= last_row; i++) {
+        state->num_legal_moves -= state->profile.row_len[i] - state->first_legal[i]; // Forget the old legal moves
+    }
+    profile_delete_cells(&state->profile, row, col);
+    for (int i = last_row; i >= first_row; i--) {
+        update_row(state, i);
+    }
+}
+
+/**
+ * @brief Applies a move and updates the legal moves.
+ *
+ * Only the rows cut by the move and the num_max_to_delete rows above them
+ * are updated, see move_rows().
+ *
+ * @param state The game state.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ */
+void
+game_state_apply_move (game_state *state, int row, int col)
+{
+    int first_row, last_row;
+    move_rows(state, row, col, &first_row, &last_row);
+    apply_move_rows(state, row, col, first_row, last_row);
+}
+
+/**
+ * @brief Creates an empty undo stack.
+ *
+ * A legal move cuts at most num_max_to_delete rows and updates at most
+ * num_max_to_delete more above them, and never more than board_rows each.
+ *
+ * @param undo The undo stack to initialize.
+ * @param max_moves The number of moves the stack can hold.
+ * @return true if the stack could be allocated, false otherwise.
+ */
+bool
+game_state_undo_init (game_state_undo *undo, int max_moves)
+{
+    int num_cut = (num_max_to_delete < board_rows) ? num_max_to_delete : board_rows;
+    int num_updated = (num_cut + num_max_to_delete < board_rows) ? num_cut + num_max_to_delete : board_rows;
+    undo->moves = malloc((size_t) max_moves * sizeof(game_state_move));
+    undo->saved = malloc((size_t) max_moves * (num_cut + num_updated));
+    undo->num_moves = 0;
+    undo->num_saved = 0;
+    undo->max_moves = max_moves;
+    if (undo->moves == NULL || undo->saved == NULL) {
+        game_state_undo_free(undo);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Frees the memory of an undo stack.
+ *
+ * @param undo The undo stack.
+ */
+void
+game_state_undo_free (game_state_undo *undo)
+{
+    free(undo->moves);
+    free(undo->saved);
+    undo->moves = NULL;
+    undo->saved = NULL;
+    undo->max_moves = 0;
+}
+
+/**
+ * @brief Plays a legal move and records how to undo it.
+ *
+ * @param state The game state.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @param undo The undo stack, not full.
+ */
+void
+game_state_make_move (game_state *state, int row, int col, game_state_undo *undo)
+{
+    int first_row, last_row;
+    move_rows(state, row, col, &first_row, &last_row);
+
+    game_state_move *move = &undo->moves[undo->num_moves++];
+    move->num_legal_moves = state->num_legal_moves;
+    move->row = (unsigned char) row;
+    move->first_row = (unsigned char) first_row;
+    move->last_row = (unsigned char) last_row;
+    unsigned char *saved = undo->saved + undo->num_saved;
+    memcpy(saved, &state->first_legal[first_row], last_row - first_row + 1);
+    memcpy(saved + last_row - first_row + 1, &state->profile.row_len[row], last_row - row + 1);
+    undo->num_saved += (last_row - first_row + 1) + (last_row - row + 1);
+
+    apply_move_rows(state, row, col, first_row, last_row);
+}
+
+/**
+ * @brief Undoes the last move played with game_state_make_move().
+ *
+ * @param state The game state.
+ * @param undo The undo stack, not empty.
+ */
+void
+game_state_unmake_move (game_state *state, game_state_undo *undo)
+{
+    const game_state_move *move = &undo->moves[--undo->num_moves];
+    int num_updated = move->last_row - move->first_row + 1;
+    int num_cut = move->last_row - move->row + 1;
+    undo->num_saved -= num_updated + num_cut;
+    const unsigned char *saved = undo->saved + undo->num_saved;
+    memcpy(&state->first_legal[move->first_row], saved, num_updated);
+    memcpy(&state->profile.row_len[move->row], saved + num_updated, num_cut);
+    state->num_legal_moves = move->num_legal_moves;
+}
+
+/**
+ * @brief Lists the legal moves in row-major order.
+ *
+ * @param state The game state.
+ * @param possible_moves The buffer to fill with the row and column of each move.
+ * @return The number of legal moves.
+ */
+int
+game_state_legal_moves (const game_state *state, int possible_moves[][2])
+{
+    int move_index = 0;
+    for (int i = 0; i < board_rows && state->profile.row_len[i] > 0; i++) {
+        for (int j = state->first_legal[i]; j < state->profile.row_len[i]; j++) {
+            possible_moves[move_index][0] = i;
+            possible_moves[move_index][1] = j;
+            move_index++;
+        }
+    }
+    return move_index;
+}
+
+/**
+ * @brief Chooses a random move in a list of legal moves in row-major order.
+ *
+ * @param num_moves The number of legal moves, at least 1.
+ * @param poisoned_first true if the first move is the poisoned cell.
+ * @param random A random number.
+ * @return The index of the chosen move.
+ */
+int64_t
+random_legal_move_index (int64_t num_moves, bool poisoned_first, uint64_t random)
+{
+    // Skip the poisoned cell if there is another move
+    int64_t first = poisoned_first && num_moves > 1;
+    return first + (int64_t) (random % (uint64_t) (num_moves - first));
+}
@@ -12,16 +12,19 @@
 #include "chomp.h"
 #include "const.h"
 #include "gui.h"
-#include "ai.h"
 #include "network.h"
+#include "game_state.h"
+#include "ai_engine.h"
 
 
 #define LONG_STR 512
 #define COLOR_BLUE "blue"
 #define COLOR_RED "red"
 #define COLOR_YELLOW "yellow"
+#define COLOR_GREY "grey"
 
 int table[ROWS][COLS];
+game_state state; // Legal moves of the table, kept up to date for the AI
 
 char player1_name[LONG_STR] = "Player 1";
 char player2_name[LONG_STR] = "Player 2";
@@ -39,7 +42,9 @@ int player_gui = 0;  // 1 for client, 2 for server, 3 for client ai, 4 for serve
 bool is_ai_local = false;
 bool is_ai_network = false;
 bool is_network = false;
+gboolean board_sensitive = TRUE; // Whether the local player may click the board
 void set_board_sensitive(gboolean sensitive);
+void update_legal_cells();
 void receive_opponent_move();
 gboolean update_opponent_move_gui(gpointer data);
 int start_gui_game(int argc, char *argv[], bool network, bool ai,int player_num);
@@ -202,17 +207,19 @@ restart_game (GtkWidget *widget, gpointer data)
     (void)data;
 
     init_table(table);
+    game_state_init(&state);
     last_clicked_button = NULL;
     turn_number = 0;
 
     // Reset the button styles and make them sensitive again
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
+    for (int i = 0; i < board_rows; i++) {
+        for (int j = 0; j < board_cols; j++) {
             // Reset button styles here
             update_button_style(i, j, COLOR_BLUE);
             gtk_widget_set_sensitive(buttons[i][j].btn, TRUE);
         }
     }
+    set_board_sensitive(TRUE);
 
     // Set the turn label to player 1's name
     gtk_label_set_text(GTK_LABEL(turn_label), player1_name);
@@ -253,8 +260,8 @@ update_button_style (int row, int col, const char *color)
 void
 update_gui_cells (int row, int col)
 {
-    int tmp_col = COLS;
-    for (int i = row; i < ROWS; i++) {
+    int tmp_col = board_cols;
+    for (int i = row; i < board_rows; i++) {
         for (int j = col; j < tmp_col; j++) {
             if (table[i][j] == 0) {
                 update_button_style(i, j, COLOR_RED);
@@ -263,13 +270,15 @@ update_gui_cells (int row, int col)
         }
     }
     if(last_index_clicked != -1){
-        int last_row = last_index_clicked / COLS;
-        int last_col = last_index_clicked % COLS;
+        int last_row = last_index_clicked / board_cols;
+        int last_col = last_index_clicked % board_cols;
         update_button_style(last_row, last_col, COLOR_RED);
     }
-    last_index_clicked = row * COLS + col;
+    last_index_clicked = row * board_cols + col;
     update_button_style(row, col, COLOR_YELLOW);
 
+    // Grey out the cells that became illegal moves
+    update_legal_cells();
 
     // Process all pending GTK events to ensure the GUI updates immediately
     while (gtk_events_pending()) gtk_main_iteration();
@@ -285,8 +294,8 @@ void
 print_table_state ()
 {
     printf("Current table state:\n");
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
+    for (int i = 0; i < board_rows; i++) {
+        for (int j = 0; j < board_cols; j++) {
             if (j == last_col_played && i == last_row_played) { // Highlight the last played cell in terminal
                 printf("\033[1;33m%d \033[0m", table[i][j]);
             } else {
@@ -311,12 +320,13 @@ void
 on_button_clicked (GtkWidget *widget, gpointer data)
 {
     int index = GPOINTER_TO_INT(data);
-    int row = index / COLS;
-    int col = index % COLS;
+    int row = index / board_cols;
+    int col = index % board_cols;
     bool valid_move = false;
     // Check if the move is valid
-    if (calculate_num_to_delete(table, row, col) <= NUM_MAX_TO_DELETE) {
+    if (calculate_num_to_delete(table, row, col) <= num_max_to_delete) {
         delete_cells(table, row, col);
+        game_state_apply_move(&state, row, col);
         valid_move = true;
         if (row == 0 && col == 0) {
             last_move_by_local = true;
@@ -324,6 +334,11 @@ on_button_clicked (GtkWidget *widget, gpointer data)
         // Store the last played cell to add some color to the terminal
         last_col_played = col;  
         last_row_played = row;
+
+        // The opponent plays next, no click is taken until its move arrives
+        if (player_gui == 1 || player_gui == 2 || is_ai_network) {
+            set_board_sensitive(FALSE);
+        }
         
         // Update the GUI based on the updated table
         update_gui_cells(row, col);
@@ -354,17 +369,18 @@ on_button_clicked (GtkWidget *widget, gpointer data)
         }
     } else {
         // Show an error dialog if the move is invalid
-        show_error_dialog(gtk_widget_get_toplevel(widget), "Invalid move. You can delete at most 5 cells.");
+        char error_text[LONG_STR];
+        snprintf(error_text, sizeof(error_text), "Invalid move. You can delete at most %d cells.", num_max_to_delete);
+        show_error_dialog(gtk_widget_get_toplevel(widget), error_text);
     }
 
     // Send the move to the opponent if in network mode
-    int move = row * COLS + col;
+    int move = row * board_cols + col;
     if ((player_gui == 1 || player_gui==2) && valid_move){
         if (send_move(client_socket, move) == -1 ) {
             show_error_dialog(gtk_widget_get_toplevel(widget), "Failed to send move to the opponent.");
             return;
         }
-        set_board_sensitive(FALSE);
 
         // Wait for the opponent's move
         g_thread_new(NULL, (GThreadFunc)receive_opponent_move, NULL);
@@ -375,9 +391,9 @@ on_button_clicked (GtkWidget *widget, gpointer data)
             show_error_dialog(gtk_widget_get_toplevel(widget), "Failed to send move to the opponent.");
             return;
         }
-        set_board_sensitive(FALSE);
 
-        // Wait for the opponent's move
+        // Wait for the opponent's move, the AI searches its replies meanwhile
+        ai_ponder_start(&state);
         g_thread_new(NULL, (GThreadFunc)receive_opponent_move, NULL);
     }
     if (is_ai_local && (turn_number%2 == 1)) {
@@ -401,25 +417,10 @@ on_move_entered (GtkWidget *widget, gpointer data)
     (void)data;
 
     const char *move = gtk_entry_get_text(GTK_ENTRY(widget));
-    if (strlen(move) < 2 || strlen(move) > 3) {
-        show_error_dialog(gtk_widget_get_toplevel(widget), "Invalid move format. Use format like A1.");
-        return;
-    }
-
-    char col_char = move[0];
-    int row = atoi(&move[1]) - 1;
-    int col = -1;
+    int row, col;
 
-    // Translate the column character to an index
-    for (int i = 0; i < COLS; i++) {
-        if (translate[i][0] == col_char) {
-            col = i;
-            break;
-        }
-    }
-
-    // Check if the move is valid
-    if (col == -1 || row < 0 || row >= ROWS) {
+    // Translate the cell label to a row and a column
+    if (!parse_cell(move, &row, &col)) {
         show_error_dialog(gtk_widget_get_toplevel(widget), "Invalid move. Use format like A1.");
         return;
     }
@@ -429,7 +430,7 @@ on_move_entered (GtkWidget *widget, gpointer data)
         return;
     }
 
-    int index = row * COLS + col;
+    int index = row * board_cols + col;
     on_button_clicked(buttons[row][col].btn, GINT_TO_POINTER(index));
     gtk_entry_set_text(GTK_ENTRY(widget), "");
 }
@@ -533,13 +534,15 @@ gboolean
 update_opponent_move_gui (gpointer data)
 {
   int opponent_move = GPOINTER_TO_INT (data);
-  int opp_row = opponent_move / COLS;
-  int opp_col = opponent_move % COLS;
+  int opp_row = opponent_move / board_cols;
+  int opp_col = opponent_move % board_cols;
 
+    ai_ponder_stop(); // The move is known, what the AI found is kept for its reply
     if (!validate_and_apply_move (table, opponent_move)) {
         show_error_dialog (NULL, "Invalid move received from the opponent.");
         return FALSE;
     }
+    game_state_apply_move (&state, opp_row, opp_col);
 
     last_col_played = opp_col;
     last_row_played = opp_row;
@@ -574,16 +577,38 @@ update_opponent_move_gui (gpointer data)
  * 
  * This function sets the sensitivity of the game board buttons.
  * It enables or disables the buttons based on the specified sensitivity.
+ * The cells that are not legal moves are greyed out and never enabled.
  *
  * @param sensitive TRUE to enable buttons, FALSE to disable.
  */
 void
 set_board_sensitive (gboolean sensitive)
 {
-  for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
+  board_sensitive = sensitive;
+  update_legal_cells ();
+}
+
+/**
+ * @brief Recolours the cells left on the board by legality.
+ * 
+ * The legal moves are shown in blue, the cells that would delete too many
+ * cells are greyed out and disabled. Whether the board is enabled is left
+ * as set by set_board_sensitive().
+ */
+void
+update_legal_cells ()
+{
+  int counts[ROWS][COLS];
+  uint64_t legal[ROWS];
+  calculate_all_num_to_delete (table, counts, legal);
+
+  for (int i = 0; i < board_rows; i++) {
+        for (int j = 0; j < board_cols; j++) {
             if (table[i][j] == 1) {
-                gtk_widget_set_sensitive (buttons[i][j].btn, sensitive);
+                // Grey out the cells that would delete too many cells
+                gboolean is_legal = (legal[i] >> j) & 1;
+                update_button_style (i, j, is_legal ? COLOR_BLUE : COLOR_GREY);
+                gtk_widget_set_sensitive (buttons[i][j].btn, board_sensitive && is_legal);
             }
         }
     }
@@ -605,14 +630,14 @@ start_gui_server_mode (short port, bool ai)
 {
     if (!ai){
         server_socket = start_server (port);
-        client_socket = accept (server_socket, NULL, NULL);
+        client_socket = accept_client (server_socket);
         player_gui = 2;  // Server is player 2
         is_network = true;
         current_player_playing = 1;
         return start_gui_game(0, NULL, true,false, 2);
     }else{
         server_socket = start_server (port);
-        client_socket = accept (server_socket, NULL, NULL);
+        client_socket = accept_client (server_socket);
         player_gui = 4;  // Server  ai is player 4
         is_ai_network = true;
         is_network = true;
@@ -656,41 +681,20 @@ start_gui_client_mode (const char *ip, short port, bool ai)
  * @brief AI chooses its move.
  * 
  * This function implements the AI's move selection.
- * It uses pattern detection or random selection from possible moves.
+ * It plays the move chosen by the current ai engine, within a time budget
+ * when the opponent waits on the network.
  */
 void ai_choosing_its_move ()
 {
     int col_ai;
     int row_ai;
-    if (!detect_pattern(table)){
-                int (*possible_moves)[2] = calculate_possibility(table);
-                int move_index = 0;
-                
-                while (possible_moves[move_index][0] != -1 || possible_moves[move_index][1] != -1) {
-                    move_index++;
-                }
-                if (move_index > 1) {
-                    int random_index = rand() % move_index;
-                    int i = 0;
-                    while (possible_moves[random_index+i][0]==0 && possible_moves[random_index+i][1]==0){
-                        i++;
-                    }
-                    row_ai = possible_moves[random_index+i][0];
-                    col_ai = possible_moves[random_index+i][1];
-                    on_button_clicked(buttons[row_ai][col_ai].btn, GINT_TO_POINTER(row_ai*COLS + col_ai));
-
-                }else if (move_index == 1){
-                    row_ai = 0;
-                    col_ai = 0;
-                    on_button_clicked(buttons[row_ai][col_ai].btn, GINT_TO_POINTER(row_ai*COLS + col_ai));
-
-                }
-            }else{
-                int move = pattern_move(table); //TODO CHECK IF VALID MOVE
-                row_ai = move/COLS;
-                col_ai = move%COLS;
-                on_button_clicked(buttons[row_ai][col_ai].btn, GINT_TO_POINTER(move));
-            }
+    int time_budget = ai_time_budget;
+    if (is_ai_network && time_budget == AI_NO_TIME_LIMIT) {
+        time_budget = AI_NETWORK_TIME_BUDGET;
+    }
+    if (ai_engine_move(&state, time_budget, &row_ai, &col_ai)) {
+        on_button_clicked(buttons[row_ai][col_ai].btn, GINT_TO_POINTER(row_ai*board_cols + col_ai));
+    }
 }
 /**
  * @brief Starts the GUI for the Chomp game.
@@ -735,30 +739,39 @@ start_gui_game (int argc, char *argv[], bool network,bool ai, int player_num)
     gtk_container_add (GTK_CONTAINER (window), grid);
 
     init_table (table);
+    game_state_init (&state);
 
     // Create column labels
-    for (int j = 0; j < COLS; j++) {
-        GtkWidget *label = gtk_label_new (translate[j]);
+    for (int j = 0; j < board_cols; j++) {
+        char col_label[CELL_LABEL_SIZE];
+        column_label (j, col_label);
+        GtkWidget *label = gtk_label_new (col_label);
         gtk_grid_attach (GTK_GRID (grid), label, j + 1, 0, 1, 1);
     }
 
+    // Shrink the buttons on big boards so the window stays on screen
+    int button_size = 50;
+    if (board_rows > 14 || board_cols > 24) {
+        button_size = MAX (12, 700 / MAX (board_rows, board_cols));
+    }
+
     // Create row labels and buttons
-    for (int i = 0; i < ROWS; i++) {
+    for (int i = 0; i < board_rows; i++) {
         GtkWidget *label = gtk_label_new (g_strdup_printf ("%d", i + 1));
         gtk_grid_attach (GTK_GRID (grid), label, 0, i + 1, 1, 1);
 
-        for (int j = 0; j < COLS; j++) {
+        for (int j = 0; j < board_cols; j++) {
           buttons[i][j].btn = gtk_button_new ();
           buttons[i][j].bp = gtk_css_provider_new ();
 
-          gtk_widget_set_size_request (buttons[i][j].btn, 50, 50);
+          gtk_widget_set_size_request (buttons[i][j].btn, button_size, button_size);
 
           char css_class[20];
           snprintf (css_class, sizeof (css_class), "btnid_%02d_%02d", i, j);
           GtkStyleContext *context = gtk_widget_get_style_context (buttons[i][j].btn);
           gtk_style_context_add_class (context, css_class);
 
-          g_signal_connect (buttons[i][j].btn, "clicked", G_CALLBACK (on_button_clicked), GINT_TO_POINTER (i * COLS + j));
+          g_signal_connect (buttons[i][j].btn, "clicked", G_CALLBACK (on_button_clicked), GINT_TO_POINTER (i * board_cols + j));
           gtk_grid_attach (GTK_GRID (grid), buttons[i][j].btn, j + 1, i + 1, 1, 1);
         }
     }
@@ -767,20 +780,20 @@ start_gui_game (int argc, char *argv[], bool network,bool ai, int player_num)
     entry = gtk_entry_new();
     gtk_entry_set_placeholder_text(GTK_ENTRY(entry), "Enter move (e.g., A1)");
     g_signal_connect(entry, "activate", G_CALLBACK(on_move_entered), entry);
-    gtk_grid_attach(GTK_GRID(grid), entry, 0, ROWS + 1, COLS + 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), entry, 0, board_rows + 1, board_cols + 1, 1);
 
     // Create labels for turn and score
     turn_label = gtk_label_new(player1_name);
-    gtk_grid_attach(GTK_GRID(grid), turn_label, 0, ROWS + 2, COLS + 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), turn_label, 0, board_rows + 2, board_cols + 1, 1);
 
     score_label = gtk_label_new("");
-    gtk_grid_attach(GTK_GRID(grid), score_label, 0, ROWS + 3, COLS + 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), score_label, 0, board_rows + 3, board_cols + 1, 1);
 
     gtk_widget_show_all(window);
 
     // Apply CSS providers to buttons and set initial styles
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
+    for (int i = 0; i < board_rows; i++) {
+        for (int j = 0; j < board_cols; j++) {
             GtkStyleContext *context = gtk_widget_get_style_context(buttons[i][j].btn);
             gtk_style_context_add_provider(context, GTK_STYLE_PROVIDER(buttons[i][j].bp), GTK_STYLE_PROVIDER_PRIORITY_USER);
             update_button_style(i, j, COLOR_BLUE);
@@ -813,6 +826,9 @@ start_gui_game (int argc, char *argv[], bool network,bool ai, int player_num)
         }
     } else if (player_num == 2) {
         set_board_sensitive (FALSE); // Wait for opponent
+        if (ai) {
+            ai_ponder_start(&state);
+        }
         g_thread_new (NULL, (GThreadFunc) receive_opponent_move, NULL);
     } else { // Local GUI mode
         set_board_sensitive (TRUE); // Allow both players to play locally
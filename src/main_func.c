@@ -81,7 +81,7 @@ void
 start_server_mode (short port,bool ai)
 {
     server_socket = start_server (port); // Initialize server socket
-    client_socket = accept (server_socket, NULL, NULL); // Accept client connection
+    client_socket = accept_client (server_socket); // Accept client connection and check its board
     player = 2; // Set player to server
     if (!ai){
         start_terminal_network (client_socket, player); // Start terminal network for server
@@ -0,0 +1,120 @@
+/**
+ * @file make_book.c
+ * @brief Entry point of the opening book builder.
+ *
+ * This file contains the main function of the tool building an opening book
+ * offline, run by the book target of the Makefile. Every position of the
+ * first plies is searched as deep as asked and the moves found are written
+ * to the book file, which the game reads with -book.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "const.h"
+#include "chomp.h"
+#include "book.h"
+#include "deadline.h"
+
+/**
+ * @brief Prints the usage of the tool.
+ *
+ * @param name The name of the program.
+ */
+static void
+print_usage (const char *name)
+{
+    fprintf(stderr, "Usage: %s -o <file> [-size <rows>x<cols>] [-limit <n>] [-plies <n>] [-depth <n>] [-time <ms>] [-threads <n>]\n", name);
+}
+
+/**
+ * @brief Main function of the book builder.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return int Returns 0 on success, or 1 on invalid arguments or if the book could not be built.
+ */
+int
+main (int argc, char *argv[])
+{
+    const char *path = NULL;
+    int rows = DEFAULT_ROWS;
+    int cols = DEFAULT_COLS;
+    int max_to_delete = DEFAULT_NUM_MAX_TO_DELETE;
+    int plies = BOOK_DEFAULT_PLIES;
+    int max_depth = 0; // Searched until proven unless a depth or a time budget is given
+    int time_budget_ms = 0;
+    int num_threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "-o") == 0 && has_value) {
+            path = argv[++i];
+        } else if (strcmp(argv[i], "-size") == 0 && has_value) {
+            if (!parse_board_size(argv[++i], &rows, &cols)) {
+                fprintf(stderr, "Error: Invalid board size format, use <rows>x<cols>.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-limit") == 0 && has_value) {
+            if (!parse_max_to_delete(argv[++i], &max_to_delete)) {
+                fprintf(stderr, "Error: Invalid deletion limit, use a positive number.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-plies") == 0 && has_value) {
+            if (!parse_count(argv[++i], 1, &plies)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-depth") == 0 && has_value) {
+            if (!parse_count(argv[++i], 0, &max_depth)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-time") == 0 && has_value) {
+            if (!parse_count(argv[++i], 0, &time_budget_ms)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-threads") == 0 && has_value) {
+            if (!parse_count(argv[++i], 0, &num_threads)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (path == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (!set_board_config(rows, cols, max_to_delete)) {
+        fprintf(stderr, "Error: The board must be between 1x1 and %dx%d and the deletion limit at least 1.\n", ROWS, COLS);
+        return 1;
+    }
+
+    opening_book book;
+    uint64_t start = current_time_ms();
+    if (!book_build(&book, plies, max_depth, time_budget_ms, num_threads)) {
+        fprintf(stderr, "Error: Not enough memory to build the opening book.\n");
+        return 1;
+    }
+    if (!book_save(&book, path)) {
+        fprintf(stderr, "Error: Could not write the opening book %s.\n", path);
+        book_free(&book);
+        return 1;
+    }
+
+    int proven = 0;
+    for (uint32_t i = 0; i < book.num_entries; i++) {
+        proven += book.entries[i].result != 0;
+    }
+    printf("Opening book %s: %dx%d board, limit %d, %d plies, %u positions (%d proven) in %.1f s\n",
+           path, rows, cols, max_to_delete, plies, book.num_entries, proven,
+           (double) (current_time_ms() - start) / 1000.0);
+    book_free(&book);
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file make_tablebase.c
+ * @brief Entry point of the tablebase generator.
+ *
+ * This file contains the main function of the tool run by the Makefile at
+ * build time. It solves every position of the board and writes the C source
+ * file holding the table of default_tablebase.h, which is compiled into the
+ * game and the tests. It also writes the tablebase files of other boards,
+ * which the game maps with -tablebase.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "const.h"
+#include "chomp.h"
+#include "profile.h"
+#include "tablebase.h"
+#include "default_tablebase.h"
+#include "tablebase_file.h"
+#include "staircase.h"
+
+/**
+ * @brief Prints the usage of the tool.
+ *
+ * @param name The name of the program.
+ */
+static void
+print_usage (const char *name)
+{
+    fprintf(stderr, "Usage: %s [-o <source file>] [-file <tablebase file> [-compress]] [-size <rows>x<cols>] [-limit <n>]\n", name);
+}
+
+/**
+ * @brief Writes the generated source file.
+ *
+ * @param tb The solved tablebase.
+ * @param file The file.
+ * @return true if the positions are numbered by their ranks, false otherwise.
+ */
+static bool
+write_table (const tablebase *tb, FILE *file)
+{
+    fprintf(file, "/**\n * @file default_tablebase_data.c\n");
+    fprintf(file, " * @brief Tablebase of the %dx%d board with limit %d, generated by make_tablebase.\n */\n\n",
+            tb->rows, tb->cols, tb->max_to_delete);
+    fprintf(file, "#include <stdint.h>\n#include \"default_tablebase.h\"\n\n");
+    fprintf(file, "const int default_tablebase_rows = %d;\n", tb->rows);
+    fprintf(file, "const int default_tablebase_cols = %d;\n", tb->cols);
+    fprintf(file, "const int default_tablebase_max_to_delete = %d;\n", tb->max_to_delete);
+    fprintf(file, "const uint32_t default_tablebase_num_positions = %u;\n\n", tb->num_positions);
+
+    fprintf(file, "const uint8_t default_tablebase_entries[] = {");
+    chomp_profile profile;
+    memset(&profile, 0, sizeof(profile));
+    for (uint32_t number = 0; number < tb->num_positions; number++) {
+        if (staircase_rank(&profile, tb->rows) != number) {
+            return false;
+        }
+
+        int move = tb->best_move[number];
+        int cell = move == TABLEBASE_NO_MOVE ? DEFAULT_TABLEBASE_NO_MOVE : move / COLS * tb->cols + move % COLS;
+        int entry = (tb->distance[number] % 2 == 0 ? DEFAULT_TABLEBASE_WON : 0) | cell;
+        fprintf(file, "%s0x%02x,", number % 16 == 0 ? "\n    " : " ", entry);
+        staircase_next(&profile, tb->rows, tb->cols);
+    }
+    fprintf(file, "\n};\n");
+    return true;
+}
+
+/**
+ * @brief Main function of the tablebase generator.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @return int Returns 0 on success, or 1 on invalid arguments or if the table could not be written.
+ */
+int
+main (int argc, char *argv[])
+{
+    const char *path = NULL;
+    const char *file_path = NULL;
+    int compression = TABLEBASE_COMPRESSION_NONE;
+    int rows = DEFAULT_ROWS;
+    int cols = DEFAULT_COLS;
+    int max_to_delete = DEFAULT_NUM_MAX_TO_DELETE;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "-o") == 0 && has_value) {
+            path = argv[++i];
+        } else if (strcmp(argv[i], "-file") == 0 && has_value) {
+            file_path = argv[++i];
+        } else if (strcmp(argv[i], "-compress") == 0) {
+            compression = TABLEBASE_COMPRESSION_RICE;
+        } else if (strcmp(argv[i], "-size") == 0 && has_value) {
+            if (!parse_board_size(argv[++i], &rows, &cols)) {
+                fprintf(stderr, "Error: Invalid board size format, use <rows>x<cols>.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-limit") == 0 && has_value) {
+            if (!parse_max_to_delete(argv[++i], &max_to_delete)) {
+                fprintf(stderr, "Error: Invalid deletion limit, use a positive number.\n");
+                return 1;
+            }
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (path == NULL && file_path == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (!set_board_config(rows, cols, max_to_delete)) {
+        fprintf(stderr, "Error: The board must be between 1x1 and %dx%d and the deletion limit at least 1.\n", ROWS, COLS);
+        return 1;
+    }
+    if (path != NULL && rows * cols >= DEFAULT_TABLEBASE_NO_MOVE) {
+        fprintf(stderr, "Error: The cells of a %dx%d board do not fit in an entry.\n", rows, cols);
+        return 1;
+    }
+
+    tablebase tb;
+    if (!tablebase_solve(&tb)) {
+        fprintf(stderr, "Error: The %dx%d board could not be solved.\n", rows, cols);
+        return 1;
+    }
+    if (file_path != NULL && !tablebase_file_write(&tb, file_path, compression)) {
+        fprintf(stderr, "Error: Could not write the tablebase %s.\n", file_path);
+        tablebase_free(&tb);
+        return 1;
+    }
+    if (path != NULL) {
+        FILE *file = fopen(path, "w");
+        bool written = file != NULL && write_table(&tb, file);
+        if (file != NULL && fclose(file) != 0) {
+            written = false;
+        }
+        if (!written) {
+            fprintf(stderr, "Error: Could not write the tablebase %s.\n", path);
+            if (file != NULL) {
+                remove(path);
+            }
+            tablebase_free(&tb);
+            return 1;
+        }
+    }
+    printf("Tablebase %s: %dx%d board, limit %d, %u positions\n", path != NULL ? path : file_path,
+           rows, cols, max_to_delete, tb.num_positions);
+    tablebase_free(&tb);
+    return 0;
+}
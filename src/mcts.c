@@ -0,0 +1,626 @@
+/**
+ * @file mcts.c
+ * @brief Implementation of the Monte-Carlo tree search engine.
+ *
+ * This file contains the arenas and the hash index of a tree, the iterations
+ * of a tree (selection, expansion, random games and update of the path and
+ * of the proofs), the reuse of a tree from one move to the next, the split
+ * of a search over one tree per thread and the ai move built on top of them.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "mcts.h"
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+#include "bitboard.h"
+#include "playout.h"
+#include "deadline.h"
+
+int mcts_iterations = MCTS_DEFAULT_ITERATIONS;
+int mcts_threads = 0;
+
+/**
+ * @brief The engine of the ai, shared by mcts_ai_move() and mcts_ai_ponder().
+ */
+static mcts_engine ai_engine;
+
+/**
+ * @brief True once the engine of the ai is created.
+ */
+static bool ai_engine_ready = false;
+
+/**
+ * @struct mcts_job
+ * @brief The iterations run by one thread on its tree.
+ */
+typedef struct {
+    mcts_tree *tree; /**< The tree of the thread. */
+    const game_state *state; /**< The position of the root. */
+    int iterations; /**< The number of iterations. */
+    uint64_t deadline; /**< Deadline of the search, NO_DEADLINE if none. */
+    atomic_bool *stop; /**< Set by another thread to stop the search, NULL if none. */
+    uint64_t playouts; /**< The number of random games played. */
+} mcts_job;
+
+/**
+ * @brief Advances a splitmix64 generator.
+ *
+ * @param rng The state of the generator.
+ * @return A random number.
+ */
+static inline uint64_t
+next_random (uint64_t *rng)
+{
+    uint64_t x = (*rng += UINT64_C(0x9e3779b97f4a7c15));
+    x = (x ^ (x >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Builds the bitboard of a position.
+ *
+ * @param profile The position, the board must fit in a bitboard.
+ * @return The bitboard of the position.
+ */
+static bitboard
+profile_to_bitboard (const chomp_profile *profile)
+{
+    bitboard board = 0;
+    for (int i = 0; i < board_rows && profile->row_len[i] > 0; i++) {
+        board |= (~UINT64_C(0) >> (64 - profile->row_len[i])) << (i * board_cols);
+    }
+    return board;
+}
+
+/**
+ * @brief Finds a position in the hash index of a tree.
+ *
+ * @param tree The tree.
+ * @param key The hash of the position.
+ * @return The slot of the position, or the free slot where it would go.
+ */
+static uint32_t
+find_slot (const mcts_tree *tree, uint64_t key)
+{
+    uint32_t slot = (uint32_t) key & tree->index_mask;
+    while (tree->index[slot] != 0 && tree->nodes[tree->index[slot]].key != key) {
+        slot = (slot + 1) & tree->index_mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Finds a position of a tree, adding it if it is new.
+ *
+ * The empty board is lost for the player who ate the poisoned cell, it is
+ * proven as soon as it is added.
+ *
+ * @param tree The tree.
+ * @param profile The position.
+ * @return The index of the position, 0 if it is new and the arena is full.
+ */
+static uint32_t
+find_or_add_node (mcts_tree *tree, const chomp_profile *profile)
+{
+    uint64_t key = profile_hash(profile);
+    uint32_t slot = find_slot(tree, key);
+    if (tree->index[slot] != 0) {
+        return tree->index[slot];
+    }
+    if (tree->num_nodes >= tree->node_capacity) {
+        return 0;
+    }
+    uint32_t index = tree->num_nodes++;
+    tree->nodes[index] = (mcts_node) {key, 0, 0, profile->row_len[0] == 0 ? -1 : 0, 0, 0};
+    tree->index[slot] = index;
+    return index;
+}
+
+/**
+ * @brief Empties a tree and sets its root.
+ *
+ * @param tree The tree.
+ * @param profile The position of the root.
+ */
+static void
+tree_reset (mcts_tree *tree, const chomp_profile *profile)
+{
+    memset(tree->index, 0, ((size_t) tree->index_mask + 1) * sizeof(uint32_t));
+    tree->num_nodes = 1;
+    tree->num_edges = 1;
+    tree->root = find_or_add_node(tree, profile);
+}
+
+/**
+ * @brief Keeps only the positions reachable from a new root.
+ *
+ * The reachable positions and their moves are copied to new arenas, breadth
+ * first, and the old arenas are freed. If the new arenas cannot be
+ * allocated, the tree is emptied instead.
+ *
+ * @param tree The tree.
+ * @param root The index of the new root.
+ * @param profile The position of the new root.
+ */
+static void
+tree_reroot (mcts_tree *tree, uint32_t root, const chomp_profile *profile)
+{
+    mcts_tree copy = *tree;
+    copy.nodes = malloc(tree->node_capacity * sizeof(mcts_node));
+    copy.edges = malloc(tree->edge_capacity * sizeof(mcts_edge));
+    copy.index = calloc((size_t) tree->index_mask + 1, sizeof(uint32_t));
+    if (copy.nodes == NULL || copy.edges == NULL || copy.index == NULL) {
+        free(copy.nodes);
+        free(copy.edges);
+        free(copy.index);
+        tree_reset(tree, profile);
+        return;
+    }
+
+    // The copied positions are the queue, their moves point to the old arenas until they are processed
+    copy.nodes[0] = tree->nodes[0];
+    copy.nodes[1] = tree->nodes[root];
+    copy.index[find_slot(&copy, copy.nodes[1].key)] = 1;
+    copy.num_nodes = 2;
+    copy.num_edges = 1;
+    copy.root = 1;
+    for (uint32_t i = 1; i < copy.num_nodes; i++) {
+        mcts_node *node = &copy.nodes[i];
+        if (node->first_edge == 0) {
+            continue;
+        }
+        const mcts_edge *old_edges = &tree->edges[node->first_edge];
+        node->first_edge = copy.num_edges;
+        for (int e = 0; e < node->num_edges; e++) {
+            mcts_edge edge = old_edges[e];
+            if (edge.child != 0) {
+                const mcts_node *child = &tree->nodes[edge.child];
+                uint32_t slot = find_slot(&copy, child->key);
+                if (copy.index[slot] == 0) {
+                    copy.index[slot] = copy.num_nodes;
+                    copy.nodes[copy.num_nodes++] = *child;
+                }
+                edge.child = copy.index[slot];
+            }
+            copy.edges[copy.num_edges++] = edge;
+        }
+    }
+
+    free(tree->nodes);
+    free(tree->edges);
+    free(tree->index);
+    *tree = copy;
+}
+
+/**
+ * @brief Adds the moves of a position.
+ *
+ * @param tree The tree.
+ * @param index The index of the position.
+ * @param state The position.
+ * @return true if the position was expanded, false if the move arena is full.
+ */
+static bool
+expand_node (mcts_tree *tree, uint32_t index, const game_state *state)
+{
+    if (tree->num_edges + (uint32_t) state->num_legal_moves > tree->edge_capacity) {
+        return false;
+    }
+    mcts_edge *edges = &tree->edges[tree->num_edges];
+    int num_edges = 0;
+    for (int i = 0; i < board_rows; i++) {
+        for (int j = state->first_legal[i]; j < state->profile.row_len[i]; j++) {
+            edges[num_edges++] = (mcts_edge) {(int16_t) (i * COLS + j), 0};
+        }
+    }
+    tree->nodes[index].first_edge = tree->num_edges;
+    tree->nodes[index].num_edges = (uint16_t) num_edges;
+    tree->num_edges += num_edges;
+    return true;
+}
+
+/**
+ * @brief Selects the move of a position with the best UCT value.
+ *
+ * A proven win is always selected and a proven loss never, unless every
+ * move is one. Otherwise a move never played is selected first.
+ *
+ * @param tree The tree.
+ * @param index The index of the position.
+ * @return The index of the move.
+ */
+static uint32_t
+select_edge (const mcts_tree *tree, uint32_t index)
+{
+    const mcts_node *parent = &tree->nodes[index];
+    double log_visits = log((double) parent->visits + 1.0);
+    uint32_t unvisited = 0;
+    uint32_t best = 0;
+    double best_value = -1.0;
+    for (uint32_t e = parent->first_edge; e < parent->first_edge + parent->num_edges; e++) {
+        const mcts_node *child = &tree->nodes[tree->edges[e].child]; // The unused node 0 for a move never played
+        if (child->proven > 0) {
+            return e;
+        } else if (child->visits == 0) {
+            if (unvisited == 0) {
+                unvisited = e;
+            }
+        } else if (child->proven == 0) {
+            double value = (double) child->wins / child->visits + MCTS_EXPLORATION * sqrt(log_visits / child->visits);
+            if (value > best_value) {
+                best_value = value;
+                best = e;
+            }
+        }
+    }
+    if (unvisited != 0) {
+        return unvisited;
+    }
+    return best != 0 ? best : parent->first_edge; // Every move is a proven loss
+}
+
+/**
+ * @brief Updates the proof of a position after one of its moves was proven.
+ *
+ * @param tree The tree.
+ * @param index The index of the position.
+ * @param child The index of the position reached by the move.
+ * @return true if the position is proven too.
+ */
+static bool
+update_proof (mcts_tree *tree, uint32_t index, uint32_t child)
+{
+    mcts_node *node = &tree->nodes[index];
+    if (node->proven != 0) {
+        return true;
+    }
+    if (tree->nodes[child].proven > 0) {
+        node->proven = -1; // The player to move has a winning move
+        return true;
+    }
+    for (uint32_t e = node->first_edge; e < node->first_edge + node->num_edges; e++) {
+        uint32_t next = tree->edges[e].child;
+        if (next == 0 || tree->nodes[next].proven >= 0) {
+            return false;
+        }
+    }
+    node->proven = 1; // Every move of the player to move loses
+    return true;
+}
+
+/**
+ * @brief Runs one iteration on a tree.
+ *
+ * @param tree The tree.
+ * @param root_state The position of the root.
+ * @return The number of random games played.
+ */
+static int
+mcts_iterate (mcts_tree *tree, const game_state *root_state)
+{
+    uint32_t path[ROWS * COLS + 1];
+    int path_len = 0;
+    game_state state = *root_state;
+    uint32_t index = tree->root;
+    path[path_len++] = index;
+
+    // Walk down the tree, a leaf is expanded from its second visit on
+    while (tree->nodes[index].proven == 0) {
+        if (tree->nodes[index].first_edge == 0) {
+            if ((tree->nodes[index].visits == 0 && index != tree->root) || !expand_node(tree, index, &state)) {
+                break;
+            }
+        }
+        mcts_edge *edge = &tree->edges[select_edge(tree, index)];
+        game_state next = state;
+        game_state_apply_move(&next, edge->move / COLS, edge->move % COLS);
+        if (edge->child == 0) {
+            edge->child = find_or_add_node(tree, &next.profile);
+            if (edge->child == 0) {
+                break; // The arena is full, the games start from here
+            }
+        }
+        state = next;
+        index = edge->child;
+        path[path_len++] = index;
+    }
+
+    // Random games from the leaf, none is needed once its result is proven
+    int num_games;
+    int wins = 0;
+    if (tree->nodes[index].proven != 0) {
+        num_games = 1;
+        wins = tree->nodes[index].proven > 0;
+    } else if (bitboard_fits()) {
+        bitboard boards[PLAYOUT_LANES];
+        bool results[PLAYOUT_LANES];
+        bitboard board = profile_to_bitboard(&state.profile);
+        for (int lane = 0; lane < PLAYOUT_LANES; lane++) {
+            boards[lane] = board;
+        }
+        playout_batch(boards, PLAYOUT_LANES, next_random(&tree->rng), results);
+        num_games = PLAYOUT_LANES;
+        for (int lane = 0; lane < PLAYOUT_LANES; lane++) {
+            wins += !results[lane]; // Won by the player to move, so lost by the player not to move
+        }
+    } else {
+        num_games = 1;
+        wins = !playout_state(&state, &tree->rng);
+    }
+
+    // Each position counts the wins of the player not to move, which alternates along the path
+    bool proven = tree->nodes[index].proven != 0;
+    for (int k = path_len - 1; k >= 0; k--) {
+        tree->nodes[path[k]].visits += num_games;
+        tree->nodes[path[k]].wins += wins;
+        wins = num_games - wins;
+        if (proven && k > 0) {
+            proven = update_proof(tree, path[k - 1], path[k]);
+        }
+    }
+    return num_games;
+}
+
+/**
+ * @brief Runs the iterations of a thread.
+ *
+ * @param arg The job.
+ * @return NULL
+ */
+static void *
+mcts_worker (void *arg)
+{
+    mcts_job *job = arg;
+    mcts_tree *tree = job->tree;
+    job->playouts = 0;
+    for (int i = 0; i < job->iterations && tree->nodes[tree->root].proven == 0; i++) {
+        if (i > 0 && (deadline_passed(job->deadline) || (job->stop != NULL && atomic_load_explicit(job->stop, memory_order_relaxed)))) {
+            break; // A random game costs much more than reading the clock, which is read every time
+        }
+        job->playouts += mcts_iterate(tree, job->state);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Creates a Monte-Carlo engine.
+ *
+ * @param engine The engine to initialize.
+ * @param num_nodes The number of positions of the arena of each thread.
+ * @param num_threads The number of threads of a search, 0 for one per processor.
+ * @param seed The seed of the random games.
+ * @return true if the arenas could be allocated, false otherwise.
+ */
+bool
+mcts_engine_init (mcts_engine *engine, uint32_t num_nodes, int num_threads, uint64_t seed)
+{
+    memset(engine, 0, sizeof(*engine));
+    if (num_threads <= 0) {
+        long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = num_cpus > 0 ? (int) num_cpus : 1;
+    }
+    if (num_threads > MCTS_MAX_THREADS) {
+        num_threads = MCTS_MAX_THREADS;
+    }
+    if (num_nodes < 2) {
+        num_nodes = 2; // Room for the unused position and the root
+    }
+    uint32_t num_edges = num_nodes * MCTS_EDGES_PER_NODE;
+    if (num_edges < ROWS * COLS + 1) {
+        num_edges = ROWS * COLS + 1; // Room for the moves of the root
+    }
+    uint32_t num_slots = 1;
+    while (num_slots < 2 * num_nodes) {
+        num_slots *= 2; // The index is at most half full
+    }
+
+    engine->trees = calloc(num_threads, sizeof(mcts_tree));
+    if (engine->trees == NULL) {
+        return false;
+    }
+    engine->num_threads = num_threads;
+    for (int t = 0; t < num_threads; t++) {
+        mcts_tree *tree = &engine->trees[t];
+        tree->nodes = malloc(num_nodes * sizeof(mcts_node));
+        tree->edges = malloc(num_edges * sizeof(mcts_edge));
+        tree->index = calloc(num_slots, sizeof(uint32_t));
+        if (tree->nodes == NULL || tree->edges == NULL || tree->index == NULL) {
+            mcts_engine_free(engine);
+            return false;
+        }
+        memset(&tree->nodes[0], 0, sizeof(mcts_node));
+        tree->node_capacity = num_nodes;
+        tree->edge_capacity = num_edges;
+        tree->index_mask = num_slots - 1;
+        tree->rng = seed + (uint64_t) t * UINT64_C(0xd1b54a32d192ed03);
+    }
+    return true;
+}
+
+/**
+ * @brief Frees the arenas of a Monte-Carlo engine.
+ *
+ * @param engine The engine.
+ */
+void
+mcts_engine_free (mcts_engine *engine)
+{
+    for (int t = 0; engine->trees != NULL && t < engine->num_threads; t++) {
+        free(engine->trees[t].nodes);
+        free(engine->trees[t].edges);
+        free(engine->trees[t].index);
+    }
+    free(engine->trees);
+    engine->trees = NULL;
+    engine->num_threads = 0;
+}
+
+/**
+ * @brief Searches the best move of a position.
+ *
+ * If the position is already in the trees, what is reachable from it is
+ * kept and the iterations are added to it. With a time budget, the threads
+ * stop at the deadline even if their iterations are not all done, and so
+ * they do when the stop flag of the engine is set.
+ *
+ * @param engine The engine.
+ * @param state The position.
+ * @param iterations The number of iterations of each thread.
+ * @param time_budget_ms The time the search may take, in milliseconds, 0 for no limit.
+ * @return The chosen move.
+ */
+mcts_result
+mcts_best_move (mcts_engine *engine, const game_state *state, int iterations, int time_budget_ms)
+{
+    uint64_t deadline = deadline_from_budget(time_budget_ms);
+    mcts_result result = {-1, -1, 0, 0.0, 0};
+    bool same_config = engine->rows == board_rows && engine->cols == board_cols && engine->max_to_delete == num_max_to_delete;
+    engine->rows = board_rows;
+    engine->cols = board_cols;
+    engine->max_to_delete = num_max_to_delete;
+    engine->playouts = 0;
+    if (engine->num_threads == 0 || state->profile.row_len[0] == 0) {
+        return result;
+    }
+
+    for (int t = 0; t < engine->num_threads; t++) {
+        mcts_tree *tree = &engine->trees[t];
+        uint32_t root = 0;
+        if (same_config && tree->root != 0) {
+            root = tree->index[find_slot(tree, profile_hash(&state->profile))];
+        }
+        if (root == 0) {
+            tree_reset(tree, &state->profile);
+        } else if (root != tree->root) {
+            tree_reroot(tree, root, &state->profile);
+        }
+    }
+
+    mcts_job jobs[MCTS_MAX_THREADS];
+    pthread_t threads[MCTS_MAX_THREADS];
+    bool started[MCTS_MAX_THREADS] = {false};
+    for (int t = 0; t < engine->num_threads; t++) {
+        jobs[t] = (mcts_job) {&engine->trees[t], state, iterations, deadline, engine->stop, 0};
+    }
+    for (int t = 1; t < engine->num_threads; t++) {
+        started[t] = pthread_create(&threads[t], NULL, mcts_worker, &jobs[t]) == 0;
+    }
+    mcts_worker(&jobs[0]);
+    for (int t = 1; t < engine->num_threads; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            mcts_worker(&jobs[t]); // The thread could not be created, its iterations run here
+        }
+    }
+
+    // Every tree lists the root moves in the same order, so their visits can be added up
+    uint32_t visits[ROWS * COLS] = {0};
+    uint64_t wins[ROWS * COLS] = {0};
+    int proven[ROWS * COLS] = {0};
+    const mcts_tree *first = &engine->trees[0];
+    const mcts_node *first_root = &first->nodes[first->root];
+    int num_moves = first_root->num_edges;
+    for (int t = 0; t < engine->num_threads; t++) {
+        const mcts_tree *tree = &engine->trees[t];
+        const mcts_node *root = &tree->nodes[tree->root];
+        engine->playouts += jobs[t].playouts;
+        for (int e = 0; e < root->num_edges && e < num_moves; e++) {
+            const mcts_node *child = &tree->nodes[tree->edges[root->first_edge + e].child];
+            visits[e] += child->visits;
+            wins[e] += child->wins;
+            if (child->proven != 0) {
+                proven[e] = child->proven; // Proofs never contradict each other
+            }
+        }
+    }
+
+    // A proven win first, then the most visited move, proven losses last
+    int best = -1;
+    for (int e = 0; e < num_moves; e++) {
+        if (best < 0 || proven[e] > proven[best] || (proven[e] == proven[best] && visits[e] > visits[best])) {
+            best = e;
+        }
+    }
+    if (best < 0 || (visits[best] == 0 && proven[best] == 0)) {
+        int last_row = 0;
+        while (last_row + 1 < board_rows && state->profile.row_len[last_row + 1] > 0) {
+            last_row++;
+        }
+        result.row = last_row; // No iteration was run, eat the last cell of the last row
+        result.col = state->profile.row_len[last_row] - 1;
+        return result;
+    }
+    int move = first->edges[first_root->first_edge + best].move;
+    result.row = move / COLS;
+    result.col = move % COLS;
+    result.visits = visits[best];
+    result.win_rate = visits[best] > 0 ? (double) wins[best] / visits[best] : 0.0;
+    result.proven = proven[best];
+    return result;
+}
+
+/**
+ * @brief Chooses the move of the ai with the Monte-Carlo engine.
+ *
+ * The engine is created on the first call and kept for the whole game, so
+ * the tree grown for a move is reused for the next one. It runs
+ * mcts_iterations iterations on mcts_threads threads.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the search may take, in milliseconds, 0 for no limit.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over or the engine could not be created.
+ */
+bool
+mcts_ai_move (const game_state *state, int time_budget_ms, int *row, int *col)
+{
+    if (!ai_engine_ready) {
+        if (!mcts_engine_init(&ai_engine, MCTS_DEFAULT_NODES, mcts_threads, (uint64_t) rand())) {
+            return false;
+        }
+        ai_engine_ready = true;
+    }
+
+    mcts_result result = mcts_best_move(&ai_engine, state, mcts_iterations, time_budget_ms);
+    if (result.row < 0) {
+        return false;
+    }
+    *row = result.row;
+    *col = result.col;
+    return true;
+}
+
+/**
+ * @brief Grows the trees of the ai from a position of the opponent while it waits.
+ *
+ * The engine of mcts_ai_move() runs mcts_iterations iterations or until stop
+ * is set. The tree is reused from the position the opponent moves to, so the
+ * most likely replies already have their statistics.
+ *
+ * @param state The position, the opponent to move.
+ * @param stop Set by another thread to stop the search.
+ * @return true if the position was searched, false if the game is over or the engine could not be created.
+ */
+bool
+mcts_ai_ponder (const game_state *state, atomic_bool *stop)
+{
+    if (!ai_engine_ready) {
+        if (!mcts_engine_init(&ai_engine, MCTS_DEFAULT_NODES, mcts_threads, (uint64_t) rand())) {
+            return false;
+        }
+        ai_engine_ready = true;
+    }
+
+    ai_engine.stop = stop;
+    mcts_result result = mcts_best_move(&ai_engine, state, mcts_iterations, 0);
+    ai_engine.stop = NULL;
+    return result.row >= 0;
+}
@@ -99,15 +99,104 @@ start_client (const char *ip, short port)
     }
 
     printf ("Connected to server %s:%d\n", ip, port);
+    if (!exchange_board_config (client_socket)) {
+        close (client_socket);
+        client_socket = -1;
+        exit (EXIT_FAILURE);
+    }
     return client_socket;
 }
 
+/**
+ * @brief Accepts the connection of a client on the server socket.
+ *
+ * This function waits for a client, then checks that it plays on the same
+ * board as the server.
+ *
+ * @param server_socket The server socket file descriptor.
+ * @return The client socket file descriptor.
+ */
+int
+accept_client (int server_socket)
+{
+    int accepted_socket = accept (server_socket, NULL, NULL);
+    if (accepted_socket < 0) {
+        perror ("Accept failed");
+        exit (EXIT_FAILURE);
+    }
+    if (!exchange_board_config (accepted_socket)) {
+        close (accepted_socket);
+        exit (EXIT_FAILURE);
+    }
+    return accepted_socket;
+}
+
+/**
+ * @brief Checks that both players use the same board configuration.
+ *
+ * Each side sends its rows, columns and deletion limit in a message of
+ * NETWORK_CONFIG_MESSAGE_SIZE bytes, then reads the message of the other
+ * side. The size of the move messages depends on the board, so no move is
+ * exchanged before both sides agree on it.
+ *
+ * @param socket The socket file descriptor.
+ * @return true if the other side uses the same configuration, false otherwise.
+ */
+bool
+exchange_board_config (int socket)
+{
+    char config_str[NETWORK_CONFIG_MESSAGE_SIZE] = {0};
+    snprintf (config_str, sizeof (config_str), "CHOMP %d %d %d", board_rows, board_cols, num_max_to_delete);
+    if (send (socket, config_str, sizeof (config_str), 0) < 0) {
+        perror ("Send board configuration failed");
+        return false;
+    }
+
+    memset (config_str, 0, sizeof (config_str));
+    ssize_t bytes_received = recv (socket, config_str, sizeof (config_str), MSG_WAITALL);
+    if (bytes_received != (ssize_t) sizeof (config_str)) {
+        printf ("The opponent did not send its board configuration.\n");
+        return false;
+    }
+    config_str[NETWORK_CONFIG_MESSAGE_SIZE - 1] = '\0';
+
+    int rows, cols, max_to_delete;
+    if (sscanf (config_str, "CHOMP %d %d %d", &rows, &cols, &max_to_delete) != 3) {
+        printf ("Invalid board configuration received.\n");
+        return false;
+    }
+    if (rows != board_rows || cols != board_cols || max_to_delete != num_max_to_delete) {
+        printf ("The opponent plays on a %dx%d board with limit %d, not on a %dx%d board with limit %d.\n",
+                rows, cols, max_to_delete, board_rows, board_cols, num_max_to_delete);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Calculates the size of a move message.
+ *
+ * A move is sent as its cell label followed by a null terminator, padded to
+ * the length of the longest label of the board. Both players checked that
+ * they use the same board when they connected, so they agree on the size,
+ * and the default board keeps its 3-byte messages.
+ *
+ * @return The size of a move message in bytes.
+ */
+static size_t
+move_message_size (void)
+{
+    char last_cell[CELL_LABEL_SIZE];
+    format_cell(board_rows - 1, board_cols - 1, last_cell);
+    return strlen(last_cell) + 1;
+}
+
 /**
  * @brief Gets the move from the user.
  *
- * This function prompts the user to enter a move in the format of a letter
- * followed by a digit (e.g., I7). It validates the input and converts it
- * to the corresponding move index.
+ * This function prompts the user to enter a move as a column label followed
+ * by a row number (e.g., I7). It validates the input and converts it to the
+ * corresponding move index.
  *
  * @return The move entered by the user, or -1 if the input is invalid.
  */
@@ -116,8 +205,10 @@ get_move (void)
 {
     char input[MAX_INPUT_SIZE]; /* Use defined constant for buffer size */
     int row, col;
+    char last_cell[CELL_LABEL_SIZE];
+    format_cell(board_rows - 1, board_cols - 1, last_cell);
 
-    printf ("Enter your move (e.g., I7): ");
+    printf ("Enter your move (e.g., %s): ", last_cell);
     if (fgets (input, sizeof (input), stdin) != NULL) {
         size_t len = strlen (input);
         if (len > 0 && input[len - 1] != '\n') {
@@ -129,22 +220,13 @@ get_move (void)
             input[strcspn (input, "\n")] = '\0';
         }
 
-        // Validate input format
-        if (strlen (input) < 2 || !isalpha (input[0]) || !isdigit (input[1])) {
-            printf ("Invalid input format. Please enter a letter followed by a digit (e.g., I7).\n");
-            return -1;
-        }
-
-        col = toupper (input[0]) - 'A'; // Convert letter to column index
-        row = input[1] - '1'; // Convert digit to row index
-
-        // Check if move is within board range
-        if (col < 0 || col >= COLS || row < 0 || row >= ROWS) {
-            printf ("Invalid move. Please enter a valid move within the board range.\n");
+        // Validate input format and board range
+        if (!parse_cell (input, &row, &col)) {
+            printf ("Invalid move. Please enter a cell between A1 and %s.\n", last_cell);
             return -1;
         }
 
-        return row * COLS + col; // Return move as a single index
+        return row * board_cols + col; // Return move as a single index
     } else {
         printf ("Error reading input.\n");
         return -1;
@@ -163,12 +245,10 @@ get_move (void)
 int
 send_move (int socket, int move)
 {
-    char move_str[3];
-    move_str[0] = 'A' + (move % COLS); // Convert column index to letter
-    move_str[1] = '1' + (move / COLS); // Convert row index to digit
-    move_str[2] = '\0';
+    char move_str[CELL_LABEL_SIZE] = {0};
+    format_cell(move / board_cols, move % board_cols, move_str); // Convert the move to its cell label
     printf("%s will be sent\n",move_str);
-    if (send(socket, move_str, sizeof(move_str), 0) < 0) {
+    if (send(socket, move_str, move_message_size(), 0) < 0) {
         perror("Send move failed");
         return -1;
     }
@@ -186,8 +266,8 @@ send_move (int socket, int move)
 int
 receive_move (int socket)
 {
-    char move_str[3];
-    ssize_t bytes_received = recv(socket, move_str, sizeof(move_str), 0);
+    char move_str[CELL_LABEL_SIZE] = {0};
+    ssize_t bytes_received = recv(socket, move_str, move_message_size(), MSG_WAITALL);
     if (bytes_received < 0) {
         perror("Receive move failed");
         return -1;
@@ -195,22 +275,16 @@ receive_move (int socket)
         printf("Client disconnected.\n");
         return -1;
     }
+    move_str[CELL_LABEL_SIZE - 1] = '\0';
 
-    // Validate received move format
-    if (strlen(move_str) < 2 || !isalpha(move_str[0]) || !isdigit(move_str[1])) {
-        printf("Invalid move format received.\n");
-        return -1;
-    }
-    int col = toupper(move_str[0]) - 'A'; // Convert letter to column index
-    int row = move_str[1] - '1'; // Convert digit to row index
-
-    // Check if move is within board range
-    if (col < 0 || col >= COLS || row < 0 || row >= ROWS) {
-        printf("Invalid move received: out of bounds.\n");
+    // Validate received move format and board range
+    int row, col;
+    if (!parse_cell(move_str, &row, &col)) {
+        printf("Invalid move received.\n");
         return -1;
     }
 
-    return row * COLS + col; // Return move as a single index
+    return row * board_cols + col; // Return move as a single index
 }
 
 /**
@@ -230,9 +304,9 @@ validate_and_apply_move (int table[ROWS][COLS], int move)
         return false;
     }
 
-    int row = move / COLS;
-    int col = move % COLS;
-    if (row < 0 || row >= ROWS || col < 0 || col >= COLS) {
+    int row = move / board_cols;
+    int col = move % board_cols;
+    if (row < 0 || row >= board_rows || col < 0 || col >= board_cols) {
         printf ("Invalid move: out of bounds.\n");
         return false;
     }
@@ -248,7 +322,7 @@ validate_and_apply_move (int table[ROWS][COLS], int move)
         return false;
     }
 
-    if (num_to_delete > NUM_MAX_TO_DELETE) {
+    if (num_to_delete > num_max_to_delete) {
         printf ("Invalid move: exceeds maximum number of cells to delete.\n");
         return false;
     }
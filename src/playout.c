@@ -0,0 +1,343 @@
+/**
+ * @file playout.c
+ * @brief Implementation of the random playouts.
+ *
+ * This file contains the lock-step batch kernel and its scalar references.
+ * In the kernel, the deletion count of every cell of every lane is computed
+ * at once with bit-sliced counters: on a staircase, a quadrant of at most
+ * num_max_to_delete + 1 cells only holds cells at an offset (dr, dc) with
+ * (dr + 1) * (dc + 1) <= num_max_to_delete + 1, so adding the board shifted
+ * by each of those few offsets is enough to tell the legal moves apart.
+ */
+
+#include "playout.h"
+#include "const.h"
+#include "bitboard.h"
+#include "game_state.h"
+
+/**
+ * @brief Derives the random number generator state of a playout.
+ *
+ * @param seed The seed of the batch.
+ * @param index The index of the playout in the batch.
+ * @return A non-zero generator state.
+ */
+static inline uint64_t
+playout_seed (uint64_t seed, int index)
+{
+    uint64_t x = seed + (uint64_t) (index + 1) * UINT64_C(0x9e3779b97f4a7c15); // splitmix64
+    x = (x ^ (x >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return (x ^ (x >> 31)) | 1;
+}
+
+/**
+ * @brief Advances a xorshift64 generator.
+ *
+ * @param rng The state of the generator.
+ * @return The new state, used as the random number.
+ */
+static inline uint64_t
+next_random (uint64_t *rng)
+{
+    uint64_t x = *rng;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *rng = x;
+    return x;
+}
+
+/**
+ * @brief Plays one random game from a board, one move at a time.
+ *
+ * @param board The starting position.
+ * @param rng The state of the random number generator, updated.
+ * @return true if the player to move won.
+ */
+bool
+playout_scalar (bitboard board, uint64_t *rng)
+{
+    int num_moves = 0;
+    while (board & 1) {
+        bitboard legal = bitboard_legal_moves(board);
+        uint64_t choice = ((next_random(rng) >> 32) * (uint64_t) __builtin_popcountll(legal)) >> 32;
+        while (choice-- > 0) {
+            legal &= legal - 1; // Skip the lower moves
+        }
+        int index = __builtin_ctzll(legal);
+        board &= ~bitboard_quadrant_masks[index];
+        num_moves++;
+    }
+    return num_moves % 2 == 0; // The player who ate the poisoned cell lost
+}
+
+/**
+ * @brief Plays one random game from a game state.
+ *
+ * @param state The starting position, left unchanged.
+ * @param rng The state of the random number generator, updated.
+ * @return true if the player to move won.
+ */
+bool
+playout_state (const game_state *state, uint64_t *rng)
+{
+    int possible_moves[ROWS * COLS][2];
+    game_state current = *state;
+    int num_moves = 0;
+    while (current.profile.row_len[0] > 0) {
+        int count = game_state_legal_moves(&current, possible_moves);
+        uint64_t choice = ((next_random(rng) >> 32) * (uint64_t) count) >> 32;
+        game_state_apply_move(&current, possible_moves[choice][0], possible_moves[choice][1]);
+        num_moves++;
+    }
+    return num_moves % 2 == 0;
+}
+
+#if defined(__GNUC__)
+
+// The vector helpers are static, their calling convention never crosses this file
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+/**
+ * @typedef lanes
+ * @brief One 64-bit value per game of the batch.
+ */
+typedef uint64_t lanes __attribute__((vector_size(8 * PLAYOUT_LANES)));
+
+/**
+ * @typedef signed_lanes
+ * @brief Signed view of the lanes, for comparisons.
+ */
+typedef int64_t signed_lanes __attribute__((vector_size(8 * PLAYOUT_LANES)));
+
+/**
+ * @struct playout_offsets
+ * @brief Shifts adding up the quadrant of every cell, for the current board.
+ */
+typedef struct {
+    int num_offsets; /**< Number of offsets. */
+    int shift[64]; /**< Bit distance of each offset. */
+    bitboard keep[64]; /**< Cells whose neighbour at the offset is on the same row. */
+    int num_planes; /**< Number of bits of the counters. */
+} playout_offsets;
+
+/**
+ * @brief Lists the offsets that can belong to a legal quadrant.
+ *
+ * @param offsets The offsets to fill.
+ */
+static void
+setup_offsets (playout_offsets *offsets)
+{
+    offsets->num_offsets = 0;
+    for (int dr = 0; dr < board_rows; dr++) {
+        for (int dc = 0; dc < board_cols && (dr + 1) * (dc + 1) <= num_max_to_delete + 1; dc++) {
+            bitboard keep = 0;
+            for (int i = 0; i < board_rows; i++) {
+                for (int j = 0; j + dc < board_cols; j++) {
+                    keep |= bitboard_cell(i, j);
+                }
+            }
+            offsets->shift[offsets->num_offsets] = dr * board_cols + dc;
+            offsets->keep[offsets->num_offsets] = keep;
+            offsets->num_offsets++;
+        }
+    }
+    int max_value = offsets->num_offsets > num_max_to_delete ? offsets->num_offsets : num_max_to_delete;
+    if (max_value > 64) {
+        max_value = 64; // No quadrant has more cells, every move is legal above
+    }
+    offsets->num_planes = 0;
+    while ((1 << offsets->num_planes) <= max_value) {
+        offsets->num_planes++;
+    }
+}
+
+/**
+ * @brief Computes the legal moves of every lane with counters of a given width.
+ *
+ * Each cell gets a bit-sliced counter of the present cells at the listed
+ * offsets, which is its deletion count whenever that count is legal, and
+ * more than num_max_to_delete otherwise. The counters are then compared to
+ * the limit bit by bit. Called with a constant width so the plane loops are
+ * unrolled.
+ */
+static inline __attribute__((always_inline)) lanes
+legal_lanes_sized (const lanes *board_lanes, const playout_offsets *offsets, int num_planes)
+{
+    lanes boards = *board_lanes;
+    lanes planes[8] = {0};
+    for (int k = 0; k < offsets->num_offsets; k++) {
+        lanes carry = (boards >> offsets->shift[k]) & offsets->keep[k];
+        for (int b = 0; b < num_planes; b++) {
+            lanes overflow = planes[b] & carry;
+            planes[b] ^= carry;
+            carry = overflow;
+        }
+    }
+    lanes less = boards ^ boards; // All zero
+    lanes equal = ~less;
+    for (int b = num_planes - 1; b >= 0; b--) {
+        if ((num_max_to_delete >> b) & 1) {
+            less |= equal & ~planes[b];
+            equal &= planes[b];
+        } else {
+            equal &= ~planes[b];
+        }
+    }
+    return boards & (less | equal);
+}
+
+/**
+ * @brief Computes the legal moves of every lane.
+ */
+static inline __attribute__((always_inline)) lanes
+legal_lanes (const lanes *boards, const playout_offsets *offsets)
+{
+    if (num_max_to_delete >= (1 << offsets->num_planes)) {
+        return *boards; // Every quadrant is small enough
+    }
+    switch (offsets->num_planes) {
+    case 1: return legal_lanes_sized(boards, offsets, 1);
+    case 2: return legal_lanes_sized(boards, offsets, 2);
+    case 3: return legal_lanes_sized(boards, offsets, 3);
+    case 4: return legal_lanes_sized(boards, offsets, 4);
+    case 5: return legal_lanes_sized(boards, offsets, 5);
+    case 6: return legal_lanes_sized(boards, offsets, 6);
+    default: return legal_lanes_sized(boards, offsets, 7);
+    }
+}
+
+/**
+ * @brief Picks a random set bit in every lane.
+ *
+ * The running bit counts of the bytes give the byte holding the chosen bit
+ * in one comparison of all bytes at once, then a short binary search finds
+ * the bit inside that byte.
+ */
+static inline __attribute__((always_inline)) lanes
+select_lanes (const lanes *legal_moves, const lanes *random_numbers)
+{
+    lanes legal = *legal_moves;
+    lanes random = *random_numbers;
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    lanes counts = legal - ((legal >> 1) & (ones * 0x55));
+    counts = (counts & (ones * 0x33)) + ((counts >> 2) & (ones * 0x33));
+    counts = (counts + (counts >> 4)) & (ones * 0x0f); // Bits of each byte
+    lanes prefix = counts + (counts << 8);
+    prefix += prefix << 16;
+    prefix += prefix << 32; // Bits up to the end of each byte, at most 64 so no carry
+    lanes choice = (random * (prefix >> 56)) >> 32; // Same choice as playout_scalar()
+
+    lanes spread = choice | (choice << 8);
+    spread |= spread << 16;
+    spread |= spread << 32;
+    lanes before = (((spread | (ones * 0x80)) - prefix) & (ones * 0x80)) >> 7; // 1 in the bytes ending before the chosen bit
+    before += before >> 8;
+    before += before >> 16;
+    before += before >> 32;
+    lanes byte = (before & 0xff) * 8;
+
+    choice -= ((prefix << 8) >> byte) & 0xff; // Bits of the lower bytes
+    lanes bits = (legal >> byte) & 0xff;
+    lanes position = byte;
+    for (int width = 4; width > 0; width >>= 1) {
+        lanes low = bits & ((UINT64_C(1) << width) - 1);
+        lanes count = low - ((low >> 1) & 0x55);
+        count = (count & 0x33) + ((count >> 2) & 0x33);
+        lanes go_high = (lanes) ((signed_lanes) choice >= (signed_lanes) count); // Both are small, the signed compare is native on more targets
+        choice -= count & go_high;
+        position += (uint64_t) width & go_high;
+        bits = ((bits >> width) & go_high) | (low & ~go_high);
+    }
+    return position;
+}
+
+/**
+ * @brief Plays one random move in every lane still playing.
+ */
+static inline __attribute__((always_inline)) void
+playout_step (lanes *boards, lanes *rng, lanes *moves, const playout_offsets *offsets)
+{
+    lanes active = (lanes) ((*boards & 1) != 0);
+    lanes legal = legal_lanes(boards, offsets);
+    *rng ^= *rng << 13;
+    *rng ^= *rng >> 7;
+    *rng ^= *rng << 17;
+    lanes random = *rng >> 32;
+    lanes position = select_lanes(&legal, &random);
+
+    lanes quadrant;
+    for (int lane = 0; lane < PLAYOUT_LANES; lane++) {
+        quadrant[lane] = bitboard_quadrant_masks[position[lane] & 63]; // Gather
+    }
+    *boards &= ~(quadrant & active);
+    *moves -= active; // active is -1 on the lanes still playing
+}
+
+/**
+ * @brief Plays one batch of PLAYOUT_LANES games in lock step.
+ *
+ * A finished lane has no legal move left and does not change any more, so
+ * the end of the batch is only checked every four moves.
+ */
+static void
+playout_lanes (const lanes *start, const lanes *seeds, const playout_offsets *offsets, lanes *num_moves)
+{
+    lanes boards = *start;
+    lanes rng = *seeds;
+    lanes moves = boards ^ boards;
+    while (1) {
+        bool any_active = false;
+        for (int lane = 0; lane < PLAYOUT_LANES; lane++) {
+            any_active |= (boards[lane] & 1) != 0;
+        }
+        if (!any_active) {
+            break;
+        }
+        for (int step = 0; step < 4; step++) {
+            playout_step(&boards, &rng, &moves, offsets);
+        }
+    }
+    *num_moves = moves;
+}
+
+#endif
+
+/**
+ * @brief Plays one random game from each board.
+ *
+ * @param boards The starting positions, the board must fit in a bitboard.
+ * @param num_boards The number of positions.
+ * @param seed The seed of the random moves.
+ * @param wins The array to fill, wins[i] is true if the player to move in boards[i] won.
+ */
+void
+playout_batch (const bitboard boards[], int num_boards, uint64_t seed, bool wins[])
+{
+#if defined(__GNUC__)
+    playout_offsets offsets;
+    setup_offsets(&offsets);
+    for (int first = 0; first < num_boards; first += PLAYOUT_LANES) {
+        lanes batch_boards = {0};
+        lanes batch_rng;
+        for (int lane = 0; lane < PLAYOUT_LANES; lane++) {
+            batch_rng[lane] = playout_seed(seed, first + lane);
+            if (first + lane < num_boards) {
+                batch_boards[lane] = boards[first + lane]; // Missing lanes stay empty and never play
+            }
+        }
+        lanes num_moves;
+        playout_lanes(&batch_boards, &batch_rng, &offsets, &num_moves);
+        for (int lane = 0; lane < PLAYOUT_LANES && first + lane < num_boards; lane++) {
+            wins[first + lane] = num_moves[lane] % 2 == 0;
+        }
+    }
+#else
+    for (int i = 0; i < num_boards; i++) {
+        uint64_t rng = playout_seed(seed, i);
+        wins[i] = playout_scalar(boards[i], &rng);
+    }
+#endif
+}
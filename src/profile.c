@@ -0,0 +1,196 @@
+/**
+ * @file profile.c
+ * @brief Implementation of the staircase representation of a Chomp position.
+ *
+ * This file contains the conversions between the int table and the row
+ * length profile, and the move, deletion count and legality functions
+ * working directly on row lengths.
+ */
+
+#include "profile.h"
+#include <string.h>
+#include "const.h"
+
+/**
+ * @brief Initializes a profile with every cell present.
+ *
+ * @param profile The profile to initialize.
+ */
+void
+profile_init (chomp_profile *profile)
+{
+    memset(profile, 0, sizeof(*profile));
+    for (int i = 0; i < board_rows; i++) {
+        profile->row_len[i] = (unsigned char) board_cols;
+    }
+}
+
+/**
+ * @brief Builds a profile from an int table.
+ *
+ * @param table The game table.
+ * @param profile The profile to fill.
+ */
+void
+profile_from_table (int table[ROWS][COLS], chomp_profile *profile)
+{
+    memset(profile, 0, sizeof(*profile));
+    for (int i = 0; i < board_rows; i++) {
+        int len = 0;
+        while (len < board_cols && table[i][len] == 1) {
+            len++; // Count the cells present from column 0
+        }
+        profile->row_len[i] = (unsigned char) len;
+    }
+}
+
+/**
+ * @brief Writes a profile back to an int table.
+ *
+ * @param profile The profile.
+ * @param table The game table to fill.
+ */
+void
+profile_to_table (const chomp_profile *profile, int table[ROWS][COLS])
+{
+    for (int i = 0; i < board_rows; i++) {
+        for (int j = 0; j < board_cols; j++) {
+            table[i][j] = j < profile->row_len[i];
+        }
+    }
+}
+
+/**
+ * @brief Calculates the number of cells a move would delete.
+ *
+ * @param profile The profile.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return The number of cells to delete.
+ */
+int
+profile_num_to_delete (const chomp_profile *profile, int row, int col)
+{
+    int num_cell_to_delete = 0;
+    for (int i = row; i < board_rows && profile->row_len[i] > col; i++) {
+        num_cell_to_delete += profile->row_len[i] - col;
+    }
+    return num_cell_to_delete;
+}
+
+/**
+ * @brief Checks if a move is legal.
+ *
+ * @param profile The profile.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return true if the move is legal, false otherwise.
+ */
+bool
+profile_is_legal_move (const chomp_profile *profile, int row, int col)
+{
+    if (row < 0 || row >= board_rows || col < 0 || !profile_is_cell_set(profile, row, col)) {
+        return false;
+    }
+    int num_cell_to_delete = 0;
+    for (int i = row; i < board_rows && profile->row_len[i] > col; i++) {
+        num_cell_to_delete += profile->row_len[i] - col;
+        if (num_cell_to_delete > num_max_to_delete) {
+            return false; // No need to count the rest
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Applies a move to a profile.
+ *
+ * @param profile The profile.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ */
+void
+profile_delete_cells (chomp_profile *profile, int row, int col)
+{
+    for (int i = row; i < board_rows && profile->row_len[i] > col; i++) {
+        profile->row_len[i] = (unsigned char) col;
+    }
+}
+
+/**
+ * @brief Calculates the number of cells left in a column.
+ *
+ * The rows longer than the column form a prefix of the profile, so its
+ * length is found by binary search.
+ *
+ * @param profile The profile.
+ * @param col The column.
+ * @return The number of rows longer than the column.
+ */
+int
+profile_col_len (const chomp_profile *profile, int col)
+{
+    int low = 0;
+    int high = board_rows;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (profile->row_len[mid] > col) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Calculates the number of cells left on the board.
+ *
+ * @param profile The profile.
+ * @return The number of cells present.
+ */
+int
+profile_num_cells (const chomp_profile *profile)
+{
+    int num_cells = 0;
+    for (int i = 0; i < board_rows && profile->row_len[i] > 0; i++) {
+        num_cells += profile->row_len[i];
+    }
+    return num_cells;
+}
+
+/**
+ * @brief Hashes a profile.
+ *
+ * FNV-1a over the row lengths followed by a final avalanche so that the low
+ * bits can be used directly as a table index.
+ *
+ * @param profile The profile.
+ * @return A 64-bit hash of the row lengths.
+ */
+uint64_t
+profile_hash (const chomp_profile *profile)
+{
+    uint64_t hash = UINT64_C(14695981039346656037);
+    for (int i = 0; i < board_rows; i++) {
+        hash ^= profile->row_len[i];
+        hash *= UINT64_C(1099511628211);
+    }
+    hash ^= hash >> 33;
+    hash *= UINT64_C(0xff51afd7ed558ccd);
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * @brief Compares two profiles.
+ *
+ * @param a The first profile.
+ * @param b The second profile.
+ * @return true if both profiles describe the same position.
+ */
+bool
+profile_equal (const chomp_profile *a, const chomp_profile *b)
+{
+    return memcmp(a->row_len, b->row_len, sizeof(a->row_len)) == 0;
+}
@@ -0,0 +1,888 @@
+/**
+ * @file search.c
+ * @brief Implementation of the alpha-beta search engine.
+ *
+ * This file contains the Zobrist hashing of the positions, the negamax
+ * search with its transposition table and move ordering, the split of the
+ * search over threads, the iterative deepening loop and the ai move built
+ * on top of them.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "search.h"
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+#include "deadline.h"
+
+int search_depth = SEARCH_DEFAULT_DEPTH;
+int search_threads = 0;
+
+/**
+ * @brief The engine of the ai, shared by search_ai_move() and search_ai_ponder().
+ */
+static search_engine ai_engine;
+
+/**
+ * @brief True once the engine of the ai is created.
+ */
+static bool ai_engine_ready = false;
+
+/**
+ * @def SEARCH_PROVEN_SCORE
+ * @brief Smallest absolute value of a proven score.
+ */
+#define SEARCH_PROVEN_SCORE (SEARCH_WIN_SCORE - SEARCH_MAX_PLY)
+
+/**
+ * @def SEARCH_INFINITY
+ * @brief Larger than any score.
+ */
+#define SEARCH_INFINITY (SEARCH_WIN_SCORE + 1)
+
+/**
+ * @def SEARCH_CLOCK_NODES
+ * @brief Each worker reads the clock once every this many positions, a power of two.
+ */
+#define SEARCH_CLOCK_NODES 1024
+
+/**
+ * @struct split_point
+ * @brief A node whose remaining moves are shared with the other threads.
+ *
+ * The split point lives on the stack of the thread that created it, which
+ * waits until every task of the node is done.
+ */
+typedef struct split_point {
+    pthread_mutex_t lock; /**< Protects the best score and move. */
+    const game_state *state; /**< The position of the node. */
+    uint64_t hash; /**< The Zobrist hash of the position. */
+    int depth; /**< The number of plies left to search. */
+    int ply; /**< The number of plies from the root. */
+    int beta; /**< The score the opponent is already sure to get. */
+    atomic_int alpha; /**< The score the player to move is already sure to get. */
+    int best_score; /**< The best score found. */
+    int best_move; /**< The move of the best score. */
+    atomic_int pending; /**< The number of tasks not done yet. */
+    atomic_bool cutoff; /**< True once a move reached beta, the other moves are useless. */
+    const struct split_point *parent; /**< The split point the node was searched from, NULL at the root. */
+} split_point;
+
+/**
+ * @struct search_task
+ * @brief A move of a split point, searched by any thread.
+ */
+typedef struct {
+    split_point *split; /**< The node. */
+    int move; /**< The move, row * COLS + col. */
+} search_task;
+
+/**
+ * @struct search_worker
+ * @brief The state of one thread of a search.
+ *
+ * Each worker owns a deque of tasks: it pushes and pops at the bottom, the
+ * other workers steal at the top, where the tasks closest to the root are.
+ */
+typedef struct search_worker {
+    search_engine *engine; /**< The engine, shared by all the workers. */
+    struct search_worker *workers; /**< All the workers of the search, this one included. */
+    int num_workers; /**< The number of workers of the search. */
+    int index; /**< The index of this worker. */
+    pthread_mutex_t lock; /**< Protects the deque. */
+    search_task *tasks; /**< The deque. */
+    int top; /**< Index of the oldest task. */
+    int bottom; /**< Index after the newest task. */
+    atomic_bool *done; /**< Set once the search is over. */
+    uint64_t deadline; /**< Deadline of the search, NO_DEADLINE if none. */
+    atomic_bool *timeout; /**< Set once the deadline has passed. */
+    uint64_t nodes; /**< Number of positions searched by this worker. */
+    int16_t killers[SEARCH_MAX_PLY][2]; /**< Moves that caused a cutoff at each ply. */
+    game_state_undo undo; /**< The moves played down to the current node. */
+} search_worker;
+
+/**
+ * @struct move_picker
+ * @brief Lists the moves of a position, the most promising first.
+ */
+typedef struct {
+    int first_moves[3]; /**< The move of the table and the killer moves, legal and distinct. */
+    int num_first_moves; /**< The number of first moves. */
+    int k; /**< The number of first moves already listed. */
+    int row; /**< The row of the next other move. */
+    int col; /**< The column of the next other move. */
+} move_picker;
+
+/**
+ * @brief Returns the Zobrist key of a row length.
+ *
+ * The keys are computed on the fly with the splitmix64 finalizer instead
+ * of being read from a table, so they need no initialization and do not
+ * depend on the board dimensions.
+ *
+ * @param row The row.
+ * @param len The length of the row.
+ * @return The key of the row with this length.
+ */
+static inline uint64_t
+zobrist_key (int row, int len)
+{
+    uint64_t key = (uint64_t) (row * (COLS + 1) + len + 1) * UINT64_C(0x9e3779b97f4a7c15);
+    key = (key ^ (key >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    key = (key ^ (key >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return key ^ (key >> 31);
+}
+
+/**
+ * @brief Computes the Zobrist hash of a position.
+ *
+ * The hash is the xor of one random key per row and row length, so a move
+ * only updates the keys of the rows it cuts.
+ *
+ * @param profile The position.
+ * @return The hash of the position.
+ */
+uint64_t
+search_hash (const chomp_profile *profile)
+{
+    uint64_t hash = 0;
+    for (int i = 0; i < board_rows; i++) {
+        hash ^= zobrist_key(i, profile->row_len[i]);
+    }
+    return hash;
+}
+
+/**
+ * @brief Updates a Zobrist hash with a move.
+ *
+ * @param profile The position before the move.
+ * @param hash The hash of the position.
+ * @param row The row of the chosen cell.
+ * @param col The column of the chosen cell.
+ * @return The hash of the position after the move.
+ */
+static uint64_t
+hash_after_move (const chomp_profile *profile, uint64_t hash, int row, int col)
+{
+    for (int i = row; i < board_rows && profile->row_len[i] > col; i++) {
+        hash ^= zobrist_key(i, profile->row_len[i]) ^ zobrist_key(i, col);
+    }
+    return hash;
+}
+
+/**
+ * @brief Checks if a score proves the result of the position.
+ *
+ * @param score The score.
+ * @return true if the score is a proven win or loss.
+ */
+static inline bool
+is_proven (int score)
+{
+    return score >= SEARCH_PROVEN_SCORE || score <= -SEARCH_PROVEN_SCORE;
+}
+
+/**
+ * @brief Converts a score to be stored in the transposition table.
+ *
+ * Proven scores count the plies from the root, the table counts them from
+ * the stored position so that the entry holds wherever it is found again.
+ */
+static inline int
+score_to_table (int score, int ply)
+{
+    if (score >= SEARCH_PROVEN_SCORE) {
+        return score + ply;
+    } else if (score <= -SEARCH_PROVEN_SCORE) {
+        return score - ply;
+    }
+    return score;
+}
+
+/**
+ * @brief Converts a score read from the transposition table.
+ */
+static inline int
+score_from_table (int score, int ply)
+{
+    if (score >= SEARCH_PROVEN_SCORE) {
+        return score - ply;
+    } else if (score <= -SEARCH_PROVEN_SCORE) {
+        return score + ply;
+    }
+    return score;
+}
+
+/**
+ * @brief Packs the data of a transposition table entry in one word.
+ *
+ * The score takes the low 32 bits, then the move 16 bits, the depth 14 bits
+ * and the bound the 2 high bits.
+ */
+static inline uint64_t
+pack_entry (int score, int move, int depth, int flag)
+{
+    return (uint64_t) (uint32_t) score
+           | (uint64_t) (uint16_t) move << 32
+           | (uint64_t) depth << 48
+           | (uint64_t) flag << 62;
+}
+
+/**
+ * @brief Creates a search engine.
+ *
+ * @param engine The engine to initialize.
+ * @param table_bits The transposition table holds 2^table_bits entries.
+ * @param num_threads The number of threads of a search, 0 for one per processor.
+ * @return true if the table could be allocated, false otherwise.
+ */
+bool
+search_engine_init (search_engine *engine, int table_bits, int num_threads)
+{
+    memset(engine, 0, sizeof(*engine));
+    engine->table = calloc((size_t) 1 << table_bits, sizeof(search_entry));
+    if (engine->table == NULL) {
+        return false;
+    }
+    engine->mask = ((uint64_t) 1 << table_bits) - 1;
+    if (num_threads <= 0) {
+        long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = num_cpus > 0 ? (int) num_cpus : 1;
+    }
+    engine->num_threads = num_threads < SEARCH_MAX_THREADS ? num_threads : SEARCH_MAX_THREADS;
+    return true;
+}
+
+/**
+ * @brief Frees the transposition table of a search engine.
+ *
+ * @param engine The engine.
+ */
+void
+search_engine_free (search_engine *engine)
+{
+    free(engine->table);
+    engine->table = NULL;
+}
+
+/**
+ * @brief Empties the transposition table.
+ *
+ * @param engine The engine.
+ */
+void
+search_engine_clear (search_engine *engine)
+{
+    memset(engine->table, 0, (engine->mask + 1) * sizeof(search_entry));
+}
+
+/**
+ * @brief Checks if a split point or one of its ancestors was cut off.
+ *
+ * The search under a split point that was cut off is useless, its result
+ * must be neither used nor stored.
+ *
+ * @param split The split point, NULL outside of any.
+ * @return true if the search must stop.
+ */
+static inline bool
+is_aborted (const split_point *split)
+{
+    for (; split != NULL; split = split->parent) {
+        if (atomic_load_explicit(&split->cutoff, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks if a split point is searched under another one.
+ *
+ * @param split The split point.
+ * @param ancestor The other split point, NULL for the root.
+ * @return true if split is ancestor or is searched under it.
+ */
+static bool
+is_descendant (const split_point *split, const split_point *ancestor)
+{
+    if (ancestor == NULL) {
+        return true;
+    }
+    for (; split != NULL; split = split->parent) {
+        if (split == ancestor) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Takes the newest task of the deque of a worker.
+ *
+ * @param worker The worker.
+ * @param ancestor Only a task of this split point or under it is taken.
+ * @param task Where to store the task.
+ * @return true if a task was taken.
+ */
+static bool
+pop_task (search_worker *worker, const split_point *ancestor, search_task *task)
+{
+    bool found = false;
+    pthread_mutex_lock(&worker->lock);
+    if (worker->bottom > worker->top && is_descendant(worker->tasks[worker->bottom - 1].split, ancestor)) {
+        *task = worker->tasks[--worker->bottom];
+        found = true;
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return found;
+}
+
+/**
+ * @brief Takes the oldest task of the deque of another worker.
+ *
+ * @param worker The worker looking for a task.
+ * @param ancestor Only a task of this split point or under it is taken, NULL for any task.
+ * @param task Where to store the task.
+ * @return true if a task was stolen.
+ */
+static bool
+steal_task (search_worker *worker, const split_point *ancestor, search_task *task)
+{
+    for (int i = 1; i < worker->num_workers; i++) {
+        search_worker *victim = &worker->workers[(worker->index + i) % worker->num_workers];
+        bool found = false;
+        pthread_mutex_lock(&victim->lock);
+        if (victim->bottom > victim->top && is_descendant(victim->tasks[victim->top].split, ancestor)) {
+            *task = victim->tasks[victim->top++];
+            found = true;
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Starts listing the moves of a position.
+ *
+ * @param picker The move picker.
+ * @param state The position.
+ * @param tt_move The move of the transposition table, -1 if none.
+ * @param killers The killer moves of the ply.
+ */
+static void
+move_picker_init (move_picker *picker, const game_state *state, int tt_move, const int16_t killers[2])
+{
+    int candidates[3] = {tt_move, killers[0], killers[1]};
+    picker->num_first_moves = 0;
+    for (int k = 0; k < 3; k++) {
+        int move = candidates[k];
+        if (move >= 0 && game_state_is_legal_move(state, move / COLS, move % COLS)
+            && (picker->num_first_moves == 0 || picker->first_moves[0] != move)
+            && (picker->num_first_moves < 2 || picker->first_moves[1] != move)) {
+            picker->first_moves[picker->num_first_moves++] = move;
+        }
+    }
+    picker->k = 0;
+    picker->row = 0;
+    picker->col = state->first_legal[0];
+}
+
+/**
+ * @brief Returns the next move of a position.
+ *
+ * The move of the table and the killer moves come first, then every other
+ * legal move in row-major order.
+ *
+ * @param picker The move picker.
+ * @param state The position.
+ * @return The move, row * COLS + col, -1 once every move was listed.
+ */
+static int
+move_picker_next (move_picker *picker, const game_state *state)
+{
+    if (picker->k < picker->num_first_moves) {
+        return picker->first_moves[picker->k++];
+    }
+    while (true) {
+        while (picker->row < board_rows && picker->col >= state->profile.row_len[picker->row]) {
+            picker->row++;
+            picker->col = (picker->row < board_rows) ? state->first_legal[picker->row] : 0;
+        }
+        if (picker->row >= board_rows) {
+            return -1;
+        }
+        int move = picker->row * COLS + picker->col++;
+        bool listed = false;
+        for (int k = 0; k < picker->num_first_moves; k++) {
+            listed = listed || picker->first_moves[k] == move;
+        }
+        if (!listed) {
+            return move;
+        }
+    }
+}
+
+static void split_search (search_worker *worker, const game_state *state, uint64_t hash, int depth, int ply,
+                          int *alpha, int beta, int *best_score, int *best_move,
+                          int move, move_picker *picker, const split_point *parent);
+
+/**
+ * @brief Searches a position with negamax and alpha-beta pruning.
+ *
+ * Once the first move of a node close enough to the root has been searched,
+ * the other moves are shared with the other workers. The moves are played
+ * and taken back on the position with the undo stack of the worker, only
+ * the tasks of a split point start from a copy of it.
+ *
+ * @param worker The worker.
+ * @param state The position, the same again when the function returns.
+ * @param hash The Zobrist hash of the position.
+ * @param depth The number of plies left to search.
+ * @param ply The number of plies from the root.
+ * @param alpha The score the player to move is already sure to get.
+ * @param beta The score the opponent is already sure to get.
+ * @param split The split point the position is searched from, NULL if none.
+ * @return The score of the position for the player to move, meaningless if the split point was cut off.
+ */
+static int
+negamax (search_worker *worker, game_state *state, uint64_t hash, int depth, int ply, int alpha, int beta, const split_point *split)
+{
+    worker->nodes++;
+    if ((worker->nodes & (SEARCH_CLOCK_NODES - 1)) == 0
+        && (deadline_passed(worker->deadline) || (worker->engine->stop != NULL && atomic_load(worker->engine->stop)))) {
+        atomic_store_explicit(worker->timeout, true, memory_order_relaxed);
+    }
+    if (state->profile.row_len[0] == 0) {
+        return SEARCH_WIN_SCORE - ply; // The opponent ate the poisoned cell
+    }
+    if (depth == 0 || is_aborted(split)) {
+        return 0;
+    }
+
+    search_entry *entry = &worker->engine->table[hash & worker->engine->mask];
+    uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+    int tt_move = -1;
+    if ((check ^ data) == hash) {
+        tt_move = (int16_t) (data >> 32);
+        int score = score_from_table((int32_t) (uint32_t) data, ply);
+        int entry_depth = (int) ((data >> 48) & SEARCH_PROVEN_DEPTH);
+        int flag = (int) (data >> 62);
+        if (entry_depth >= depth
+            && (flag == SEARCH_EXACT
+                || (flag == SEARCH_LOWER && score >= beta)
+                || (flag == SEARCH_UPPER && score <= alpha))) {
+            return score;
+        }
+    }
+
+    move_picker picker;
+    move_picker_init(&picker, state, tt_move, worker->killers[ply]);
+    int alpha_orig = alpha;
+    int best_score = -SEARCH_INFINITY;
+    int best_move = -1;
+    int move;
+    while (alpha < beta && (move = move_picker_next(&picker, state)) >= 0) {
+        if (best_move >= 0 && worker->num_workers > 1 && ply < SEARCH_SPLIT_PLY && depth >= SEARCH_SPLIT_DEPTH) {
+            // The first move is searched, the other workers can help with the rest
+            split_search(worker, state, hash, depth, ply, &alpha, beta, &best_score, &best_move, move, &picker, split);
+            break;
+        }
+
+        uint64_t child_hash = hash_after_move(&state->profile, hash, move / COLS, move % COLS);
+        game_state_make_move(state, move / COLS, move % COLS, &worker->undo);
+        int score = -negamax(worker, state, child_hash, depth - 1, ply + 1, -beta, -alpha, split);
+        game_state_unmake_move(state, &worker->undo);
+        if (is_aborted(split)) {
+            return 0;
+        }
+
+        if (score > best_score) {
+            best_score = score;
+            best_move = move;
+            if (score > alpha) {
+                alpha = score;
+            }
+        }
+    }
+    if (is_aborted(split)) {
+        return 0;
+    }
+
+    if (alpha >= beta && worker->killers[ply][0] != best_move) {
+        worker->killers[ply][1] = worker->killers[ply][0];
+        worker->killers[ply][0] = (int16_t) best_move;
+    }
+
+    int flag = SEARCH_EXACT;
+    if (best_score <= alpha_orig) {
+        flag = SEARCH_UPPER;
+    } else if (best_score >= beta) {
+        flag = SEARCH_LOWER;
+    }
+    bool proven = (flag == SEARCH_EXACT && is_proven(best_score))
+                  || (flag == SEARCH_LOWER && best_score >= SEARCH_PROVEN_SCORE)
+                  || (flag == SEARCH_UPPER && best_score <= -SEARCH_PROVEN_SCORE);
+    data = pack_entry(score_to_table(best_score, ply), best_move, proven ? SEARCH_PROVEN_DEPTH : depth, flag);
+    atomic_store_explicit(&entry->data, data, memory_order_relaxed);
+    atomic_store_explicit(&entry->check, hash ^ data, memory_order_relaxed);
+    return best_score;
+}
+
+/**
+ * @brief Searches one move of a split point and merges its score.
+ *
+ * @param worker The worker.
+ * @param task The task.
+ */
+static void
+run_task (search_worker *worker, const search_task *task)
+{
+    split_point *split = task->split;
+    if (!is_aborted(split)) {
+        int row = task->move / COLS;
+        int col = task->move % COLS;
+        game_state child = *split->state;
+        uint64_t child_hash = hash_after_move(&split->state->profile, split->hash, row, col);
+        game_state_apply_move(&child, row, col);
+        int alpha = atomic_load(&split->alpha);
+        int score = -negamax(worker, &child, child_hash, split->depth - 1, split->ply + 1, -split->beta, -alpha, split);
+
+        pthread_mutex_lock(&split->lock);
+        if (!is_aborted(split) && score > split->best_score) {
+            split->best_score = score;
+            split->best_move = task->move;
+            if (score > atomic_load(&split->alpha)) {
+                atomic_store(&split->alpha, score);
+            }
+            if (score >= split->beta) {
+                atomic_store(&split->cutoff, true);
+            }
+        }
+        pthread_mutex_unlock(&split->lock);
+    }
+    atomic_fetch_sub(&split->pending, 1);
+}
+
+/**
+ * @brief Shares the remaining moves of a node with the other workers.
+ *
+ * The moves are pushed as tasks on the deque of the worker, which then
+ * searches them too until all of them are done. While waiting, it only takes
+ * tasks searched under this node, so its stack never grows with unrelated
+ * work.
+ *
+ * @param worker The worker.
+ * @param state The position.
+ * @param hash The Zobrist hash of the position.
+ * @param depth The number of plies left to search.
+ * @param ply The number of plies from the root.
+ * @param alpha The alpha of the node, updated.
+ * @param beta The beta of the node.
+ * @param best_score The best score of the node, updated.
+ * @param best_move The best move of the node, updated.
+ * @param move The first move to share.
+ * @param picker The move picker of the node, listing the other moves to share.
+ * @param parent The split point the node is searched from, NULL if none.
+ */
+static void
+split_search (search_worker *worker, const game_state *state, uint64_t hash, int depth, int ply,
+              int *alpha, int beta, int *best_score, int *best_move,
+              int move, move_picker *picker, const split_point *parent)
+{
+    split_point split;
+    pthread_mutex_init(&split.lock, NULL);
+    split.state = state;
+    split.hash = hash;
+    split.depth = depth;
+    split.ply = ply;
+    split.beta = beta;
+    atomic_init(&split.alpha, *alpha);
+    split.best_score = *best_score;
+    split.best_move = *best_move;
+    atomic_init(&split.cutoff, false);
+    split.parent = parent;
+
+    // No thief can see the tasks before the deque is unlocked, pending is set by then
+    int num_tasks = 0;
+    pthread_mutex_lock(&worker->lock);
+    do {
+        worker->tasks[worker->bottom++] = (search_task) {&split, move};
+        num_tasks++;
+    } while ((move = move_picker_next(picker, state)) >= 0);
+    atomic_init(&split.pending, num_tasks);
+    pthread_mutex_unlock(&worker->lock);
+
+    search_task task;
+    while (atomic_load(&split.pending) > 0) {
+        if (pop_task(worker, &split, &task) || steal_task(worker, &split, &task)) {
+            run_task(worker, &task);
+        } else {
+            sched_yield(); // The last tasks are searched by other workers
+        }
+    }
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->bottom == worker->top) {
+        worker->bottom = worker->top = 0; // Reuse the deque from its start
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    *alpha = atomic_load(&split.alpha);
+    *best_score = split.best_score;
+    *best_move = split.best_move;
+    pthread_mutex_destroy(&split.lock);
+}
+
+/**
+ * @brief Steals and searches tasks until the search is over.
+ *
+ * @param arg The worker.
+ * @return NULL
+ */
+static void *
+search_worker_loop (void *arg)
+{
+    search_worker *worker = arg;
+    search_task task;
+    while (!atomic_load(worker->done)) {
+        if (steal_task(worker, NULL, &task)) {
+            run_task(worker, &task);
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Reads the best move of a position from the transposition table.
+ *
+ * @param engine The engine.
+ * @param hash The Zobrist hash of the position.
+ * @return The move, row * COLS + col, -1 if the position is not in the table.
+ */
+static int
+table_move (const search_engine *engine, uint64_t hash)
+{
+    const search_entry *entry = &engine->table[hash & engine->mask];
+    uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+    if ((atomic_load_explicit(&entry->check, memory_order_relaxed) ^ data) != hash) {
+        return -1;
+    }
+    return (int16_t) (data >> 32);
+}
+
+/**
+ * @brief Searches the best move of a position.
+ *
+ * The transposition table is kept between calls, it is only emptied when
+ * the board configuration changed since the last call. The helper threads
+ * are started for the call and joined before it returns.
+ *
+ * With a time budget, the iteration running when the deadline passes is
+ * dropped and the move of the last complete one is returned. The first
+ * iteration always completes, so there is a move however small the budget.
+ * The same happens when the stop flag of the engine is set.
+ *
+ * @param engine The engine.
+ * @param state The position.
+ * @param max_depth The depth limit, in plies.
+ * @param time_budget_ms The time the search may take, in milliseconds, 0 for no limit.
+ * @return The best move found and its score.
+ */
+search_result
+search_best_move (search_engine *engine, const game_state *state, int max_depth, int time_budget_ms)
+{
+    uint64_t deadline = deadline_from_budget(time_budget_ms);
+    search_result result = {-1, -1, 0, 0};
+    if (engine->rows != board_rows || engine->cols != board_cols || engine->max_to_delete != num_max_to_delete) {
+        search_engine_clear(engine);
+        engine->rows = board_rows;
+        engine->cols = board_cols;
+        engine->max_to_delete = num_max_to_delete;
+    }
+    engine->nodes = 0;
+    if (state->profile.row_len[0] == 0) {
+        return result;
+    }
+
+    // No game lasts longer than its number of cells
+    int num_cells = profile_num_cells(&state->profile);
+    if (max_depth > num_cells || max_depth <= 0) {
+        max_depth = num_cells;
+    }
+    if (max_depth > SEARCH_PROVEN_DEPTH - 1) {
+        max_depth = SEARCH_PROVEN_DEPTH - 1;
+    }
+
+    // Each worker holds at most the moves of one split point per ply it splits at
+    int num_workers = engine->num_threads > 1 ? engine->num_threads : 1;
+    size_t deque_size = (size_t) SEARCH_SPLIT_PLY * board_rows * board_cols;
+    search_worker *workers = malloc(num_workers * sizeof(search_worker));
+    search_task *tasks = malloc(num_workers * deque_size * sizeof(search_task));
+    pthread_t *threads = malloc(num_workers * sizeof(pthread_t));
+    bool *started = calloc(num_workers, sizeof(bool));
+    if (workers == NULL || tasks == NULL || threads == NULL || started == NULL) {
+        free(workers);
+        free(tasks);
+        free(threads);
+        free(started);
+        return result;
+    }
+    atomic_bool done;
+    atomic_init(&done, false);
+
+    // The root split point is never shared, it only cuts off the whole iteration when the deadline passes
+    split_point root;
+    atomic_init(&root.cutoff, false);
+    root.parent = NULL;
+    for (int t = 0; t < num_workers; t++) {
+        search_worker *worker = &workers[t];
+        worker->engine = engine;
+        worker->workers = workers;
+        worker->num_workers = num_workers;
+        worker->index = t;
+        pthread_mutex_init(&worker->lock, NULL);
+        worker->tasks = tasks + t * deque_size;
+        worker->top = 0;
+        worker->bottom = 0;
+        worker->done = &done;
+        worker->deadline = deadline;
+        worker->timeout = &root.cutoff;
+        worker->nodes = 0;
+        memset(worker->killers, 0xff, sizeof(worker->killers)); // -1, no killer move
+        if (!game_state_undo_init(&worker->undo, max_depth)) {
+            for (int k = 0; k <= t; k++) {
+                game_state_undo_free(&workers[k].undo);
+                pthread_mutex_destroy(&workers[k].lock);
+            }
+            free(workers);
+            free(tasks);
+            free(threads);
+            free(started);
+            return result;
+        }
+    }
+    for (int t = 1; t < num_workers; t++) {
+        started[t] = pthread_create(&threads[t], NULL, search_worker_loop, &workers[t]) == 0;
+    }
+
+    // Unproven positions score 0 and are searched again by the next iteration,
+    // doubling the depth keeps the cost of the iterations below the last one
+    game_state position = *state;
+    uint64_t hash = search_hash(&state->profile);
+    int depth = 1;
+    int move = -1;
+    while (true) {
+        int score = negamax(&workers[0], &position, hash, depth, 0, -SEARCH_INFINITY, SEARCH_INFINITY, depth == 1 ? NULL : &root);
+        if (depth > 1 && atomic_load(&root.cutoff)) {
+            break; // The deadline passed or the search was stopped, the last complete iteration stands
+        }
+        result.score = score;
+        result.depth = depth;
+        move = table_move(engine, hash); // The root is stored last, so its entry is still in the table
+        if (is_proven(result.score) || depth == max_depth || atomic_load(&root.cutoff)) {
+            break;
+        }
+        depth = (depth * 2 < max_depth) ? depth * 2 : max_depth;
+    }
+
+    atomic_store(&done, true);
+    for (int t = 0; t < num_workers; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    for (int t = 0; t < num_workers; t++) {
+        engine->nodes += workers[t].nodes;
+        game_state_undo_free(&workers[t].undo);
+        pthread_mutex_destroy(&workers[t].lock); // No thread steals anymore
+    }
+    free(workers);
+    free(tasks);
+    free(threads);
+    free(started);
+
+    if (move >= 0) {
+        result.row = move / COLS;
+        result.col = move % COLS;
+    } else {
+        int last_row = 0;
+        while (last_row + 1 < board_rows && state->profile.row_len[last_row + 1] > 0) {
+            last_row++;
+        }
+        result.row = last_row; // Eat the last cell of the last row, always legal
+        result.col = state->profile.row_len[last_row] - 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Chooses the move of the ai with the search engine.
+ *
+ * The engine is created on the first call and kept for the whole game, the
+ * search and the solver engines of the ai share it. It runs on
+ * search_threads threads.
+ *
+ * @param state The position.
+ * @param max_depth The depth limit, in plies, 0 to search until the result is proven.
+ * @param time_budget_ms The time the search may take, in milliseconds, 0 for no limit.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over or the engine could not be created.
+ */
+bool
+search_ai_move (const game_state *state, int max_depth, int time_budget_ms, int *row, int *col)
+{
+    if (!ai_engine_ready) {
+        if (!search_engine_init(&ai_engine, SEARCH_DEFAULT_TABLE_BITS, search_threads)) {
+            return false;
+        }
+        ai_engine_ready = true;
+    }
+
+    search_result result = search_best_move(&ai_engine, state, max_depth, time_budget_ms);
+    if (result.row < 0) {
+        return false;
+    }
+    *row = result.row;
+    *col = result.col;
+    return true;
+}
+
+/**
+ * @brief Searches a position of the opponent for the ai while it waits.
+ *
+ * The search runs on the engine of search_ai_move() until it is over or
+ * stop is set. Everything it proves stays in the transposition table, so
+ * the reply to the move the opponent plays is found faster.
+ *
+ * @param state The position, the opponent to move.
+ * @param max_depth The depth limit, in plies, 0 to search until the result is proven.
+ * @param stop Set by another thread to stop the search.
+ * @return true if the position was searched, false if the game is over or the engine could not be created.
+ */
+bool
+search_ai_ponder (const game_state *state, int max_depth, atomic_bool *stop)
+{
+    if (!ai_engine_ready) {
+        if (!search_engine_init(&ai_engine, SEARCH_DEFAULT_TABLE_BITS, search_threads)) {
+            return false;
+        }
+        ai_engine_ready = true;
+    }
+
+    ai_engine.stop = stop;
+    search_result result = search_best_move(&ai_engine, state, max_depth, 0);
+    ai_engine.stop = NULL;
+    return result.row >= 0;
+}
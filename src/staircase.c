@@ -0,0 +1,88 @@
+/**
+ * @file staircase.c
+ * @brief Implementation of the dense numbering of the staircase positions.
+ *
+ * This file contains the table of binomial coefficients, built at startup,
+ * and the conversion of a rank back to its position.
+ */
+
+#include <string.h>
+#include "staircase.h"
+#include "const.h"
+#include "profile.h"
+
+uint64_t staircase_binomials[ROWS + COLS + 1][ROWS + 1];
+
+/**
+ * @brief Builds the table of binomial coefficients at startup.
+ *
+ * Pascal's rule, a sum saturating at STAIRCASE_TOO_MANY once it no longer
+ * fits in 64 bits.
+ */
+static void __attribute__((constructor))
+staircase_setup (void)
+{
+    for (int n = 0; n <= ROWS + COLS; n++) {
+        staircase_binomials[n][0] = 1;
+        for (int k = 1; k <= ROWS; k++) {
+            if (n == 0) {
+                staircase_binomials[n][k] = 0;
+                continue;
+            }
+            uint64_t left = staircase_binomials[n - 1][k - 1];
+            uint64_t right = staircase_binomials[n - 1][k];
+            staircase_binomials[n][k] = left > STAIRCASE_TOO_MANY - right ? STAIRCASE_TOO_MANY : left + right;
+        }
+    }
+}
+
+/**
+ * @brief Builds the position of a rank.
+ *
+ * Each row, from row 0, takes the longest length whose count of positions
+ * before it is still within the rank left. The lengths only decrease, so
+ * the whole position takes O(rows + cols) steps.
+ *
+ * @param rank The rank, below staircase_count(rows, cols).
+ * @param rows The number of rows of the board.
+ * @param cols The number of columns of the board.
+ * @param profile Where to store the position, its rows past rows emptied.
+ */
+void
+staircase_unrank (uint64_t rank, int rows, int cols, chomp_profile *profile)
+{
+    memset(profile, 0, sizeof(*profile));
+    int len = cols;
+    for (int i = 0; i < rows; i++) {
+        while (len > 0 && staircase_binomials[rows - i - 1 + len][rows - i] > rank) {
+            len--;
+        }
+        profile->row_len[i] = (unsigned char) len;
+        rank -= staircase_binomials[rows - i - 1 + len][rows - i];
+    }
+}
+
+/**
+ * @brief Moves to the position of the next rank.
+ *
+ * @param profile The position, changed in place.
+ * @param rows The number of rows of the board.
+ * @param cols The number of columns of the board.
+ * @return true if there is a next position, false if the board is full.
+ */
+bool
+staircase_next (chomp_profile *profile, int rows, int cols)
+{
+    int row = rows - 1;
+    while (row >= 0 && profile->row_len[row] == (row == 0 ? cols : profile->row_len[row - 1])) {
+        row--;
+    }
+    if (row < 0) {
+        return false;
+    }
+    profile->row_len[row]++;
+    for (int i = row + 1; i < rows; i++) {
+        profile->row_len[i] = 0;
+    }
+    return true;
+}
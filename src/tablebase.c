@@ -0,0 +1,222 @@
+/**
+ * @file tablebase.c
+ * @brief Implementation of the perfect play tablebase.
+ *
+ * This file contains the retrograde solution of the positions of a board,
+ * stored in flat arrays indexed by the rank of the positions, and the ai
+ * engine reading its moves from the tablebase.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "tablebase.h"
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+#include "staircase.h"
+
+/**
+ * @brief The tablebase of the ai, solved for the current board on first use.
+ */
+static tablebase ai_tablebase;
+
+/**
+ * @brief Counts the positions of a board.
+ *
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @return C(rows + cols, rows), or TABLEBASE_MAX_POSITIONS + 1 if there are more.
+ */
+uint32_t
+tablebase_num_positions (int rows, int cols)
+{
+    uint64_t count = staircase_count(rows, cols);
+    return count > TABLEBASE_MAX_POSITIONS ? TABLEBASE_MAX_POSITIONS + 1 : (uint32_t) count;
+}
+
+/**
+ * @brief Solves a position whose every move leads to a position already solved.
+ *
+ * A move to a lost position wins, the fastest of them is kept. If every
+ * move leads to a won position, the position is lost and the slowest one is
+ * kept.
+ *
+ * @param tb The tablebase.
+ * @param state The position.
+ * @param number The number of the position.
+ */
+static void
+solve_position (tablebase *tb, const game_state *state, uint32_t number)
+{
+    static _Thread_local int possible_moves[ROWS * COLS][2];
+    int num_moves = game_state_legal_moves(state, possible_moves);
+    int best_win = -1;
+    int best_loss = -1;
+    int win_move = TABLEBASE_NO_MOVE;
+    int loss_move = TABLEBASE_NO_MOVE;
+
+    for (int m = 0; m < num_moves; m++) {
+        chomp_profile next = state->profile;
+        profile_delete_cells(&next, possible_moves[m][0], possible_moves[m][1]);
+        int distance = tb->distance[staircase_rank(&next, tb->rows)] + 1;
+        int move = possible_moves[m][0] * COLS + possible_moves[m][1];
+        if (distance % 2 == 0) {
+            if (best_win < 0 || distance < best_win) {
+                best_win = distance;
+                win_move = move;
+            }
+        } else if (distance > best_loss) {
+            best_loss = distance;
+            loss_move = move;
+        }
+    }
+
+    if (best_win >= 0) {
+        tb->distance[number] = (uint16_t) best_win;
+        tb->best_move[number] = (int16_t) win_move;
+    } else {
+        tb->distance[number] = (uint16_t) (best_loss < 0 ? 0 : best_loss); // Only the empty board has no move
+        tb->best_move[number] = (int16_t) loss_move;
+    }
+}
+
+/**
+ * @brief Solves every position of the current board configuration.
+ *
+ * @param tb The tablebase to fill, freed with tablebase_free().
+ * @return true if the tablebase was solved, false if the board has too many positions or memory ran out.
+ */
+bool
+tablebase_solve (tablebase *tb)
+{
+    memset(tb, 0, sizeof(*tb));
+    uint32_t num_positions = tablebase_num_positions(board_rows, board_cols);
+    if (num_positions > TABLEBASE_MAX_POSITIONS) {
+        return false;
+    }
+
+    tb->distance = malloc(num_positions * sizeof(uint16_t));
+    tb->best_move = malloc(num_positions * sizeof(int16_t));
+    if (tb->distance == NULL || tb->best_move == NULL) {
+        tablebase_free(tb);
+        return false;
+    }
+    tb->rows = board_rows;
+    tb->cols = board_cols;
+    tb->max_to_delete = num_max_to_delete;
+    tb->num_positions = num_positions;
+
+    // The positions are solved in the order of their ranks, every move leading to one already solved
+    chomp_profile profile;
+    memset(&profile, 0, sizeof(profile));
+    for (uint32_t number = 0; number < num_positions; number++) {
+        game_state state;
+        game_state_from_profile(&profile, &state);
+        solve_position(tb, &state, number);
+        staircase_next(&profile, board_rows, board_cols);
+    }
+    return true;
+}
+
+/**
+ * @brief Frees a tablebase and empties it.
+ *
+ * @param tb The tablebase.
+ */
+void
+tablebase_free (tablebase *tb)
+{
+    free(tb->distance);
+    free(tb->best_move);
+    memset(tb, 0, sizeof(*tb));
+}
+
+/**
+ * @brief Looks a position up in a tablebase.
+ *
+ * @param tb The tablebase.
+ * @param profile The position.
+ * @param result Where to store the result, distance and optimal move.
+ * @return true if the position was found, false if the tablebase is for another board.
+ */
+bool
+tablebase_probe (const tablebase *tb, const chomp_profile *profile, tablebase_result *result)
+{
+    if (tb->num_positions == 0 || tb->rows != board_rows || tb->cols != board_cols
+        || tb->max_to_delete != num_max_to_delete) {
+        return false;
+    }
+    if (profile->row_len[0] > tb->cols) {
+        return false;
+    }
+    uint32_t number = (uint32_t) staircase_rank(profile, tb->rows);
+    int move = tb->best_move[number];
+    result->distance = tb->distance[number];
+    result->won = result->distance % 2 == 0;
+    result->row = move == TABLEBASE_NO_MOVE ? -1 : move / COLS;
+    result->col = move == TABLEBASE_NO_MOVE ? -1 : move % COLS;
+    return true;
+}
+
+/**
+ * @brief Checks if the tablebase of the ai is solved for the current board.
+ *
+ * @return true if it is, false otherwise.
+ */
+static bool
+ai_tablebase_is_ready (void)
+{
+    return ai_tablebase.num_positions != 0 && ai_tablebase.rows == board_rows && ai_tablebase.cols == board_cols
+        && ai_tablebase.max_to_delete == num_max_to_delete;
+}
+
+/**
+ * @brief Solves the tablebase of the ai for the current board.
+ *
+ * The tablebase is kept until the board changes, so it is only solved again
+ * after a change of board.
+ *
+ * @return true if the tablebase of the current board is ready, false if the board is too large or memory is missing.
+ */
+bool
+tablebase_ai_prepare (void)
+{
+    if (ai_tablebase_is_ready()) {
+        return true;
+    }
+    tablebase_free(&ai_tablebase);
+    return tablebase_solve(&ai_tablebase);
+}
+
+/**
+ * @brief Chooses the move of the ai with the tablebase.
+ *
+ * Without a time budget, the tablebase of the current board is solved on
+ * the first call. With one, it is only read if tablebase_ai_prepare() solved
+ * it beforehand: solving a large board takes seconds, far more than a move
+ * may last.
+ *
+ * @param state The position.
+ * @param time_budget_ms The time the ai may think, in milliseconds, 0 for none.
+ * @param row Where to store the row of the move.
+ * @param col Where to store the column of the move.
+ * @return true if a move was found, false if the game is over, the board is too large or the tablebase is not solved in time.
+ */
+bool
+tablebase_ai_move (const game_state *state, int time_budget_ms, int *row, int *col)
+{
+    if (time_budget_ms > 0 && !ai_tablebase_is_ready()) {
+        return false; // The pattern engine plays until the tablebase is solved
+    }
+    if (!tablebase_ai_prepare()) {
+        return false;
+    }
+
+    tablebase_result result;
+    if (!tablebase_probe(&ai_tablebase, &state->profile, &result) || result.row < 0) {
+        return false;
+    }
+    *row = result.row;
+    *col = result.col;
+    return true;
+}
@@ -0,0 +1,505 @@
+/**
+ * @file tablebase_file.c
+ * @brief Implementation of the tablebase files.
+ *
+ * This file contains the writing of a solved tablebase, its compression by
+ * blocks, the mapping of a file in memory, the cache of the decoded blocks
+ * and the lookup of a position and of its optimal move.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "tablebase_file.h"
+#include "const.h"
+#include "profile.h"
+#include "game_state.h"
+#include "tablebase.h"
+#include "staircase.h"
+
+/**
+ * @def TABLEBASE_FILE_V1_HEADER_SIZE
+ * @brief Size of the header of a version 1 file, in bytes.
+ */
+#define TABLEBASE_FILE_V1_HEADER_SIZE 32
+
+/**
+ * @brief Writes an unsigned integer in little-endian order.
+ *
+ * @param buffer Where to write it.
+ * @param value The value.
+ */
+static void
+put_le32 (unsigned char *buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        buffer[i] = (unsigned char) (value >> (8 * i));
+    }
+}
+
+/**
+ * @brief Reads an unsigned integer written in little-endian order.
+ *
+ * @param buffer Where to read it.
+ * @return The value.
+ */
+static uint32_t
+get_le32 (const unsigned char *buffer)
+{
+    return (uint32_t) buffer[0] | (uint32_t) buffer[1] << 8 | (uint32_t) buffer[2] << 16 | (uint32_t) buffer[3] << 24;
+}
+
+/**
+ * @brief Reads the result of a position from a solved tablebase.
+ *
+ * @param tb The tablebase.
+ * @param number The number of the position.
+ * @return 1 if the player to move wins, 0 otherwise.
+ */
+static int
+solved_result (const tablebase *tb, uint32_t number)
+{
+    return tb->distance[number] % 2 == 0;
+}
+
+/**
+ * @brief Appends bits to a buffer, lowest bit first.
+ *
+ * @param buffer The buffer, zeroed beforehand.
+ * @param num_bits The number of bits already written, updated.
+ * @param value The bits to write.
+ * @param count The number of bits to write.
+ */
+static void
+put_bits (unsigned char *buffer, size_t *num_bits, uint32_t value, int count)
+{
+    for (int i = 0; i < count; i++, (*num_bits)++) {
+        buffer[*num_bits / 8] |= (unsigned char) (((value >> i) & 1) << (*num_bits % 8));
+    }
+}
+
+/**
+ * @brief Encodes a block of positions.
+ *
+ * The block starts with the rarer result, the Rice parameter k and the
+ * number of positions with the rarer result. Then comes the gap before each
+ * of them: the gap divided by 2^k in unary (ones ended by a zero) and its k
+ * low bits. The k giving the fewest bits is chosen.
+ *
+ * @param tb The tablebase.
+ * @param first The number of the first position of the block.
+ * @param count The number of positions of the block.
+ * @param buffer Where to write the block, at least TABLEBASE_BLOCK_POSITIONS / 8 + 4 bytes, zeroed.
+ * @return The size of the block, in bytes.
+ */
+static size_t
+encode_block (const tablebase *tb, uint32_t first, uint32_t count, unsigned char *buffer)
+{
+    uint32_t num_won = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        num_won += (uint32_t) solved_result(tb, first + i);
+    }
+    int rare = num_won <= count - num_won;
+    uint32_t num_rare = rare ? num_won : count - num_won;
+
+    // Bits of the gaps for every k: a gap g takes (g >> k) + 1 + k bits
+    uint64_t sizes[16] = {0};
+    uint32_t previous = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (solved_result(tb, first + i) == rare) {
+            for (int k = 0; k < 16; k++) {
+                sizes[k] += ((i - previous) >> k) + 1 + (uint64_t) k;
+            }
+            previous = i + 1;
+        }
+    }
+    int best_k = 0;
+    for (int k = 1; k < 16; k++) {
+        if (sizes[k] < sizes[best_k]) {
+            best_k = k;
+        }
+    }
+
+    buffer[0] = (unsigned char) rare;
+    buffer[1] = (unsigned char) best_k;
+    buffer[2] = (unsigned char) num_rare;
+    buffer[3] = (unsigned char) (num_rare >> 8);
+    size_t num_bits = 32;
+    previous = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (solved_result(tb, first + i) == rare) {
+            uint32_t gap = i - previous;
+            for (uint32_t q = gap >> best_k; q > 0; q--) {
+                put_bits(buffer, &num_bits, 1, 1);
+            }
+            put_bits(buffer, &num_bits, 0, 1);
+            put_bits(buffer, &num_bits, gap, best_k);
+            previous = i + 1;
+        }
+    }
+    return (num_bits + 7) / 8;
+}
+
+/**
+ * @brief Writes the blocks of a tablebase and their index.
+ *
+ * @param tb The tablebase.
+ * @param file The file, after the header.
+ * @return true if the blocks were written, false otherwise.
+ */
+static bool
+write_blocks (const tablebase *tb, FILE *file)
+{
+    uint32_t num_blocks = (tb->num_positions + TABLEBASE_BLOCK_POSITIONS - 1) / TABLEBASE_BLOCK_POSITIONS;
+    size_t max_block_size = TABLEBASE_BLOCK_POSITIONS / 8 + 4;
+    unsigned char *blocks = calloc(num_blocks, max_block_size);
+    unsigned char *block_index = malloc(((size_t) num_blocks + 1) * 4);
+    if (blocks == NULL || block_index == NULL) {
+        free(blocks);
+        free(block_index);
+        return false;
+    }
+
+    // The blocks are written one after the other, the index gives where each one starts
+    uint32_t offset = 0;
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        uint32_t first = b * TABLEBASE_BLOCK_POSITIONS;
+        uint32_t count = tb->num_positions - first < TABLEBASE_BLOCK_POSITIONS
+                       ? tb->num_positions - first : TABLEBASE_BLOCK_POSITIONS;
+        unsigned char *block = blocks + (size_t) b * max_block_size;
+        size_t size = encode_block(tb, first, count, block);
+        put_le32(block_index + 4 * (size_t) b, offset);
+        memmove(blocks + offset, block, size);
+        offset += (uint32_t) size;
+    }
+    put_le32(block_index + 4 * (size_t) num_blocks, offset);
+
+    bool written = fwrite(block_index, 4, (size_t) num_blocks + 1, file) == (size_t) num_blocks + 1
+                && fwrite(blocks, 1, offset, file) == offset;
+    free(blocks);
+    free(block_index);
+    return written;
+}
+
+/**
+ * @brief Writes a solved tablebase to a file.
+ *
+ * @param tb The tablebase.
+ * @param path The path of the file.
+ * @param compression TABLEBASE_COMPRESSION_NONE or TABLEBASE_COMPRESSION_RICE.
+ * @return true if the file was written, false otherwise.
+ */
+bool
+tablebase_file_write (const tablebase *tb, const char *path, int compression)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    unsigned char header[TABLEBASE_FILE_HEADER_SIZE] = {0};
+    memcpy(header, TABLEBASE_FILE_MAGIC, sizeof(TABLEBASE_FILE_MAGIC));
+    put_le32(header + 8, TABLEBASE_FILE_VERSION);
+    put_le32(header + 12, (uint32_t) tb->rows);
+    put_le32(header + 16, (uint32_t) tb->cols);
+    put_le32(header + 20, (uint32_t) tb->max_to_delete);
+    put_le32(header + 24, TABLEBASE_INDEX_LEXICOGRAPHIC);
+    put_le32(header + 28, tb->num_positions);
+    put_le32(header + 32, (uint32_t) compression);
+    put_le32(header + 36, compression == TABLEBASE_COMPRESSION_RICE ? TABLEBASE_BLOCK_POSITIONS : 0);
+    bool written = fwrite(header, sizeof(header), 1, file) == 1;
+
+    // The tablebase numbers its positions in the order of the lexicographic scheme
+    if (written && compression == TABLEBASE_COMPRESSION_RICE) {
+        written = write_blocks(tb, file);
+    }
+    for (uint32_t first = 0; written && compression == TABLEBASE_COMPRESSION_NONE && first < tb->num_positions; first += 8) {
+        unsigned char bits = 0;
+        for (uint32_t number = first; number < first + 8 && number < tb->num_positions; number++) {
+            bits |= (unsigned char) (solved_result(tb, number) << (number - first));
+        }
+        written = fputc(bits, file) != EOF;
+    }
+
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * @brief Maps a tablebase file in memory.
+ *
+ * Only the header is read, the results are loaded by the system when they
+ * are probed.
+ *
+ * @param file The tablebase file to fill, closed with tablebase_file_close().
+ * @param path The path of the file.
+ * @return true if the file is a valid tablebase, false otherwise.
+ */
+bool
+tablebase_file_open (tablebase_file *file, const char *path)
+{
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < TABLEBASE_FILE_V1_HEADER_SIZE) {
+        close(fd);
+        return false;
+    }
+    void *mapping = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid without the descriptor
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    file->mapping = mapping;
+    file->mapping_size = (size_t) info.st_size;
+
+    // Version 1 headers stop before the compression, their bits are not compressed
+    const unsigned char *header = mapping;
+    uint32_t version = get_le32(header + 8);
+    size_t header_size = version == 1 ? TABLEBASE_FILE_V1_HEADER_SIZE : TABLEBASE_FILE_HEADER_SIZE;
+    if (file->mapping_size < header_size) {
+        tablebase_file_close(file);
+        return false;
+    }
+    int rows = (int) get_le32(header + 12);
+    int cols = (int) get_le32(header + 16);
+    int max_to_delete = (int) get_le32(header + 20);
+    uint32_t num_positions = get_le32(header + 28);
+    uint32_t compression = version == 1 ? TABLEBASE_COMPRESSION_NONE : get_le32(header + 32);
+    uint32_t block_positions = version == 1 ? 0 : get_le32(header + 36);
+    if (memcmp(header, TABLEBASE_FILE_MAGIC, sizeof(TABLEBASE_FILE_MAGIC)) != 0
+        || (version != 1 && version != TABLEBASE_FILE_VERSION)
+        || get_le32(header + 24) != TABLEBASE_INDEX_LEXICOGRAPHIC
+        || rows < 1 || rows > ROWS || cols < 1 || cols > COLS || max_to_delete < 1
+        || num_positions != tablebase_num_positions(rows, cols)) {
+        tablebase_file_close(file);
+        return false;
+    }
+    file->data = header + header_size;
+    file->data_size = file->mapping_size - header_size;
+
+    bool valid = false;
+    if (compression == TABLEBASE_COMPRESSION_NONE) {
+        valid = file->data_size == ((size_t) num_positions + 7) / 8;
+    } else if (compression == TABLEBASE_COMPRESSION_RICE && block_positions > 0 && block_positions % 8 == 0
+               && block_positions <= TABLEBASE_BLOCK_POSITIONS * 16) {
+        // The blocks follow their index, whose last offset is the end of the last block
+        uint32_t num_blocks = (num_positions + block_positions - 1) / block_positions;
+        size_t index_size = ((size_t) num_blocks + 1) * 4;
+        valid = file->data_size >= index_size
+             && get_le32(file->data + index_size - 4) == file->data_size - index_size;
+        if (valid) {
+            file->block_index = file->data;
+            file->data += index_size;
+            file->data_size -= index_size;
+            file->num_blocks = num_blocks;
+            file->block_positions = block_positions;
+            file->cache_bits = malloc((size_t) TABLEBASE_CACHE_BLOCKS * (block_positions / 8));
+            valid = file->cache_bits != NULL;
+            for (int i = 0; i < TABLEBASE_CACHE_BLOCKS; i++) {
+                file->cache_block[i] = UINT32_MAX;
+            }
+        }
+    }
+    if (!valid) {
+        tablebase_file_close(file);
+        return false;
+    }
+
+    file->rows = rows;
+    file->cols = cols;
+    file->max_to_delete = max_to_delete;
+    file->num_positions = num_positions;
+    file->compression = (int) compression;
+    return true;
+}
+
+/**
+ * @brief Unmaps a tablebase file.
+ *
+ * @param file The tablebase file.
+ */
+void
+tablebase_file_close (tablebase_file *file)
+{
+    if (file->mapping != NULL) {
+        munmap(file->mapping, file->mapping_size);
+    }
+    free(file->cache_bits);
+    memset(file, 0, sizeof(*file));
+}
+
+/**
+ * @brief Decodes a block of positions.
+ *
+ * @param file The tablebase file.
+ * @param block The number of the block.
+ * @param bits Where to write the bits of the positions of the block.
+ * @return true if the block was decoded, false if it is corrupted.
+ */
+static bool
+decode_block (const tablebase_file *file, uint32_t block, unsigned char *bits)
+{
+    uint32_t begin = get_le32(file->block_index + 4 * (size_t) block);
+    uint32_t end = get_le32(file->block_index + 4 * ((size_t) block + 1));
+    uint32_t count = file->num_positions - block * file->block_positions < file->block_positions
+                   ? file->num_positions - block * file->block_positions : file->block_positions;
+    if (begin > end || end > file->data_size || end - begin < 4) {
+        return false;
+    }
+    const unsigned char *bytes = file->data + begin;
+    size_t size_bits = (size_t) (end - begin) * 8;
+    int rare = bytes[0] & 1;
+    int k = bytes[1];
+    uint32_t num_rare = (uint32_t) bytes[2] | (uint32_t) bytes[3] << 8;
+    if (k > 15 || num_rare > count) {
+        return false;
+    }
+
+    memset(bits, rare ? 0x00 : 0xff, file->block_positions / 8);
+    size_t bit = 32;
+    uint32_t position = 0;
+    for (uint32_t r = 0; r < num_rare; r++) {
+        uint32_t gap = 0;
+        while (bit < size_bits && ((bytes[bit / 8] >> (bit % 8)) & 1)) {
+            gap += 1u << k;
+            bit++;
+        }
+        if (bit + 1 + (size_t) k > size_bits) {
+            return false;
+        }
+        bit++; // The zero ending the unary part
+        for (int i = 0; i < k; i++, bit++) {
+            gap |= (uint32_t) ((bytes[bit / 8] >> (bit % 8)) & 1) << i;
+        }
+        position += gap;
+        if (position >= count) {
+            return false;
+        }
+        bits[position / 8] ^= (unsigned char) (1 << (position % 8));
+        position++;
+    }
+    return true;
+}
+
+/**
+ * @brief Finds the bits of a block in the cache, decoding it if it is not there.
+ *
+ * The entry used the longest time ago is replaced.
+ *
+ * @param file The tablebase file.
+ * @param block The number of the block.
+ * @return The bits of the positions of the block, NULL if it is corrupted.
+ */
+static const unsigned char *
+cached_block (tablebase_file *file, uint32_t block)
+{
+    size_t block_size = file->block_positions / 8;
+    int oldest = 0;
+    file->cache_clock++;
+    for (int i = 0; i < TABLEBASE_CACHE_BLOCKS; i++) {
+        if (file->cache_block[i] == block) {
+            file->cache_used[i] = file->cache_clock;
+            return file->cache_bits + i * block_size;
+        }
+        if (file->cache_used[i] < file->cache_used[oldest]) {
+            oldest = i;
+        }
+    }
+
+    unsigned char *bits = file->cache_bits + oldest * block_size;
+    file->blocks_decoded++;
+    if (!decode_block(file, block, bits)) {
+        file->cache_block[oldest] = UINT32_MAX;
+        file->cache_used[oldest] = 0;
+        return NULL;
+    }
+    file->cache_block[oldest] = block;
+    file->cache_used[oldest] = file->cache_clock;
+    return bits;
+}
+
+/**
+ * @brief Reads the result of a position from the mapping.
+ *
+ * @param file The tablebase file.
+ * @param profile The position.
+ * @return 1 if the player to move wins, 0 if they lose, -1 if its block is corrupted.
+ */
+static int
+file_result (tablebase_file *file, const chomp_profile *profile)
+{
+    uint32_t number = (uint32_t) staircase_rank(profile, file->rows);
+    const unsigned char *bits = file->data;
+    if (file->compression == TABLEBASE_COMPRESSION_RICE) {
+        bits = cached_block(file, number / file->block_positions);
+        if (bits == NULL) {
+            return -1;
+        }
+        number %= file->block_positions;
+    }
+    return (bits[number / 8] >> (number % 8)) & 1;
+}
+
+/**
+ * @brief Looks a position up in a tablebase file.
+ *
+ * The move is a winning one if there is one. Otherwise it is the legal
+ * move eating the fewest cells, the poisoned cell only if it is the last
+ * one.
+ *
+ * @param file The tablebase file.
+ * @param state The position.
+ * @param won Where to store true if the player to move wins.
+ * @param row Where to store the row of an optimal move, -1 if the game is over.
+ * @param col Where to store the column of an optimal move, -1 if the game is over.
+ * @return true if the position was found, false if the file is for another board or a block is corrupted.
+ */
+bool
+tablebase_file_probe (tablebase_file *file, const game_state *state, bool *won, int *row, int *col)
+{
+    if (file->num_positions == 0 || file->rows != board_rows || file->cols != board_cols
+        || file->max_to_delete != num_max_to_delete) {
+        return false;
+    }
+
+    static _Thread_local int possible_moves[ROWS * COLS][2];
+    int num_moves = game_state_legal_moves(state, possible_moves);
+    int fewest_cells = ROWS * COLS + 1;
+    int result = file_result(file, &state->profile);
+    if (result < 0) {
+        return false;
+    }
+    *won = result == 1;
+    *row = -1;
+    *col = -1;
+    for (int m = 0; m < num_moves; m++) {
+        if (*won) {
+            chomp_profile next = state->profile;
+            profile_delete_cells(&next, possible_moves[m][0], possible_moves[m][1]);
+            result = file_result(file, &next);
+            if (result < 0) {
+                return false;
+            }
+            if (result == 0) {
+                *row = possible_moves[m][0];
+                *col = possible_moves[m][1];
+                break;
+            }
+        } else {
+            int num_cells = profile_num_to_delete(&state->profile, possible_moves[m][0], possible_moves[m][1]);
+            if (num_cells <= fewest_cells) {
+                fewest_cells = num_cells;
+                *row = possible_moves[m][0];
+                *col = possible_moves[m][1];
+            }
+        }
+    }
+    return true;
+}
@@ -14,7 +14,8 @@
 #include "chomp.h"
 #include "const.h"
 #include "network.h"
-#include "ai.h"
+#include "game_state.h"
+#include "ai_engine.h"
 
 // ASCII art for the welcome screen
 const char *welcome_screen =
@@ -148,8 +149,8 @@ start_terminal_network (int socket, int player)
  * This function initializes the game table, displays the welcome screen, and 
  * allows the user to choose player names. It then enters a loop where it alternates 
  * between the player's turn and the AI's turn until the game is over. The player's 
- * turn involves input validation and cell deletion, while the AI's turn involves 
- * pattern detection and random moves. The game ends when the top-left cell of the 
+ * turn involves input validation and cell deletion, while the AI's turn plays 
+ * the move of the current ai engine. The game ends when the top-left cell of the 
  * table is deleted, and the final score and AI cheat count are displayed.
  *
  */
@@ -157,10 +158,12 @@ void
 start_terminal_ai ()
 {
     int table[ROWS][COLS];
+    game_state state; // Legal moves kept up to date for the AI
     int numb_tour = 0;
     bool game_over_flag = false;
     
     init_table(table);
+    game_state_init(&state);
     printf ("\033[1;33m%s\033[0m", welcome_screen);
 
     chose_players_names (true,true);
@@ -171,29 +174,15 @@ start_terminal_ai ()
             printf ("%s, it's your turn\n",  player1);
             bool user_move_ok = false;
             while(!user_move_ok){
-                int col_ok = 0;
                 int col_tmp;
                 int row_tmp;
                 char user_input[MAX_INPUT_SIZE + 1];
+                char last_cell[CELL_LABEL_SIZE];
+                format_cell(board_rows - 1, board_cols - 1, last_cell);
 
                 flush_and_trim_input(user_input, sizeof(user_input)); // Get user input
-                if (strlen(user_input) != 2) {
-                    printf("\033[1;31m\nInvalid input.\nInput must be exactly two characters.\033[0m\n");
-                    continue;
-                }
-                user_input[0] = toupper(user_input[0]); // Convert column to uppercase
-
-                for (int j = 0; j < COLS; j++) {
-                    if (user_input[0] == translate[j][0]) {
-                        col_tmp = j;
-                        col_ok = 1;
-                        break;
-                    }
-                }
-                row_tmp = user_input[1] - '0' - 1; // Convert row to integer
-
-                if (col_ok == 0 || row_tmp < 0 || row_tmp >= ROWS) {
-                    printf("\033[1;31m\nInvalid input.\n%s is not in the range A1 to I7.\033[0m\n", user_input);
+                if (!parse_cell(user_input, &row_tmp, &col_tmp)) {
+                    printf("\033[1;31m\nInvalid input.\n%s is not in the range A1 to %s.\033[0m\n", user_input, last_cell);
                     continue;
                 }
                 if (is_this_cell_1_or_0(table, row_tmp, col_tmp) == 1) {
@@ -201,43 +190,21 @@ start_terminal_ai ()
                     continue;
                 }
 
-                if (calculate_num_to_delete(table, row_tmp, col_tmp) <= NUM_MAX_TO_DELETE) {
+                if (calculate_num_to_delete(table, row_tmp, col_tmp) <= num_max_to_delete) {
                     row = row_tmp;
                     col = col_tmp;
                     delete_cells(table, row, col); // Delete selected cells
+                    game_state_apply_move(&state, row, col);
                     user_move_ok = true;
                 } else {
-                    printf("\033[1;31m\nInvalid input.\nYou can delete at most 5 cells.\033[0m\n");
+                    printf("\033[1;31m\nInvalid input.\nYou can delete at most %d cells.\033[0m\n", num_max_to_delete);
                 }
             }
         } else {
             printf ("Waiting for the AI to make it's move\n");
-            if (!detect_pattern(table)) {
-                int (*possible_moves)[2] = calculate_possibility(table);
-                int move_index = 0;
-                while (possible_moves[move_index][0] != -1 || possible_moves[move_index][1] != -1) {
-                    move_index++;
-                }
-                if (move_index > 1) {
-                    int random_index = rand() % move_index;
-                    int i = 0;
-                    while (possible_moves[random_index+i][0]==0 && possible_moves[random_index+i][1]==0) {
-                        i++;
-                    }
-                    row = possible_moves[random_index+i][0];
-                    col = possible_moves[random_index+i][1];
-                    delete_cells(table, row, col);
-                } else if (move_index == 1) {
-                    row = 0;
-                    col = 0;
-                    delete_cells(table,row,col);
-                }
-            } else {
-                int move = pattern_move(table); //TODO CHECK IF VALID MOVE
-                row = move/COLS;
-                col = move%COLS;
-                delete_cells(table, row, col);
-            }
+            ai_engine_move(&state, ai_time_budget, &row, &col); // The game is not over, there is a move
+            delete_cells(table, row, col);
+            game_state_apply_move(&state, row, col);
         }
 
         print_table(table, col, row);
@@ -285,8 +252,10 @@ start_terminal_network_ai (int socket, int player)
     int move = 0; // Variable to store the move
     int current_player = 1; // Variable to track the current player
     bool game_over_flag = false; // Flag to indicate if the game is over
+    game_state state; // Legal moves kept up to date for the AI
 
     init_table (table); // Initialize the game table
+    game_state_init (&state);
     // Display the welcome screen in yellow
     printf ("\033[1;33m%s\033[0m", welcome_screen);
 
@@ -301,51 +270,12 @@ start_terminal_network_ai (int socket, int player)
 
             while(!ai_move_ok) {
                 //sleep(1);
-                if (!detect_pattern(table)) {
-                    int (*possible_moves)[2] = calculate_possibility(table);
-                    int move_index = 0;
-                    while (possible_moves[move_index][0] != -1 || possible_moves[move_index][1] != -1) {
-                        move_index++;
-                    }
-
-                    if (move_index > 1) {
-                        int random_index = rand() % move_index;
-                        int i = 0;
-                        while (possible_moves[random_index+i][0]==0 && possible_moves[random_index+i][1]==0){
-                            i++;
-                        }
-                        row = possible_moves[random_index+i][0];
-                        col = possible_moves[random_index+i][1];
-
-
-
-                        if(make_ai_move_network(table, row*COLS+col, socket)){
-                            ai_move_ok = true;
-                        } else {
-
-                            continue;
-                        }                   
-                    } else if (move_index == 1){
-                        row = 0;
-                        col = 0;
-
-                        if(make_ai_move_network(table, row*COLS+col, socket)){
-                            ai_move_ok = true;
-                        } else {
-
-                            continue;
-                        }    
-                    }
-                } else {
-                    int move = pattern_move(table); //TODO CHECK IF VALID MOVE
-                    row = move/COLS;
-                    col = move%COLS;
-                    if(make_ai_move_network(table, move, socket)){ // Function to make a move
-                        ai_move_ok = true;
-                    } else {
-
-                        continue;
-                    }    
+                // The opponent waits for the move, so the AI always thinks within a time budget
+                int time_budget = (ai_time_budget != AI_NO_TIME_LIMIT) ? ai_time_budget : AI_NETWORK_TIME_BUDGET;
+                ai_engine_move(&state, time_budget, &row, &col); // The game is not over, there is a move
+                if(make_ai_move_network(table, row*board_cols+col, socket)){ // Function to make a move
+                    game_state_apply_move(&state, row, col);
+                    ai_move_ok = true;
                 }
             }
 
@@ -354,7 +284,12 @@ start_terminal_network_ai (int socket, int player)
             printf("Waiting for the other player to make a move\n");
             // Wait for the other player to make a move
 
+            ai_ponder_start(&state); // The AI searches its replies while the other player thinks
             handle_client_move(socket, table, move, &game_over_flag); // Handle the move from the other player
+            ai_ponder_stop(); // What the AI found is kept for its reply
+            if (!game_over_flag) {
+                game_state_apply_move(&state, last_row_played_term_serv, last_col_played_term_serv);
+            }
         }
         print_table(table, last_col_played_term_serv, last_row_played_term_serv); // Print the game table
         current_player = (current_player == 1) ? 2 : 1; // Switch the current player
@@ -8,10 +8,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "gestion_user.h"
 #include "chomp.h"
 #include "const.h"
 #include "ai.h"
+#include "bitboard.h"
+#include "profile.h"
+#include "game_state.h"
+#include "playout.h"
+#include "corner_board.h"
+#include "analysis.h"
+#include "search.h"
+#include "mcts.h"
+#include "ai_engine.h"
+#include "deadline.h"
+#include "book.h"
+#include "tablebase.h"
+#include "default_tablebase.h"
+#include "tablebase_file.h"
+#include "staircase.h"
 
 
 /**
@@ -305,7 +321,10 @@ test_row_line_pattern()
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (row_line_pattern(table)) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (row_line_pattern(&profile)) {
         printf("the row line pattern is correctly recognized\n");
         return true;
     } else {
@@ -327,7 +346,10 @@ test_col_line_pattern()
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (col_line_pattern(table)) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (col_line_pattern(&profile)) {
         printf("the col line pattern is correctly recognized\n");
         return true;
     } else {
@@ -349,7 +371,10 @@ test_square_pattern()
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (square_pattern(table)) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (square_pattern(&profile)) {
         printf("the square pattern is correctly recognized\n");
         return true;
     } else {
@@ -371,7 +396,10 @@ test_row_rectangle_pattern()
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (row_rectangle_pattern(table)) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (row_rectangle_pattern(&profile)) {
         printf("the row rectangle pattern is correctly recognized\n");
         return true;
     } else {
@@ -393,7 +421,10 @@ test_col_rectangle_pattern()
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (col_rectangle_pattern(table)) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (col_rectangle_pattern(&profile)) {
         printf("the col rectangle pattern is correctly recognized\n");
         return true;
     } else {
@@ -415,7 +446,10 @@ test_corner_pattern()
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (corner_pattern(table)) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (corner_pattern(&profile)) {
         printf("the corner pattern is correctly recognized\n");
         return true;
     } else {
@@ -432,12 +466,15 @@ test_gun_pattern()
         {1, 1, 1, 1, 0, 0, 0, 0, 0},
         {1, 1, 0, 0, 0, 0, 0, 0, 0},
         {1, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
+        {1, 0, 0, 0, 0, 0, 0, 0, 0},
+        {1, 0, 0, 0, 0, 0, 0, 0, 0},
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (gun_pattern(table)) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (gun_pattern(&profile)) {
         printf("the gun pattern is correctly recognized\n");
         return true;
     } else {
@@ -459,7 +496,10 @@ test_row_rectangle_strategy()
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (row_rectangle_strategy(table) == 5) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (row_rectangle_strategy(&profile) == 5) {
         printf("the row rectangle strategy is correct\n");
         return true;
     } else {
@@ -481,7 +521,10 @@ test_col_rectangle_strategy()
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (col_rectangle_strategy(table) == 45) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (col_rectangle_strategy(&profile) == 45) {
         printf("the col rectangle strategy is correct\n");
         return true;
     } else {
@@ -503,7 +546,10 @@ test_corner_strategy()
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (corner_strategy(table) == 4) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (corner_strategy(&profile) == 4) {
         printf("the corner strategy is correct\n");
         return true;
     } else {
@@ -520,16 +566,1825 @@ test_gun_strategy()
         {1, 1, 1, 1, 0, 0, 0, 0, 0},
         {1, 1, 0, 0, 0, 0, 0, 0, 0},
         {1, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
-        {0, 0, 0, 0, 0, 0, 0, 0, 0},
+        {1, 0, 0, 0, 0, 0, 0, 0, 0},
+        {1, 0, 0, 0, 0, 0, 0, 0, 0},
         {0, 0, 0, 0, 0, 0, 0, 0, 0}
     };
 
-    if (gun_strategy(table) == 12) {
+    board_profile profile;
+    board_profile_from_table(table, &profile);
+
+    if (gun_strategy(&profile) == 10) {
         printf("the gun strategy is correct\n");
         return true;
     } else {
         printf("the gun strategy is not correct\n");
         return false;
     }
-}
\ No newline at end of file
+}
+bool
+test_bitboard_engine()
+{
+    bitboard board = bitboard_full();
+    int table[ROWS][COLS];
+
+    srand(42);
+    while (board != 0) {
+        bitboard_to_table(board, table);
+        if (bitboard_from_table(table) != board) {
+            printf("the bitboard conversion is not correct\n");
+            return false;
+        }
+        /// compare every deletion count with a plain walk of the quadrant
+        for (int i = 0; i < board_rows; i++) {
+            for (int j = 0; j < board_cols; j++) {
+                int expected = 0;
+                for (int k = i; k < board_rows; k++) {
+                    for (int l = j; l < board_cols; l++) {
+                        expected += table[k][l];
+                    }
+                }
+                if (bitboard_num_to_delete(board, i, j) != expected || calculate_num_to_delete(table, i, j) != expected) {
+                    printf("the bitboard deletion count is not correct\n");
+                    return false;
+                }
+            }
+        }
+        bitboard legal = bitboard_legal_moves(board);
+        int num_legal = __builtin_popcountll(legal);
+        int random_index = rand() % num_legal;
+        while (random_index-- > 0) {
+            legal &= legal - 1;
+        }
+        int index = __builtin_ctzll(legal);
+        board = bitboard_delete_cells(board, index / board_cols, index % board_cols);
+        delete_cells(table, index / board_cols, index % board_cols);
+        if (bitboard_from_table(table) != board) {
+            printf("the bitboard move is not correct\n");
+            return false;
+        }
+    }
+    printf("the bitboard engine is correct\n");
+    return true;
+}
+
+bool
+test_profile_engine()
+{
+    chomp_profile profile;
+    int table[ROWS][COLS];
+    bitboard board = bitboard_full();
+
+    profile_init(&profile);
+    srand(7);
+    while (board != 0) {
+        /// every query must agree with the bitboard engine
+        for (int i = 0; i < board_rows; i++) {
+            for (int j = 0; j < board_cols; j++) {
+                int expected = bitboard_num_to_delete(board, i, j);
+                bool expected_legal = bitboard_is_cell_set(board, i, j) && expected <= num_max_to_delete;
+                if (profile_num_to_delete(&profile, i, j) != expected || profile_is_legal_move(&profile, i, j) != expected_legal) {
+                    printf("the profile deletion count is not correct\n");
+                    return false;
+                }
+            }
+        }
+        for (int j = 0; j < board_cols; j++) {
+            int col_len = 0;
+            while (col_len < board_rows && bitboard_is_cell_set(board, col_len, j)) {
+                col_len++;
+            }
+            if (profile_col_len(&profile, j) != col_len) {
+                printf("the profile column length is not correct\n");
+                return false;
+            }
+        }
+        profile_to_table(&profile, table);
+        chomp_profile round_trip;
+        profile_from_table(table, &round_trip);
+        if (bitboard_from_table(table) != board || !profile_equal(&profile, &round_trip) || profile_num_cells(&profile) != __builtin_popcountll(board)) {
+            printf("the profile conversion is not correct\n");
+            return false;
+        }
+
+        bitboard legal = bitboard_legal_moves(board);
+        int random_index = rand() % __builtin_popcountll(legal);
+        while (random_index-- > 0) {
+            legal &= legal - 1;
+        }
+        int index = __builtin_ctzll(legal);
+        board = bitboard_delete_cells(board, index / board_cols, index % board_cols);
+        profile_delete_cells(&profile, index / board_cols, index % board_cols);
+    }
+    printf("the profile engine is correct\n");
+    return true;
+}
+
+bool
+test_board_config()
+{
+    if (set_board_config(0, 9, 5) || set_board_config(7, COLS + 1, 5) || set_board_config(7, 9, 0)) {
+        printf("the board config accepts invalid dimensions\n");
+        return false;
+    }
+
+    int size_rows, size_cols, limit;
+    if (!parse_board_size("7x9", &size_rows, &size_cols) || size_rows != 7 || size_cols != 9
+        || !parse_max_to_delete("5", &limit) || limit != 5
+        || parse_board_size("7x9junk", &size_rows, &size_cols) || parse_board_size("7x", &size_rows, &size_cols)
+        || parse_board_size("x9", &size_rows, &size_cols) || parse_board_size("7x 9", &size_rows, &size_cols)
+        || parse_max_to_delete("5abc", &limit) || parse_max_to_delete("", &limit)
+        || parse_max_to_delete("99999999999", &limit)
+        || !parse_count("2000", 0, &limit) || limit != 2000 || !parse_count("0", 0, &limit) || limit != 0
+        || parse_count("0", 1, &limit) || parse_count("10ms", 0, &limit) || parse_count("abc", 0, &limit)
+        || parse_count("-1", 0, &limit)) {
+        printf("the board config arguments are not parsed correctly\n");
+        return false;
+    }
+
+    /// 12x20 does not fit in a bitboard, the int table and the profile must still agree
+    int rows[] = {12, 1, 8};
+    int cols[] = {20, 64, 8};
+    int limits[] = {7, 3, 5};
+    for (int config = 0; config < 3; config++) {
+        set_board_config(rows[config], cols[config], limits[config]);
+        char label[CELL_LABEL_SIZE];
+        int row, col;
+        format_cell(board_rows - 1, board_cols - 1, label);
+        if (!parse_cell(label, &row, &col) || row != board_rows - 1 || col != board_cols - 1) {
+            printf("the cell labels are not correct\n");
+            set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+            return false;
+        }
+
+        int table[ROWS][COLS];
+        chomp_profile profile;
+        init_table(table);
+        profile_init(&profile);
+        srand(11);
+        while (table[0][0] == 1) {
+            int (*possible_moves)[2] = calculate_possibility(table);
+            int num_moves = 0;
+            for (int i = 0; i < board_rows; i++) {
+                for (int j = 0; j < board_cols; j++) {
+                    bool legal = table[i][j] == 1 && calculate_num_to_delete(table, i, j) <= num_max_to_delete;
+                    if (calculate_num_to_delete(table, i, j) != profile_num_to_delete(&profile, i, j) || legal != profile_is_legal_move(&profile, i, j)) {
+                        printf("the board config deletion count is not correct\n");
+                        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                        return false;
+                    }
+                    num_moves += legal;
+                }
+            }
+            int listed = 0;
+            while (possible_moves[listed][0] != -1) {
+                listed++;
+            }
+            if (listed != num_moves) {
+                printf("the board config move list is not correct\n");
+                set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                return false;
+            }
+            int move = rand() % num_moves;
+            delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+            profile_delete_cells(&profile, possible_moves[move][0], possible_moves[move][1]);
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    printf("the board config is correct\n");
+    return true;
+}
+
+bool
+test_all_num_to_delete()
+{
+    int table[ROWS][COLS];
+    int counts[ROWS][COLS];
+    uint64_t legal[ROWS];
+
+    /// the matrix must match a plain walk of every quadrant, on the default board and on a big one
+    srand(5);
+    for (int config = 0; config < 2; config++) {
+        if (config == 1) {
+            set_board_config(20, 30, 9);
+        }
+        init_table(table);
+        while (table[0][0] == 1) {
+            calculate_all_num_to_delete(table, counts, legal);
+            for (int i = 0; i < board_rows; i++) {
+                for (int j = 0; j < board_cols; j++) {
+                    int expected = 0;
+                    for (int k = i; k < board_rows; k++) {
+                        for (int l = j; l < board_cols; l++) {
+                            expected += table[k][l];
+                        }
+                    }
+                    bool expected_legal = table[i][j] == 1 && expected <= num_max_to_delete;
+                    if (counts[i][j] != expected || (bool) ((legal[i] >> j) & 1) != expected_legal) {
+                        printf("the deletion count matrix is not correct\n");
+                        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                        return false;
+                    }
+                }
+            }
+            int possible_moves[ROWS * COLS][2];
+            int num_moves = calculate_possible_moves(table, possible_moves);
+            int move = rand() % num_moves;
+            delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    printf("the deletion count matrix is correct\n");
+    return true;
+}
+
+bool
+test_game_state()
+{
+    int table[ROWS][COLS];
+    int counts[ROWS][COLS];
+    uint64_t legal[ROWS];
+    static int possible_moves[ROWS * COLS][2];
+    game_state state;
+
+    /// the incremental legal moves must match a full rescan after every move
+    srand(3);
+    for (int config = 0; config < 3; config++) {
+        if (config == 1) {
+            set_board_config(12, 20, 7);
+        } else if (config == 2) {
+            set_board_config(30, 3, 2);
+        }
+        init_table(table);
+        game_state_init(&state);
+        while (table[0][0] == 1) {
+            calculate_all_num_to_delete(table, counts, legal);
+            int num_moves = game_state_legal_moves(&state, possible_moves);
+            int expected = 0;
+            for (int i = 0; i < board_rows; i++) {
+                expected += __builtin_popcountll(legal[i]);
+                for (int j = 0; j < board_cols; j++) {
+                    if (game_state_is_legal_move(&state, i, j) != (bool) ((legal[i] >> j) & 1)) {
+                        printf("the game state legal moves are not correct\n");
+                        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                        return false;
+                    }
+                }
+            }
+            if (num_moves != expected || state.num_legal_moves != expected) {
+                printf("the game state move count is not correct\n");
+                set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                return false;
+            }
+            int move = rand() % num_moves;
+            delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+            game_state_apply_move(&state, possible_moves[move][0], possible_moves[move][1]);
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    printf("the game state is correct\n");
+    return true;
+}
+
+/**
+ * @brief Plays random games with calculate_possible_moves() and checks every
+ * move list against a game state.
+ *
+ * @param arg Pointer to the random seed of the thread, followed by its result.
+ * @return NULL
+ */
+void*
+possible_moves_thread_func(void* arg)
+{
+    unsigned int *seed = arg;
+    unsigned int *result = seed + 1;
+    int table[ROWS][COLS];
+    int possible_moves[ROWS * COLS][2];
+    int expected_moves[ROWS * COLS][2];
+    game_state state;
+
+    for (int game = 0; game < 200; game++) {
+        init_table(table);
+        game_state_init(&state);
+        while (table[0][0] == 1) {
+            int num_moves = calculate_possible_moves(table, possible_moves);
+            if (num_moves != game_state_legal_moves(&state, expected_moves)
+                || memcmp(possible_moves, expected_moves, num_moves * sizeof(possible_moves[0])) != 0) {
+                *result = 0;
+                return NULL;
+            }
+            *seed = *seed * 1103515245u + 12345u; /// rand() is not thread safe, use a private generator
+            int move = (*seed >> 16) % num_moves;
+            delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+            game_state_apply_move(&state, possible_moves[move][0], possible_moves[move][1]);
+        }
+    }
+    return NULL;
+}
+
+bool
+test_possible_moves_threads()
+{
+    pthread_t threads[4];
+    unsigned int seeds[4][2]; /// seed and result of each thread
+
+    /// every thread generates its moves at the same time, on a board that does and one that does not fit in a bitboard
+    for (int config = 0; config < 2; config++) {
+        if (config == 1) {
+            set_board_config(10, 16, 6);
+        }
+        for (int i = 0; i < 4; i++) {
+            seeds[i][0] = i + 1;
+            seeds[i][1] = 1;
+            pthread_create(&threads[i], NULL, possible_moves_thread_func, seeds[i]);
+        }
+        for (int i = 0; i < 4; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        for (int i = 0; i < 4; i++) {
+            if (seeds[i][1] == 0) {
+                printf("the possible moves are not correct when generated from several threads\n");
+                set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                return false;
+            }
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    printf("the possible moves are correct when generated from several threads\n");
+    return true;
+}
+
+bool
+test_make_unmake_move()
+{
+    int possible_moves[ROWS * COLS][2];
+    game_state history[DEFAULT_ROWS * DEFAULT_COLS + 1];
+    game_state_undo undo;
+    if (!game_state_undo_init(&undo, DEFAULT_ROWS * DEFAULT_COLS)) {
+        printf("the undo stack could not be created\n");
+        return false;
+    }
+
+    srand(9);
+    for (int game = 0; game < 100; game++) {
+        game_state state;
+        game_state_init(&state);
+        int num_moves = 0;
+        history[0] = state;
+        /// play a whole game, each move must match game_state_apply_move
+        while (state.profile.row_len[0] > 0) {
+            int count = game_state_legal_moves(&state, possible_moves);
+            int move = rand() % count;
+            game_state expected = state;
+            game_state_apply_move(&expected, possible_moves[move][0], possible_moves[move][1]);
+            game_state_make_move(&state, possible_moves[move][0], possible_moves[move][1], &undo);
+            if (memcmp(&state, &expected, sizeof(state)) != 0) {
+                printf("the make move is not correct\n");
+                game_state_undo_free(&undo);
+                return false;
+            }
+            history[++num_moves] = state;
+        }
+        /// take every move back and check each position on the way
+        while (num_moves > 0) {
+            game_state_unmake_move(&state, &undo);
+            if (memcmp(&state, &history[--num_moves], sizeof(state)) != 0) {
+                printf("the unmake move is not correct\n");
+                game_state_undo_free(&undo);
+                return false;
+            }
+        }
+        if (undo.num_moves != 0 || undo.num_saved != 0) {
+            printf("the undo stack is not empty\n");
+            game_state_undo_free(&undo);
+            return false;
+        }
+    }
+    game_state_undo_free(&undo);
+    printf("the make and unmake moves are correct\n");
+    return true;
+}
+
+bool
+test_playout_batch()
+{
+    bitboard boards[50];
+    bool wins[50];
+    int rows[] = {DEFAULT_ROWS, 8, 4, 1};
+    int cols[] = {DEFAULT_COLS, 8, 16, 64};
+    int limits[] = {DEFAULT_NUM_MAX_TO_DELETE, 9, 2, 70};
+
+    /// every lane must play the same game as the scalar playout with the same generator
+    for (int config = 0; config < 4; config++) {
+        set_board_config(rows[config], cols[config], limits[config]);
+        srand(13);
+        for (int i = 0; i < 50; i++) {
+            boards[i] = bitboard_full();
+            for (int k = rand() % 4; k > 0 && (boards[i] & 1); k--) {
+                bitboard legal = bitboard_legal_moves(boards[i]);
+                int index = __builtin_ctzll(legal);
+                boards[i] = bitboard_delete_cells(boards[i], index / board_cols, index % board_cols);
+            }
+        }
+        playout_batch(boards, 50, 1234, wins);
+        for (int i = 0; i < 50; i++) {
+            uint64_t rng = 1234 + (uint64_t) (i + 1) * UINT64_C(0x9e3779b97f4a7c15);
+            rng = (rng ^ (rng >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+            rng = (rng ^ (rng >> 27)) * UINT64_C(0x94d049bb133111eb);
+            rng = (rng ^ (rng >> 31)) | 1;
+            if (playout_scalar(boards[i], &rng) != wins[i]) {
+                printf("the batch playouts are not correct\n");
+                set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                return false;
+            }
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    printf("the batch playouts are correct\n");
+    return true;
+}
+
+bool
+test_corner_board()
+{
+    int table[ROWS][COLS];
+    int expected[ROWS][COLS];
+    int possible_moves[ROWS * COLS][2];
+    static int64_t corner_moves[ROWS * COLS][2];
+    int rows[] = {DEFAULT_ROWS, 12, 1, 30};
+    int cols[] = {DEFAULT_COLS, 12, 40, 5};
+    int limits[] = {DEFAULT_NUM_MAX_TO_DELETE, 20, 3, 8};
+    corner_board board;
+
+    /// on small boards every move must match the dense engine
+    srand(21);
+    for (int config = 0; config < 4; config++) {
+        set_board_config(rows[config], cols[config], limits[config]);
+        for (int game = 0; game < 20; game++) {
+            game_state state;
+            game_state_init(&state);
+            init_table(table);
+            if (!corner_board_init(&board, board_rows, board_cols, num_max_to_delete)) {
+                printf("the corner board is not correct\n");
+                set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                return false;
+            }
+            while (table[0][0] == 1) {
+                int count = game_state_legal_moves(&state, possible_moves);
+                int64_t corner_count = corner_board_legal_moves(&board, corner_moves, ROWS * COLS);
+                bool correct = corner_count == count && corner_board_num_cells(&board) == profile_num_cells(&state.profile);
+                for (int k = 0; correct && k < count; k++) {
+                    correct = corner_moves[k][0] == possible_moves[k][0] && corner_moves[k][1] == possible_moves[k][1];
+                }
+                for (int k = 0; correct && k < 10; k++) {
+                    int i = rand() % board_rows;
+                    int j = rand() % board_cols;
+                    correct = corner_board_num_to_delete(&board, i, j) == calculate_num_to_delete(table, i, j)
+                              && corner_board_col_len(&board, j) == profile_col_len(&state.profile, j)
+                              && corner_board_row_len(&board, i) == state.profile.row_len[i];
+                }
+                corner_board_to_table(&board, expected);
+                if (!correct || memcmp(table, expected, sizeof(table)) != 0) {
+                    printf("the corner board is not correct\n");
+                    corner_board_free(&board);
+                    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                    return false;
+                }
+                /// mostly legal moves, sometimes any cell to cut several corners at once
+                int i = possible_moves[rand() % count][0];
+                int j = possible_moves[rand() % count][1];
+                if (rand() % 4 == 0) {
+                    i = rand() % board_rows;
+                    j = rand() % board_cols;
+                }
+                if (table[i][j] == 1) {
+                    delete_cells(table, i, j);
+                    game_state_from_table(table, &state);
+                    corner_board_delete_cells(&board, i, j);
+                }
+            }
+            corner_board_free(&board);
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+
+    /// a game on a 100000 x 100000 board only keeps its corners
+    if (!corner_board_init(&board, 100000, 100000, DEFAULT_NUM_MAX_TO_DELETE)) {
+        printf("the corner board is not correct on a giant board\n");
+        return false;
+    }
+    int64_t num_cells = corner_board_num_cells(&board);
+    for (int move = 0; move < 20000 && corner_board_num_cells(&board) > 0; move++) {
+        int64_t i, j;
+        if (move % 100 == 99) {
+            i = ((int64_t) rand() * 7919) % 100000;
+            j = ((int64_t) rand() * 104729) % 100000;
+        } else {
+            int64_t count = corner_board_legal_moves(&board, corner_moves, ROWS * COLS);
+            int64_t index = rand() % (count < ROWS * COLS ? count : ROWS * COLS);
+            i = corner_moves[index][0];
+            j = corner_moves[index][1];
+            if (!corner_board_is_legal_move(&board, i, j)) {
+                printf("the corner board is not correct on a giant board\n");
+                corner_board_free(&board);
+                return false;
+            }
+        }
+        num_cells -= corner_board_num_to_delete(&board, i, j);
+        corner_board_delete_cells(&board, i, j);
+        if (corner_board_num_cells(&board) != num_cells) {
+            printf("the corner board is not correct on a giant board\n");
+            corner_board_free(&board);
+            return false;
+        }
+    }
+    corner_board_free(&board);
+    printf("the corner board is correct\n");
+    return true;
+}
+
+bool
+test_analysis()
+{
+    static int tables[300][ROWS][COLS];
+    static chomp_profile profiles[300];
+    static position_analysis results[300];
+    static position_analysis profile_results[300];
+    static int counts[300][ROWS][COLS];
+    int expected_counts[ROWS][COLS];
+    uint64_t expected_legal[ROWS];
+    int possible_moves[ROWS * COLS][2];
+
+    /// positions from random games, the first one full and the last one over
+    srand(17);
+    init_table(tables[0]);
+    for (int k = 1; k < 300; k++) {
+        memcpy(tables[k], tables[k - 1], sizeof(tables[k]));
+        if (tables[k][0][0] == 0 || rand() % 40 == 0) {
+            init_table(tables[k]);
+        }
+        int count = calculate_possible_moves(tables[k], possible_moves);
+        int move = rand() % count;
+        delete_cells(tables[k], possible_moves[move][0], possible_moves[move][1]);
+    }
+    delete_cells(tables[299], 0, 0);
+    for (int k = 0; k < 300; k++) {
+        profile_from_table(tables[k], &profiles[k]);
+    }
+
+    /// every result must match the single position functions, with and without threads
+    for (int num_threads = 1; num_threads <= 4; num_threads += 3) {
+        analyse_tables(tables, 300, results, counts, num_threads);
+        analyse_profiles(profiles, 300, profile_results, NULL, num_threads);
+        for (int k = 0; k < 300; k++) {
+            position_analysis *result = &results[k];
+            calculate_all_num_to_delete(tables[k], expected_counts, expected_legal);
+            bool correct = memcmp(result, &profile_results[k], sizeof(*result)) == 0
+                           && memcmp(result->legal, expected_legal, board_rows * sizeof(uint64_t)) == 0
+                           && result->num_legal_moves == calculate_possible_moves(tables[k], possible_moves);
+            for (int i = 0; correct && i < board_rows; i++) {
+                correct = memcmp(counts[k][i], expected_counts[i], board_cols * sizeof(int)) == 0;
+            }
+            if (correct && tables[k][0][0] == 0) {
+                correct = result->move_row == -1 && result->pattern == NO_PATTERN;
+            } else if (correct) {
+                correct = (result->legal[result->move_row] >> result->move_col) & 1;
+                int move;
+                if (correct && find_pattern(tables[k], &move) != NO_PATTERN) {
+                    correct = result->move_row == move / board_cols && result->move_col == move % board_cols;
+                } else if (correct) {
+                    correct = result->pattern == NO_PATTERN;
+                }
+            }
+            if (!correct) {
+                printf("the batch analysis is not correct\n");
+                return false;
+            }
+        }
+    }
+
+    /// with a deletion limit of 1 the poisoned cell is often illegal, every recommended move must still be legal
+    int configs[][2] = {{3, 3}, {5, 6}, {DEFAULT_ROWS, DEFAULT_COLS}};
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+        set_board_config(configs[c][0], configs[c][1], 1);
+        chomp_profile profile;
+        memset(&profile, 0, sizeof(profile));
+        while (staircase_next(&profile, board_rows, board_cols)) {
+            position_analysis result;
+            analyse_profiles(&profile, 1, &result, NULL, 1);
+            if (!((result.legal[result.move_row] >> result.move_col) & 1)) {
+                set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                printf("the batch analysis is not correct\n");
+                return false;
+            }
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    printf("the batch analysis is correct\n");
+    return true;
+}
+
+bool
+test_corner_analysis()
+{
+    int table[ROWS][COLS];
+    int possible_moves[ROWS * COLS][2];
+    int configs[][3] = {{DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE}, {5, 6, 1}, {5, 6, 3}, {3, 10, 2}, {6, 4, 8}};
+    corner_board board;
+    corner_analysis result;
+    bool correct = true;
+
+    /// every position of small boards gets the pattern and the move of find_pattern, or a legal move
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]) && correct; c++) {
+        set_board_config(configs[c][0], configs[c][1], configs[c][2]);
+        chomp_profile profile;
+        memset(&profile, 0, sizeof(profile));
+        do {
+            profile_to_table(&profile, table);
+            correct = corner_board_from_table(table, &board) && analyse_corner_board(&board, &result);
+            if (correct && profile.row_len[0] == 0) {
+                correct = result.move_row == -1 && result.pattern == NO_PATTERN && result.num_cells == 0;
+            } else if (correct) {
+                int move = -1;
+                chomp_pattern pattern = find_pattern(table, &move);
+                correct = result.pattern == pattern && result.num_legal_moves == calculate_possible_moves(table, possible_moves)
+                          && result.num_cells == profile_num_cells(&profile)
+                          && corner_board_is_legal_move(&board, result.move_row, result.move_col)
+                          && (pattern == NO_PATTERN || (result.move_row == move / board_cols && result.move_col == move % board_cols));
+            }
+            corner_board_free(&board);
+        } while (correct && staircase_next(&profile, board_rows, board_cols));
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+
+    /// boards of 10^5 x 10^5 cells: a full board, a corner whose move evens its arms, and a line
+    if (correct) {
+        correct = corner_board_init(&board, 100000, 100000, 5) && analyse_corner_board(&board, &result)
+                  && result.num_cells == INT64_C(10000000000) && result.num_corners == 1 && result.pattern == NO_PATTERN
+                  && corner_board_is_legal_move(&board, result.move_row, result.move_col);
+        correct = correct && corner_board_delete_cells(&board, 1, 1) && corner_board_delete_cells(&board, 0, 99995)
+                  && analyse_corner_board(&board, &result) && result.pattern == CORNER_PATTERN
+                  && corner_board_is_legal_move(&board, result.move_row, result.move_col)
+                  && corner_board_delete_cells(&board, result.move_row, result.move_col)
+                  && (corner_board_row_len(&board, 0) - 1) % 6 == (corner_board_col_len(&board, 0) - 1) % 6;
+        corner_board_free(&board);
+    }
+    if (correct) {
+        correct = corner_board_init(&board, 1, 100000, 5) && analyse_corner_board(&board, &result)
+                  && result.pattern == ROW_LINE_PATTERN && result.move_row == 0 && result.move_col == 100000 - 99999 % 6;
+        corner_board_free(&board);
+    }
+
+    if (!correct) {
+        printf("the corner analysis is not correct\n");
+        return false;
+    }
+    printf("the corner analysis is correct\n");
+    return true;
+}
+
+bool
+test_board_profile()
+{
+    int table[ROWS][COLS];
+    int possible_moves[ROWS * COLS][2];
+    board_profile profile;
+    int rows[] = {DEFAULT_ROWS, 3, 12};
+    int cols[] = {DEFAULT_COLS, 20, 6};
+
+    /// every field must match the count read from the table
+    srand(23);
+    for (int config = 0; config < 3; config++) {
+        set_board_config(rows[config], cols[config], DEFAULT_NUM_MAX_TO_DELETE);
+        for (int game = 0; game < 50; game++) {
+            init_table(table);
+            while (table[0][0] == 1) {
+                board_profile_from_table(table, &profile);
+                int num_cells_inside = 0;
+                for (int i = 1; i < board_rows; i++) {
+                    for (int j = 1; j < board_cols; j++) {
+                        num_cells_inside += table[i][j];
+                    }
+                }
+                bool correct = profile.cols == board_cols && profile.max_to_delete == num_max_to_delete
+                               && profile.num_cells_inside == num_cells_inside;
+                for (int k = 0; correct && k < 2; k++) {
+                    correct = profile.row_len[k] == (k < board_rows ? number_of_cells_in_row(table, k) : 0)
+                              && profile.col_len[k] == (k < board_cols ? number_of_cells_in_col(table, k) : 0);
+                }
+                if (!correct) {
+                    printf("the board profile is not correct\n");
+                    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                    return false;
+                }
+                int count = calculate_possible_moves(table, possible_moves);
+                int move = rand() % count;
+                delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+            }
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    printf("the board profile is correct\n");
+    return true;
+}
+
+bool
+test_find_pattern()
+{
+    int table[ROWS][COLS];
+    int possible_moves[ROWS * COLS][2];
+    board_profile profile;
+    bool (*patterns[])(const board_profile *) = {row_line_pattern, col_line_pattern, square_pattern, row_rectangle_pattern,
+                                                  col_rectangle_pattern, corner_pattern, gun_pattern};
+    int64_t (*strategies[])(const board_profile *) = {row_line_strategy, col_line_strategy, square_strategy, row_rectangle_strategy,
+                                                   col_rectangle_strategy, corner_strategy, gun_strategy};
+    int limits[] = {DEFAULT_NUM_MAX_TO_DELETE, 3, 8};
+    static pattern_cache cache;
+
+    /// the same positions on boards that only differ by their limit must not share their cache entries
+    srand(29);
+    for (int game = 0; game < 300; game++) {
+        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+        init_table(table);
+        while (table[0][0] == 1) {
+            for (int config = 0; config < 3; config++) {
+                set_board_config(DEFAULT_ROWS, DEFAULT_COLS, limits[config]);
+                board_profile_from_table(table, &profile);
+                chomp_pattern expected = NO_PATTERN;
+                int expected_move = -1;
+                for (int k = 0; k < 7 && expected == NO_PATTERN; k++) {
+                    if (patterns[k](&profile)) {
+                        int move = strategies[k](&profile);
+                        int i = move / board_cols;
+                        int j = move % board_cols;
+                        if (i < board_rows && table[i][j] == 1 && calculate_num_to_delete(table, i, j) <= num_max_to_delete) {
+                            expected = (chomp_pattern) (k + 1);
+                            expected_move = move;
+                        } else {
+                            k = 7;
+                        }
+                    }
+                }
+                /// the table lookup, then the row lengths lookups, the second one from the cache
+                chomp_profile position;
+                profile_from_table(table, &position);
+                for (int lookup = 0; lookup < 3; lookup++) {
+                    int move = -1;
+                    chomp_pattern pattern = lookup == 0 ? find_pattern(table, &move) : find_pattern_profile(&position, &move, &cache);
+                    if (pattern != expected || move != expected_move) {
+                        printf("the pattern dispatch is not correct\n");
+                        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                        return false;
+                    }
+                }
+            }
+            set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+            int count = calculate_possible_moves(table, possible_moves);
+            int move = rand() % count;
+            delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    printf("the pattern dispatch is correct\n");
+    return true;
+}
+
+/// exhaustive search memo, open addressing on the hash of the row lengths
+static struct {
+    chomp_profile key;
+    signed char won; /// 0 if empty, 1 if the player to move wins, -1 otherwise
+} solver_memo[1 << 16];
+
+/**
+ * @brief Solves a position by trying every legal move.
+ *
+ * @param state The position.
+ * @return true if the player to move wins.
+ */
+static bool
+solve_by_search(const game_state *state)
+{
+    if (state->profile.row_len[0] == 0) {
+        return true; /// the opponent ate the poisoned cell
+    }
+    size_t index = profile_hash(&state->profile) % (1 << 16);
+    while (solver_memo[index].won != 0 && !profile_equal(&solver_memo[index].key, &state->profile)) {
+        index = (index + 1) % (1 << 16);
+    }
+    if (solver_memo[index].won != 0) {
+        return solver_memo[index].won > 0;
+    }
+    bool won = false;
+    for (int i = 0; i < board_rows && !won; i++) {
+        for (int j = state->first_legal[i]; j < state->profile.row_len[i] && !won; j++) {
+            game_state next = *state;
+            game_state_apply_move(&next, i, j);
+            won = !solve_by_search(&next);
+        }
+    }
+    /// the recursion may have filled the slot
+    while (solver_memo[index].won != 0 && !profile_equal(&solver_memo[index].key, &state->profile)) {
+        index = (index + 1) % (1 << 16);
+    }
+    solver_memo[index].key = state->profile;
+    solver_memo[index].won = won ? 1 : -1;
+    return won;
+}
+
+bool
+test_endgame_solvers()
+{
+    int table[ROWS][COLS];
+    bool (*patterns[])(const board_profile *) = {row_line_pattern, row_rectangle_pattern, col_line_pattern, col_rectangle_pattern, corner_pattern};
+    int64_t (*strategies[])(const board_profile *) = {row_line_strategy, row_rectangle_strategy, col_line_strategy, col_rectangle_strategy, corner_strategy};
+
+    /// every two rows, two columns and corner position, checked against the exhaustive search
+    for (int limit = 1; limit <= 8; limit++) {
+        set_board_config(32, 32, limit);
+        memset(solver_memo, 0, sizeof(solver_memo));
+        for (int a = 1; a <= 32; a++) {
+            for (int b = 0; b <= a; b++) {
+                for (int shape = 0; shape < 3; shape++) {
+                    chomp_profile position;
+                    memset(&position, 0, sizeof(position));
+                    int family;
+                    if (shape == 0) { /// two rows of a and b cells
+                        position.row_len[0] = a;
+                        position.row_len[1] = b;
+                        family = b == 0 ? 0 : 1;
+                    } else if (shape == 1) { /// two columns of a and b cells
+                        for (int i = 0; i < a; i++) {
+                            position.row_len[i] = i < b ? 2 : 1;
+                        }
+                        family = b == 0 ? 2 : 3;
+                    } else { /// a row of a cells and a column of b cells
+                        if (a < 2 || b < 2) {
+                            continue;
+                        }
+                        position.row_len[0] = a;
+                        for (int i = 1; i < b; i++) {
+                            position.row_len[i] = 1;
+                        }
+                        family = 4;
+                    }
+                    board_profile profile;
+                    game_state state;
+                    profile_to_table(&position, table);
+                    board_profile_from_table(table, &profile);
+                    game_state_from_table(table, &state);
+
+                    bool won = solve_by_search(&state);
+                    bool correct = patterns[family](&profile) == won;
+                    if (correct && won) {
+                        int move = strategies[family](&profile);
+                        correct = game_state_is_legal_move(&state, move / board_cols, move % board_cols);
+                        if (correct) {
+                            game_state_apply_move(&state, move / board_cols, move % board_cols);
+                            correct = !solve_by_search(&state);
+                        }
+                    }
+                    if (!correct) {
+                        printf("the end game solvers are not correct\n");
+                        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                        return false;
+                    }
+                }
+            }
+        }
+
+        /// every corner of arms up to 10 cells with at most limit cells inside: a gun must be won by its move
+        int num_guns = 0;
+        for (int a = 2; a <= 10; a++) {
+            for (int b = 2; b <= 10; b++) {
+                int inside_rows = b - 1 < limit ? b - 1 : limit;
+                int inside_cols = a - 1 < limit ? a - 1 : limit;
+                chomp_profile inside;
+                memset(&inside, 0, sizeof(inside));
+                while (staircase_next(&inside, inside_rows, inside_cols)) {
+                    chomp_profile position;
+                    memset(&position, 0, sizeof(position));
+                    int num_inside = 0;
+                    position.row_len[0] = a;
+                    for (int i = 1; i < b; i++) {
+                        position.row_len[i] = 1 + (i <= inside_rows ? inside.row_len[i - 1] : 0);
+                        num_inside += position.row_len[i] - 1;
+                    }
+                    if (num_inside > limit) {
+                        continue;
+                    }
+                    board_profile profile;
+                    game_state state;
+                    profile_to_table(&position, table);
+                    board_profile_from_table(table, &profile);
+                    game_state_from_table(table, &state);
+                    if (!gun_pattern(&profile)) {
+                        continue;
+                    }
+                    num_guns++;
+                    int move = gun_strategy(&profile);
+                    bool correct = solve_by_search(&state) && game_state_is_legal_move(&state, move / board_cols, move % board_cols);
+                    if (correct) {
+                        game_state_apply_move(&state, move / board_cols, move % board_cols);
+                        correct = !solve_by_search(&state);
+                    }
+                    if (!correct) {
+                        printf("the end game solvers are not correct\n");
+                        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+                        return false;
+                    }
+                }
+            }
+        }
+        if (num_guns == 0) {
+            printf("the end game solvers are not correct\n");
+            set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+            return false;
+        }
+    }
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    printf("the end game solvers are correct\n");
+    return true;
+}
+
+bool
+test_search()
+{
+    int table[ROWS][COLS];
+    int possible_moves[ROWS * COLS][2];
+    search_engine engine;
+    if (!search_engine_init(&engine, 16, 1)) {
+        printf("the search engine is not correct\n");
+        return false;
+    }
+    int configs[][3] = {{4, 4, 2}, {5, 6, 3}, {6, 5, 4}, {DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE}};
+    bool correct = true;
+
+    /// random positions of random games, the result and the move checked against the exhaustive search
+    for (int c = 0; c < 4 && correct; c++) {
+        set_board_config(configs[c][0], configs[c][1], configs[c][2]);
+        memset(solver_memo, 0, sizeof(solver_memo));
+        for (int game = 0; game < 20 && correct; game++) {
+            init_table(table);
+            while (table[0][0] == 1 && correct) {
+                game_state state;
+                game_state_from_table(table, &state);
+                search_result result = search_best_move(&engine, &state, 0, 0);
+                bool won = solve_by_search(&state);
+                correct = (won ? result.score >= SEARCH_WIN_SCORE - SEARCH_MAX_PLY : result.score <= SEARCH_MAX_PLY - SEARCH_WIN_SCORE)
+                          && game_state_is_legal_move(&state, result.row, result.col);
+                if (correct && won) {
+                    game_state next = state;
+                    game_state_apply_move(&next, result.row, result.col);
+                    correct = !solve_by_search(&next);
+                }
+                /// a shallow search still plays a legal move
+                search_result shallow = search_best_move(&engine, &state, 2, 0);
+                correct = correct && shallow.depth <= 2 && game_state_is_legal_move(&state, shallow.row, shallow.col);
+
+                int count = calculate_possible_moves(table, possible_moves);
+                int move = rand() % count;
+                delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+            }
+        }
+    }
+    search_engine_free(&engine);
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the search engine is not correct\n");
+        return false;
+    }
+    printf("the search engine is correct\n");
+    return true;
+}
+
+bool
+test_parallel_search()
+{
+    int table[ROWS][COLS];
+    int possible_moves[ROWS * COLS][2];
+    search_engine serial;
+    search_engine parallel;
+    if (!search_engine_init(&serial, 16, 1)) {
+        printf("the parallel search is not correct\n");
+        return false;
+    }
+    if (!search_engine_init(&parallel, 16, 4)) {
+        search_engine_free(&serial);
+        printf("the parallel search is not correct\n");
+        return false;
+    }
+    int configs[][3] = {{5, 6, 3}, {DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE}, {8, 8, 4}};
+    bool correct = true;
+
+    /// the threads must find the same result as a single thread and a winning move
+    for (int c = 0; c < 3 && correct; c++) {
+        set_board_config(configs[c][0], configs[c][1], configs[c][2]);
+        memset(solver_memo, 0, sizeof(solver_memo));
+        for (int game = 0; game < 5 && correct; game++) {
+            init_table(table);
+            search_engine_clear(&parallel); /// start each game with an empty shared table
+            while (table[0][0] == 1 && correct) {
+                game_state state;
+                game_state_from_table(table, &state);
+                search_result expected = search_best_move(&serial, &state, 0, 0);
+                search_result result = search_best_move(&parallel, &state, 0, 0);
+                bool proven = result.score >= SEARCH_WIN_SCORE - SEARCH_MAX_PLY || result.score <= SEARCH_MAX_PLY - SEARCH_WIN_SCORE;
+                correct = proven && (result.score > 0) == (expected.score > 0)
+                          && game_state_is_legal_move(&state, result.row, result.col);
+                if (correct && result.score > 0) {
+                    game_state next = state;
+                    game_state_apply_move(&next, result.row, result.col);
+                    correct = !solve_by_search(&next);
+                }
+
+                int count = calculate_possible_moves(table, possible_moves);
+                int move = rand() % count;
+                delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+            }
+        }
+    }
+    search_engine_free(&serial);
+    search_engine_free(&parallel);
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the parallel search is not correct\n");
+        return false;
+    }
+    printf("the parallel search is correct\n");
+    return true;
+}
+
+bool
+test_mcts()
+{
+    int table[ROWS][COLS];
+    int possible_moves[ROWS * COLS][2];
+    mcts_engine engine;
+    mcts_engine parallel;
+    if (!mcts_engine_init(&engine, 1 << 16, 1, 42)) {
+        printf("the monte-carlo engine is not correct\n");
+        return false;
+    }
+    if (!mcts_engine_init(&parallel, 1 << 16, 3, 7)) {
+        mcts_engine_free(&engine);
+        printf("the monte-carlo engine is not correct\n");
+        return false;
+    }
+    bool correct = true;
+    int won_positions = 0;
+    int winning_moves = 0;
+
+    /// random positions of random games, a legal move, proofs agreeing with the exhaustive search and mostly winning moves
+    int configs[][3] = {{5, 6, 3}, {DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE}};
+    for (int c = 0; c < 2 && correct; c++) {
+        set_board_config(configs[c][0], configs[c][1], configs[c][2]);
+        memset(solver_memo, 0, sizeof(solver_memo));
+        for (int game = 0; game < 4 && correct; game++) {
+            init_table(table);
+            while (table[0][0] == 1 && correct) {
+                game_state state;
+                game_state_from_table(table, &state);
+                mcts_engine *used = game % 2 == 0 ? &engine : &parallel; /// one tree, or one tree per thread
+                mcts_result result = mcts_best_move(used, &state, 3000, 0);
+                bool won = solve_by_search(&state);
+                correct = game_state_is_legal_move(&state, result.row, result.col);
+                if (correct && won) {
+                    game_state next = state;
+                    game_state_apply_move(&next, result.row, result.col);
+                    bool winning = !solve_by_search(&next);
+                    won_positions += c == 0; /// 3000 iterations only suffice to play well on the small board
+                    winning_moves += c == 0 && winning;
+                    correct = result.proven >= 0 && (result.proven == 0 || winning);
+                } else if (correct) {
+                    correct = result.proven <= 0;
+                }
+
+                int count = calculate_possible_moves(table, possible_moves);
+                int move = rand() % count;
+                delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+            }
+        }
+    }
+    correct = correct && winning_moves * 10 >= won_positions * 9;
+
+    /// the tree of the last search is kept for the position reached by its move, not for an unrelated one
+    if (correct) {
+        set_board_config(5, 6, 3);
+        game_state state;
+        init_table(table);
+        game_state_from_table(table, &state);
+        mcts_result first = mcts_best_move(&engine, &state, 3000, 0);
+        game_state next = state;
+        game_state_apply_move(&next, first.row, first.col);
+        mcts_result kept = mcts_best_move(&engine, &next, 0, 0);
+        set_board_config(6, 5, 3);
+        init_table(table);
+        game_state_from_table(table, &state);
+        mcts_result fresh = mcts_best_move(&engine, &state, 0, 0);
+        correct = kept.visits > 0 && game_state_is_legal_move(&next, kept.row, kept.col)
+                  && fresh.visits == 0 && game_state_is_legal_move(&state, fresh.row, fresh.col);
+    }
+
+    /// a board too large for a bitboard still gets a legal move
+    if (correct) {
+        set_board_config(20, 20, 5);
+        game_state state;
+        init_table(table);
+        game_state_from_table(table, &state);
+        mcts_result result = mcts_best_move(&parallel, &state, 200, 0);
+        correct = result.visits > 0 && game_state_is_legal_move(&state, result.row, result.col);
+    }
+
+    mcts_engine_free(&engine);
+    mcts_engine_free(&parallel);
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the monte-carlo engine is not correct (%d winning moves out of %d)\n", winning_moves, won_positions);
+        return false;
+    }
+    printf("the monte-carlo engine is correct\n");
+    return true;
+}
+
+bool
+test_ai_engines()
+{
+    int table[ROWS][COLS];
+    int possible_moves[ROWS * COLS][2];
+    const ai_engine *saved_engine = current_ai_engine;
+    int saved_iterations = mcts_iterations;
+    bool correct = ai_engine_find("no such engine") == NULL;
+    mcts_iterations = 2000;
+    set_board_config(5, 6, 3);
+    memset(solver_memo, 0, sizeof(solver_memo));
+
+    /// every engine plays through the common interface: a legal move, never the poisoned cell if there is another one
+    for (int e = 0; e < num_ai_engines && correct; e++) {
+        current_ai_engine = &ai_engines[e];
+        correct = ai_engine_find(ai_engines[e].name) == &ai_engines[e];
+        for (int game = 0; game < 5 && correct; game++) {
+            init_table(table);
+            while (table[0][0] == 1 && correct) {
+                game_state state;
+                game_state_from_table(table, &state);
+                int row = -1;
+                int col = -1;
+                correct = ai_engine_move(&state, AI_NO_TIME_LIMIT, &row, &col)
+                          && game_state_is_legal_move(&state, row, col)
+                          && (row != 0 || col != 0 || state.num_legal_moves == 1);
+                /// the solver and the tablebase always find a winning move
+                if (correct && (strcmp(ai_engines[e].name, "solver") == 0 || strcmp(ai_engines[e].name, "perfect") == 0)
+                    && solve_by_search(&state)) {
+                    game_state next = state;
+                    game_state_apply_move(&next, row, col);
+                    correct = !solve_by_search(&next);
+                }
+
+                int count = calculate_possible_moves(table, possible_moves);
+                int move = rand() % count;
+                delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+            }
+        }
+    }
+
+    /// no move once the game is over
+    if (correct) {
+        game_state state;
+        int row;
+        int col;
+        game_state_init(&state);
+        game_state_apply_move(&state, 0, 0);
+        correct = !ai_engine_move(&state, AI_NO_TIME_LIMIT, &row, &col);
+    }
+
+    current_ai_engine = saved_engine;
+    mcts_iterations = saved_iterations;
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the ai engines are not correct\n");
+        return false;
+    }
+    printf("the ai engines are correct\n");
+    return true;
+}
+
+bool
+test_anytime_search()
+{
+    int table[ROWS][COLS];
+    search_engine serial;
+    search_engine parallel;
+    mcts_engine mcts;
+    if (!search_engine_init(&serial, 16, 1)) {
+        printf("the anytime search is not correct\n");
+        return false;
+    }
+    if (!search_engine_init(&parallel, 16, 4)) {
+        search_engine_free(&serial);
+        printf("the anytime search is not correct\n");
+        return false;
+    }
+    if (!mcts_engine_init(&mcts, 1 << 16, 2, 3)) {
+        search_engine_free(&serial);
+        search_engine_free(&parallel);
+        printf("the anytime search is not correct\n");
+        return false;
+    }
+    bool correct = true;
+
+    /// on a board far too large to solve, the engines answer close to the deadline with a legal move
+    set_board_config(40, 40, 6);
+    init_table(table);
+    game_state state;
+    game_state_from_table(table, &state);
+    search_engine *engines[2] = {&serial, &parallel};
+    for (int e = 0; e < 2 && correct; e++) {
+        uint64_t start = current_time_ms();
+        search_result result = search_best_move(engines[e], &state, 0, 100);
+        uint64_t elapsed = current_time_ms() - start;
+        correct = elapsed < 600 && result.depth >= 1 && game_state_is_legal_move(&state, result.row, result.col);
+    }
+    if (correct) {
+        uint64_t start = current_time_ms();
+        mcts_result result = mcts_best_move(&mcts, &state, 1000000000, 100);
+        uint64_t elapsed = current_time_ms() - start;
+        correct = elapsed < 600 && result.visits > 0 && game_state_is_legal_move(&state, result.row, result.col);
+    }
+
+    /// a budget large enough changes nothing: the result is still proven
+    if (correct) {
+        set_board_config(5, 6, 3);
+        init_table(table);
+        game_state_from_table(table, &state);
+        search_engine_clear(&serial);
+        search_result result = search_best_move(&serial, &state, 0, 60000);
+        correct = result.score >= SEARCH_WIN_SCORE - SEARCH_MAX_PLY || result.score <= SEARCH_MAX_PLY - SEARCH_WIN_SCORE;
+    }
+
+    /// the levels set the budgets of the engines, from the easiest
+    if (correct) {
+        int saved_budget = ai_time_budget;
+        int saved_depth = search_depth;
+        int saved_iterations = mcts_iterations;
+        const ai_level *easy = ai_level_find("easy");
+        const ai_level *expert = ai_level_find("expert");
+        correct = easy == &ai_levels[0] && expert != NULL && ai_level_find("impossible") == NULL;
+        if (correct) {
+            ai_level_apply(easy);
+            correct = ai_time_budget == easy->time_budget_ms && search_depth == easy->depth && mcts_iterations == easy->iterations
+                      && easy->time_budget_ms < expert->time_budget_ms;
+        }
+        ai_time_budget = saved_budget;
+        search_depth = saved_depth;
+        mcts_iterations = saved_iterations;
+    }
+
+    search_engine_free(&serial);
+    search_engine_free(&parallel);
+    mcts_engine_free(&mcts);
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the anytime search is not correct\n");
+        return false;
+    }
+    printf("the anytime search is correct\n");
+    return true;
+}
+
+bool
+test_pondering()
+{
+    int table[ROWS][COLS];
+    const ai_engine *saved_engine = current_ai_engine;
+    int saved_iterations = mcts_iterations;
+    bool correct = true;
+    mcts_iterations = 2000;
+
+    /// every engine that can ponder starts and stops, then plays a legal reply
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    for (int e = 0; e < num_ai_engines && correct; e++) {
+        current_ai_engine = &ai_engines[e];
+        game_state state;
+        init_table(table);
+        game_state_from_table(table, &state);
+        game_state_apply_move(&state, DEFAULT_ROWS - 1, DEFAULT_COLS - 1);
+        correct = ai_ponder_start(&state) == (ai_engines[e].ponder != NULL);
+        uint64_t start = current_time_ms();
+        while (current_time_ms() - start < 20) {
+            /// the opponent thinks
+        }
+        ai_ponder_stop();
+        game_state_apply_move(&state, DEFAULT_ROWS - 1, DEFAULT_COLS - 2);
+        int row = -1;
+        int col = -1;
+        correct = correct && ai_engine_move(&state, AI_NO_TIME_LIMIT, &row, &col) && game_state_is_legal_move(&state, row, col);
+    }
+
+    /// nothing to ponder once the game is over
+    if (correct) {
+        game_state state;
+        game_state_init(&state);
+        game_state_apply_move(&state, 0, 0);
+        correct = !ai_ponder_start(&state);
+    }
+
+    /// pondering a board far too large to solve stops quickly
+    if (correct) {
+        set_board_config(40, 40, 6);
+        current_ai_engine = ai_engine_find("solver");
+        game_state state;
+        init_table(table);
+        game_state_from_table(table, &state);
+        correct = ai_ponder_start(&state);
+        uint64_t start = current_time_ms();
+        while (current_time_ms() - start < 50) {
+            /// the opponent thinks
+        }
+        start = current_time_ms();
+        ai_ponder_stop();
+        correct = correct && current_time_ms() - start < 500;
+    }
+
+    /// the reply is found with fewer positions once the position of the opponent was searched
+    if (correct) {
+        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+        search_engine fresh = {0}; // Freed even if only one of them is set up
+        search_engine pondered = {0};
+        if (search_engine_init(&fresh, 18, 1) && search_engine_init(&pondered, 18, 1)) {
+            game_state state;
+            init_table(table);
+            game_state_from_table(table, &state);
+            game_state_apply_move(&state, DEFAULT_ROWS - 1, DEFAULT_COLS - 1);
+            atomic_bool stop;
+            atomic_init(&stop, false);
+            pondered.stop = &stop;
+            search_best_move(&pondered, &state, 0, 0);
+            pondered.stop = NULL;
+            game_state_apply_move(&state, 5, 7);
+            search_best_move(&fresh, &state, 0, 0);
+            search_best_move(&pondered, &state, 0, 0);
+            correct = pondered.nodes < fresh.nodes;
+        } else {
+            correct = false;
+        }
+        search_engine_free(&fresh);
+        search_engine_free(&pondered);
+    }
+
+    current_ai_engine = saved_engine;
+    mcts_iterations = saved_iterations;
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the pondering is not correct\n");
+        return false;
+    }
+    printf("the pondering is correct\n");
+    return true;
+}
+
+bool
+test_opening_book()
+{
+    static int possible_moves[ROWS * COLS][2];
+    static int next_moves[ROWS * COLS][2];
+    const char *path = "test_book.bin";
+    const ai_engine *saved_engine = current_ai_engine;
+    opening_book book;
+    opening_book loaded;
+    bool correct = true;
+    memset(&loaded, 0, sizeof(loaded));
+
+    /// the book of a small board holds a winning move for every won position of the first 3 plies
+    set_board_config(5, 6, 3);
+    memset(solver_memo, 0, sizeof(solver_memo));
+    correct = book_build(&book, 3, 0, 0, 2) && book.num_entries > 1;
+    game_state start;
+    game_state_init(&start);
+    int num_moves = game_state_legal_moves(&start, possible_moves);
+    for (int m = -1; m < num_moves && correct; m++) {
+        game_state state = start;
+        if (m >= 0) {
+            game_state_apply_move(&state, possible_moves[m][0], possible_moves[m][1]);
+        }
+        int num_next = m >= 0 ? game_state_legal_moves(&state, next_moves) : 0;
+        for (int n = -1; n < num_next && correct; n++) {
+            game_state position = state;
+            if (n >= 0) {
+                game_state_apply_move(&position, next_moves[n][0], next_moves[n][1]);
+            }
+            if (position.profile.row_len[0] == 0) {
+                continue;
+            }
+            int row = -1;
+            int col = -1;
+            correct = book_lookup(&book, &position, &row, &col) && game_state_is_legal_move(&position, row, col);
+            if (correct && solve_by_search(&position)) {
+                game_state next = position;
+                game_state_apply_move(&next, row, col);
+                correct = !solve_by_search(&next);
+            }
+        }
+    }
+
+    /// the book read back from its file is the same, and the ai plays from it whatever the engine
+    if (correct) {
+        correct = book_save(&book, path) && book_load(&loaded, path)
+            && loaded.num_entries == book.num_entries && loaded.plies == 3;
+        for (uint32_t i = 0; i < book.num_entries && correct; i++) {
+            correct = loaded.entries[i].key == book.entries[i].key && loaded.entries[i].move == book.entries[i].move
+                && loaded.entries[i].result == book.entries[i].result;
+        }
+        if (correct) {
+            int row = -1;
+            int col = -1;
+            int book_row = -1;
+            int book_col = -1;
+            ai_book = loaded;
+            current_ai_engine = ai_engine_find("random");
+            correct = ai_engine_move(&start, AI_NO_TIME_LIMIT, &row, &col)
+                && book_lookup(&book, &start, &book_row, &book_col) && row == book_row && col == book_col;
+            memset(&ai_book, 0, sizeof(ai_book));
+        }
+        book_free(&loaded);
+    }
+
+    /// a book is not used on another board
+    if (correct) {
+        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+        int row = -1;
+        int col = -1;
+        game_state_init(&start);
+        correct = !book_lookup(&book, &start, &row, &col);
+    }
+
+    /// a truncated file or a missing file is not a book
+    if (correct) {
+        unsigned char bytes[40]; /// the header and part of the first entry
+        FILE *file = fopen(path, "rb");
+        correct = file != NULL && fread(bytes, 1, sizeof(bytes), file) == sizeof(bytes);
+        if (file != NULL) {
+            fclose(file);
+        }
+        file = correct ? fopen(path, "wb") : NULL;
+        correct = file != NULL && fwrite(bytes, 1, sizeof(bytes), file) == sizeof(bytes);
+        if (file != NULL) {
+            fclose(file);
+        }
+        correct = correct && !book_load(&loaded, path);
+        remove(path);
+        correct = correct && !book_load(&loaded, path);
+    }
+
+    book_free(&book);
+    current_ai_engine = saved_engine;
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the opening book is not correct\n");
+        return false;
+    }
+    printf("the opening book is correct\n");
+    return true;
+}
+
+bool
+test_staircase_rank()
+{
+    int boards[][2] = {{DEFAULT_ROWS, DEFAULT_COLS}, {1, 8}, {8, 1}, {5, 6}, {6, 5}, {1, 1}};
+    bool correct = staircase_count(7, 9) == 11440 && staircase_count(1, 1) == 2 && staircase_count(ROWS, 0) == 1
+        && staircase_count(32, 32) == UINT64_C(1832624140942590534) && staircase_count(ROWS, COLS) == STAIRCASE_TOO_MANY
+        && staircase_binomials[3][5] == 0;
+
+    /// every position of a small board has its own rank, in lexicographic order, and is found back from it
+    for (size_t b = 0; b < sizeof(boards) / sizeof(boards[0]) && correct; b++) {
+        int rows = boards[b][0];
+        int cols = boards[b][1];
+        chomp_profile profile;
+        chomp_profile unranked;
+        memset(&profile, 0, sizeof(profile));
+        uint64_t rank = 0;
+        do {
+            staircase_unrank(rank, rows, cols, &unranked);
+            correct = staircase_rank(&profile, rows) == rank && memcmp(&unranked, &profile, sizeof(profile)) == 0;
+            rank++;
+        } while (correct && staircase_next(&profile, rows, cols));
+        correct = correct && rank == staircase_count(rows, cols) && profile.row_len[rows - 1] == cols;
+    }
+
+    /// the ranks of random positions of large boards are dense and found back
+    srand(17);
+    int large_boards[][2] = {{32, 32}, {ROWS, 3}, {2, COLS}, {30, 34}};
+    for (size_t b = 0; b < sizeof(large_boards) / sizeof(large_boards[0]) && correct; b++) {
+        int rows = large_boards[b][0];
+        int cols = large_boards[b][1];
+        for (int k = 0; k < 1000 && correct; k++) {
+            chomp_profile profile;
+            chomp_profile unranked;
+            memset(&profile, 0, sizeof(profile));
+            int len = cols;
+            for (int i = 0; i < rows; i++) {
+                len = rand() % 4 == 0 ? rand() % (len + 1) : len;
+                profile.row_len[i] = (unsigned char) len;
+            }
+            uint64_t rank = staircase_rank(&profile, rows);
+            staircase_unrank(rank, rows, cols, &unranked);
+            correct = rank < staircase_count(rows, cols) && memcmp(&unranked, &profile, sizeof(profile)) == 0;
+        }
+        chomp_profile full;
+        memset(&full, 0, sizeof(full));
+        memset(full.row_len, cols, (size_t) rows);
+        correct = correct && staircase_rank(&full, rows) == staircase_count(rows, cols) - 1;
+    }
+
+    if (!correct) {
+        printf("the staircase rank is not correct\n");
+        return false;
+    }
+    printf("the staircase rank is correct\n");
+    return true;
+}
+
+bool
+test_tablebase()
+{
+    static int possible_moves[ROWS * COLS][2];
+    int configs[][3] = {{DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE}, {5, 6, 3}, {4, 4, 16}, {1, 8, 2}};
+    tablebase tb;
+    bool correct = tablebase_num_positions(7, 9) == 11440 && tablebase_num_positions(1, 1) == 2
+        && tablebase_num_positions(ROWS, COLS) > TABLEBASE_MAX_POSITIONS;
+
+    /// every position is solved as the exhaustive search does, and its move keeps the result at the announced distance
+    for (int c = 0; c < 4 && correct; c++) {
+        set_board_config(configs[c][0], configs[c][1], configs[c][2]);
+        memset(solver_memo, 0, sizeof(solver_memo));
+        correct = tablebase_solve(&tb) && tb.num_positions == tablebase_num_positions(board_rows, board_cols);
+        chomp_profile profile;
+        memset(&profile, 0, sizeof(profile));
+        uint32_t count = 0;
+        while (correct) {
+            game_state state;
+            tablebase_result result;
+            game_state_from_profile(&profile, &state);
+            correct = tablebase_probe(&tb, &profile, &result) && result.won == solve_by_search(&state);
+            if (correct && profile.row_len[0] == 0) {
+                correct = result.distance == 0 && result.row == -1;
+            } else if (correct) {
+                tablebase_result next_result;
+                game_state next = state;
+                correct = game_state_is_legal_move(&state, result.row, result.col)
+                    && (result.row != 0 || result.col != 0 || state.num_legal_moves == 1);
+                game_state_apply_move(&next, result.row, result.col);
+                correct = correct && tablebase_probe(&tb, &next.profile, &next_result)
+                    && next_result.won != result.won && next_result.distance == result.distance - 1;
+                /// no move wins faster, and no move loses slower
+                int num_moves = game_state_legal_moves(&state, possible_moves);
+                for (int m = 0; m < num_moves && correct; m++) {
+                    next = state;
+                    game_state_apply_move(&next, possible_moves[m][0], possible_moves[m][1]);
+                    correct = tablebase_probe(&tb, &next.profile, &next_result)
+                        && (next_result.won || !result.won || next_result.distance + 1 >= result.distance)
+                        && (result.won || next_result.distance + 1 <= result.distance);
+                }
+            }
+            count++;
+            if (!staircase_next(&profile, board_rows, board_cols)) {
+                break;
+            }
+        }
+        correct = correct && count == tb.num_positions;
+
+        /// a tablebase is not used on another board
+        if (correct) {
+            tablebase_result result;
+            set_board_config(configs[c][0], configs[c][1], configs[c][2] + 1);
+            correct = !tablebase_probe(&tb, &profile, &result);
+        }
+        tablebase_free(&tb);
+    }
+
+    /// a board with too many positions is not solved
+    if (correct) {
+        set_board_config(ROWS, COLS, 6);
+        correct = !tablebase_solve(&tb) && tb.num_positions == 0;
+    }
+
+    /// with a time budget, the ai only reads a tablebase solved before the game
+    if (correct) {
+        game_state state;
+        int row = -1;
+        int col = -1;
+        set_board_config(6, 4, 2);
+        game_state_init(&state);
+        correct = !tablebase_ai_move(&state, 100, &row, &col) && tablebase_ai_prepare()
+            && tablebase_ai_move(&state, 100, &row, &col) && game_state_is_legal_move(&state, row, col);
+    }
+
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the tablebase is not correct\n");
+        return false;
+    }
+    printf("the tablebase is correct\n");
+    return true;
+}
+
+bool
+test_default_tablebase()
+{
+    const ai_engine *saved_engine = current_ai_engine;
+    tablebase tb;
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    bool correct = default_tablebase_rows == DEFAULT_ROWS && default_tablebase_cols == DEFAULT_COLS
+        && default_tablebase_max_to_delete == DEFAULT_NUM_MAX_TO_DELETE
+        && default_tablebase_num_positions == tablebase_num_positions(DEFAULT_ROWS, DEFAULT_COLS)
+        && tablebase_solve(&tb);
+
+    /// the table compiled in holds the result and move the solver finds for every position
+    chomp_profile profile;
+    memset(&profile, 0, sizeof(profile));
+    for (uint32_t number = 0; number < default_tablebase_num_positions && correct; number++) {
+        tablebase_result result;
+        bool won;
+        int row;
+        int col;
+        correct = default_tablebase_probe(&profile, &won, &row, &col) && tablebase_probe(&tb, &profile, &result)
+            && won == result.won && row == result.row && col == result.col;
+        staircase_next(&profile, board_rows, board_cols);
+    }
+    tablebase_free(&tb);
+
+    /// the perfect engine plays the move of the table on the default board
+    if (correct) {
+        game_state state;
+        bool won;
+        int row = -1;
+        int col = -1;
+        int table_row;
+        int table_col;
+        game_state_init(&state);
+        current_ai_engine = ai_engine_find("perfect");
+        correct = ai_engine_move(&state, AI_NO_TIME_LIMIT, &row, &col)
+            && default_tablebase_probe(&state.profile, &won, &table_row, &table_col)
+            && row == table_row && col == table_col;
+    }
+
+    /// the table is not used on another board
+    if (correct) {
+        bool won;
+        int row;
+        int col;
+        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE + 1);
+        memset(&profile, 0, sizeof(profile));
+        correct = !default_tablebase_probe(&profile, &won, &row, &col);
+    }
+
+    current_ai_engine = saved_engine;
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the default tablebase is not correct\n");
+        return false;
+    }
+    printf("the default tablebase is correct\n");
+    return true;
+}
+
+bool
+test_tablebase_file()
+{
+    const char *path = "test_tablebase.bin";
+    const ai_engine *saved_engine = current_ai_engine;
+    int configs[][3] = {{5, 6, 3}, {DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE}, {3, 12, 4}, {9, 10, 6}};
+    tablebase tb;
+    tablebase_file file;
+    bool correct = true;
+
+    /// the mapped file gives the result of every position and an optimal move, compressed or not
+    for (int t = 0; t < 8 && correct; t++) {
+        int c = t / 2;
+        int compression = t % 2 == 0 ? TABLEBASE_COMPRESSION_NONE : TABLEBASE_COMPRESSION_RICE;
+        set_board_config(configs[c][0], configs[c][1], configs[c][2]);
+        correct = tablebase_solve(&tb) && tablebase_file_write(&tb, path, compression) && tablebase_file_open(&file, path)
+            && file.num_positions == tb.num_positions && file.compression == compression;
+        chomp_profile profile;
+        memset(&profile, 0, sizeof(profile));
+        do {
+            game_state state;
+            tablebase_result result;
+            tablebase_result next_result;
+            bool won;
+            int row;
+            int col;
+            game_state_from_profile(&profile, &state);
+            correct = correct && tablebase_file_probe(&file, &state, &won, &row, &col)
+                && tablebase_probe(&tb, &profile, &result) && won == result.won;
+            if (correct && profile.row_len[0] == 0) {
+                correct = row == -1 && col == -1;
+            } else if (correct) {
+                game_state next = state;
+                correct = game_state_is_legal_move(&state, row, col)
+                    && (row != 0 || col != 0 || state.num_legal_moves == 1);
+                game_state_apply_move(&next, row, col);
+                correct = correct && tablebase_probe(&tb, &next.profile, &next_result) && next_result.won != won;
+            }
+        } while (correct && staircase_next(&profile, board_rows, board_cols));
+
+        /// the perfect engine reads the file on the boards without a compiled table
+        if (correct && (board_rows != default_tablebase_rows || board_cols != default_tablebase_cols)) {
+            game_state state;
+            bool won;
+            int row = -1;
+            int col = -1;
+            int file_row;
+            int file_col;
+            game_state_init(&state);
+            ai_tablebase_file = file;
+            current_ai_engine = ai_engine_find("perfect");
+            correct = ai_engine_move(&state, AI_NO_TIME_LIMIT, &row, &col)
+                && tablebase_file_probe(&file, &state, &won, &file_row, &file_col)
+                && row == file_row && col == file_col;
+            memset(&ai_tablebase_file, 0, sizeof(ai_tablebase_file));
+        }
+
+        /// a block probed again is read from the cache
+        if (correct && compression == TABLEBASE_COMPRESSION_RICE) {
+            game_state state;
+            bool won;
+            int row;
+            int col;
+            game_state_init(&state);
+            tablebase_file_probe(&file, &state, &won, &row, &col);
+            uint64_t blocks_decoded = file.blocks_decoded;
+            correct = tablebase_file_probe(&file, &state, &won, &row, &col) && file.blocks_decoded == blocks_decoded
+                && file.num_blocks == (file.num_positions + TABLEBASE_BLOCK_POSITIONS - 1) / TABLEBASE_BLOCK_POSITIONS;
+        }
+
+        /// a file is not used on another board
+        if (correct) {
+            game_state state;
+            bool won;
+            int row;
+            int col;
+            set_board_config(configs[c][0], configs[c][1], configs[c][2] + 1);
+            game_state_init(&state);
+            correct = !tablebase_file_probe(&file, &state, &won, &row, &col);
+        }
+        tablebase_file_close(&file);
+        tablebase_free(&tb);
+    }
+
+    /// a file of the first version, without compression in its header, is still read
+    if (correct) {
+        static unsigned char bytes[TABLEBASE_FILE_HEADER_SIZE + 2048];
+        set_board_config(5, 6, 3);
+        correct = tablebase_solve(&tb) && tablebase_file_write(&tb, path, TABLEBASE_COMPRESSION_NONE);
+        FILE *stream = correct ? fopen(path, "rb") : NULL;
+        size_t size = stream != NULL ? fread(bytes, 1, sizeof(bytes), stream) : 0;
+        if (stream != NULL) {
+            fclose(stream);
+        }
+        bytes[8] = 1;
+        stream = size > TABLEBASE_FILE_HEADER_SIZE ? fopen(path, "wb") : NULL;
+        correct = stream != NULL && fwrite(bytes, 1, 32, stream) == 32
+            && fwrite(bytes + TABLEBASE_FILE_HEADER_SIZE, 1, size - TABLEBASE_FILE_HEADER_SIZE, stream) == size - TABLEBASE_FILE_HEADER_SIZE;
+        if (stream != NULL) {
+            fclose(stream);
+        }
+        game_state state;
+        tablebase_result result;
+        bool won;
+        int row;
+        int col;
+        game_state_init(&state);
+        correct = correct && tablebase_file_open(&file, path) && file.compression == TABLEBASE_COMPRESSION_NONE
+            && tablebase_file_probe(&file, &state, &won, &row, &col)
+            && tablebase_probe(&tb, &state.profile, &result) && won == result.won;
+        tablebase_file_close(&file);
+        tablebase_free(&tb);
+    }
+
+    /// a truncated file or a missing file is not a tablebase
+    if (correct) {
+        unsigned char bytes[TABLEBASE_FILE_HEADER_SIZE + 4];
+        FILE *stream = fopen(path, "rb");
+        correct = stream != NULL && fread(bytes, 1, sizeof(bytes), stream) == sizeof(bytes);
+        if (stream != NULL) {
+            fclose(stream);
+        }
+        stream = correct ? fopen(path, "wb") : NULL;
+        correct = stream != NULL && fwrite(bytes, 1, sizeof(bytes), stream) == sizeof(bytes);
+        if (stream != NULL) {
+            fclose(stream);
+        }
+        correct = correct && !tablebase_file_open(&file, path);
+        remove(path);
+        correct = correct && !tablebase_file_open(&file, path);
+    }
+
+    current_ai_engine = saved_engine;
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+    if (!correct) {
+        printf("the tablebase file is not correct\n");
+        return false;
+    }
+    printf("the tablebase file is correct\n");
+    return true;
+}
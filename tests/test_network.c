@@ -10,6 +10,8 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <pthread.h>
+#include <string.h>
+#include <sys/socket.h>
 
 /**
  * @brief Function to handle server-side operations in a separate thread.
@@ -23,11 +25,11 @@ void*
 server_thread_func(void* arg) 
 {
     int server_socket = *(int*)arg;
-    int client_socket = accept(server_socket, NULL, NULL);
+    int client_socket = accept_client(server_socket);
     assert(client_socket > 0);
 
     // Example move to send
-    int move = 5 * COLS + 2;
+    int move = 5 * board_cols + 2;
     int result = send_move(client_socket, move);
     assert(result == 0);
     printf("Test sent move OK\n");
@@ -62,7 +64,7 @@ test_receive_move()
 
     // Receive move on client side
     int received_move = receive_move(client_socket);
-    int expected_move = 5 * COLS + 2;
+    int expected_move = 5 * board_cols + 2;
     assert(received_move == expected_move);
     if (received_move == expected_move) {
         printf("test_receive_move OK.\n");
@@ -74,4 +76,34 @@ test_receive_move()
 close(client_socket);
 close(server_socket);
 
-}
\ No newline at end of file
+}
+/**
+ * @brief Test function to check the board configuration handshake.
+ * 
+ * This function sends a configuration on one end of a socket pair and checks
+ * that the other end accepts it only if it is the current one.
+ */
+void 
+test_board_config_handshake() 
+{
+    int sockets[2];
+    char config_str[NETWORK_CONFIG_MESSAGE_SIZE];
+    int configs[][3] = {{board_rows, board_cols, num_max_to_delete}, {64, 64, num_max_to_delete}, {board_rows, board_cols, num_max_to_delete + 1}};
+
+    for (int c = 0; c < 3; c++) {
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+        memset(config_str, 0, sizeof(config_str));
+        snprintf(config_str, sizeof(config_str), "CHOMP %d %d %d", configs[c][0], configs[c][1], configs[c][2]);
+        assert(send(sockets[0], config_str, sizeof(config_str), 0) == (ssize_t) sizeof(config_str));
+
+        bool accepted = exchange_board_config(sockets[1]);
+        assert(accepted == (c == 0));
+        if (accepted == (c == 0)) {
+            printf("test_board_config_handshake %d OK.\n", c);
+        } else {
+            printf("test_board_config_handshake %d FAILED.\n", c);
+        }
+        close(sockets[0]);
+        close(sockets[1]);
+    }
+}
@@ -8,6 +8,15 @@
 #include <stdlib.h>
 #include "chomp.h"
 #include "const.h"
+#include "bitboard.h"
+#include "game_state.h"
+#include "playout.h"
+#include "corner_board.h"
+#include "ai_engine.h"
+#include "search.h"
+#include "mcts.h"
+#include "tablebase.h"
+#include "tablebase_file.h"
 
 /**
  * @brief Measures the runtime performance of a game simulation.
@@ -37,13 +46,14 @@ test_runtime(int num_games) {
         int next_move_count = 0;
 
         int table[ROWS][COLS];
+        int possible_moves[ROWS * COLS][2];
         init_table(table); /// Initialize the game table
 
         while (table[0][0] != 0) {
 
             /// Measure runtime for next move possible
             start = clock();
-            int (*possible_moves)[2] = calculate_possibility(table);
+            int move_index = calculate_possible_moves(table, possible_moves);
 
             end = clock();
             cpu_time_used = ((double) (end - start)) / CLOCKS_PER_SEC;
@@ -51,10 +61,6 @@ test_runtime(int num_games) {
             next_move_count++;
 
             /// Select a random move from the possible moves
-            int move_index = 0;
-            while (possible_moves[move_index][0] != -1 || possible_moves[move_index][1] != -1) {
-                move_index++;
-            }
 
             if (move_index > 0) {
                 int random_index = rand() % move_index;
@@ -85,4 +91,258 @@ test_runtime(int num_games) {
     printf("Average move action runtime: %f seconds\n", total_move_time / total_move_count);
     printf("Average next move possible runtime: %f seconds\n", total_next_move_time / total_next_move_count);
     printf("Total runtime for all games: %f seconds\n", total_runtime);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Measures the runtime performance of a game simulation on bitboards.
+ *
+ * This function plays the same kind of random games as test_runtime() but
+ * directly on the bitboard engine, without going through the int table.
+ *
+ * @param num_games The number of games to simulate.
+ */
+void
+test_runtime_bitboard(int num_games) {
+    int total_move_count = 0;
+
+    clock_t total_start = clock(); /// Start measuring total runtime
+
+    for (int game = 0; game < num_games; game++) {
+        bitboard board = bitboard_full();
+
+        while (board & 1) {
+            bitboard legal = bitboard_legal_moves(board);
+
+            /// Select a random move from the legal moves
+            int random_index = rand() % __builtin_popcountll(legal);
+            while (random_index-- > 0) {
+                legal &= legal - 1;
+            }
+            int index = __builtin_ctzll(legal);
+            board = bitboard_delete_cells(board, index / board_cols, index % board_cols);
+            total_move_count++;
+        }
+    }
+
+    clock_t total_end = clock(); /// End measuring total runtime
+    double total_runtime = ((double) (total_end - total_start)) / CLOCKS_PER_SEC;
+
+    printf("Total bitboard games: %d\n", num_games);
+    printf("Total bitboard move actions: %d\n", total_move_count);
+    printf("Average bitboard move runtime (move generation included): %f seconds\n", total_runtime / total_move_count);
+    printf("Total runtime for all bitboard games: %f seconds\n", total_runtime);
+}
+
+/**
+ * @brief Measures the runtime performance of a game simulation on the game state.
+ *
+ * This function plays the same kind of random games as test_runtime() but
+ * takes the moves from the incrementally updated legal moves of a game state.
+ *
+ * @param num_games The number of games to simulate.
+ */
+void
+test_runtime_game_state(int num_games) {
+    int total_move_count = 0;
+    static int possible_moves[ROWS * COLS][2];
+
+    clock_t total_start = clock(); /// Start measuring total runtime
+
+    for (int game = 0; game < num_games; game++) {
+        game_state state;
+        game_state_init(&state);
+
+        while (state.profile.row_len[0] > 0) {
+            /// Select a random move from the legal moves
+            int num_moves = game_state_legal_moves(&state, possible_moves);
+            int random_index = rand() % num_moves;
+            game_state_apply_move(&state, possible_moves[random_index][0], possible_moves[random_index][1]);
+            total_move_count++;
+        }
+    }
+
+    clock_t total_end = clock(); /// End measuring total runtime
+    double total_runtime = ((double) (total_end - total_start)) / CLOCKS_PER_SEC;
+
+    printf("Total game state games: %d\n", num_games);
+    printf("Total game state move actions: %d\n", total_move_count);
+    printf("Average game state move runtime (move generation included): %f seconds\n", total_runtime / total_move_count);
+    printf("Total runtime for all game state games: %f seconds\n", total_runtime);
+}
+
+/**
+ * @brief Measures the throughput of the batch playouts.
+ *
+ * This function plays random games from the initial board with the lock-step
+ * kernel and with the scalar playout, and prints the number of playouts per
+ * second of both.
+ *
+ * @param num_games The number of games to simulate with each method.
+ */
+void
+test_runtime_playouts(int num_games) {
+    static bitboard boards[100000];
+    static bool wins[100000];
+    if (num_games > 100000) {
+        num_games = 100000;
+    }
+    for (int game = 0; game < num_games; game++) {
+        boards[game] = bitboard_full();
+    }
+
+    clock_t start = clock(); /// Start measuring the batch runtime
+    playout_batch(boards, num_games, 42, wins);
+    double batch_runtime = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+    int scalar_wins = 0;
+    uint64_t rng = 42;
+    start = clock(); /// Start measuring the scalar runtime
+    for (int game = 0; game < num_games; game++) {
+        scalar_wins += playout_scalar(boards[game], &rng);
+    }
+    double scalar_runtime = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+    printf("Total playouts: %d (%d lanes)\n", num_games, PLAYOUT_LANES);
+    printf("Batch playouts per second: %.0f\n", num_games / (batch_runtime > 0 ? batch_runtime : 1e-9));
+    printf("Scalar playouts per second: %.0f (first player won %d)\n", num_games / (scalar_runtime > 0 ? scalar_runtime : 1e-9), scalar_wins);
+}
+
+/**
+ * @brief Measures the runtime of random games on a giant corner board.
+ *
+ * Each game is played on a 100000 x 100000 board: half of the moves are big
+ * random cuts creating new corners, the other half are legal moves.
+ *
+ * @param num_moves The number of moves to play.
+ */
+void
+test_runtime_corner_board(int num_moves) {
+    static int64_t possible_moves[ROWS * COLS][2];
+    corner_board board;
+    corner_board_init(&board, 100000, 100000, DEFAULT_NUM_MAX_TO_DELETE);
+    int max_corners = 0;
+    srand(5);
+
+    clock_t start = clock(); /// Start measuring the runtime
+    for (int move = 0; move < num_moves; move++) {
+        if (corner_board_num_cells(&board) == 0) {
+            corner_board_free(&board);
+            corner_board_init(&board, 100000, 100000, DEFAULT_NUM_MAX_TO_DELETE);
+        }
+        int64_t row = ((int64_t) rand() * 7919) % 100000;
+        int64_t col = ((int64_t) rand() * 104729) % 100000;
+        if (move % 2 == 1 || !corner_board_is_cell_set(&board, row, col)) {
+            int64_t count = corner_board_legal_moves(&board, possible_moves, ROWS * COLS);
+            int64_t index = rand() % (count < ROWS * COLS ? count : ROWS * COLS);
+            row = possible_moves[index][0];
+            col = possible_moves[index][1];
+        }
+        corner_board_delete_cells(&board, row, col);
+        if (corner_board_num_corners(&board) > max_corners) {
+            max_corners = corner_board_num_corners(&board);
+        }
+    }
+    double runtime = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+    corner_board_free(&board);
+
+    printf("Total corner board moves: %d (up to %d corners)\n", num_moves, max_corners);
+    printf("Corner board moves per second: %.0f\n", num_moves / (runtime > 0 ? runtime : 1e-9));
+}
+
+/**
+ * @brief Measures the time every ai engine takes to choose a move.
+ *
+ * The engines play the same positions of random games on the default board,
+ * through the same interface as the front ends, on one thread each.
+ *
+ * @param num_positions The number of positions given to each engine.
+ */
+void
+test_runtime_engines(int num_positions) {
+    static int possible_moves[ROWS * COLS][2];
+    const ai_engine *saved_engine = current_ai_engine;
+    search_threads = 1;
+    mcts_threads = 1;
+
+    for (int e = 0; e < num_ai_engines; e++) {
+        int table[ROWS][COLS];
+        current_ai_engine = &ai_engines[e];
+        srand(11); /// The same positions for every engine
+        init_table(table);
+        double runtime = 0.0;
+        for (int position = 0; position < num_positions; position++) {
+            if (table[0][0] == 0) {
+                init_table(table);
+            }
+            game_state state;
+            int row;
+            int col;
+            game_state_from_table(table, &state);
+            clock_t start = clock(); /// Start measuring the runtime
+            ai_engine_move(&state, AI_NO_TIME_LIMIT, &row, &col);
+            runtime += ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+            int count = calculate_possible_moves(table, possible_moves);
+            int move = rand() % count;
+            delete_cells(table, possible_moves[move][0], possible_moves[move][1]);
+        }
+        printf("Engine %s: %.6f seconds per move\n", ai_engines[e].name, runtime / num_positions);
+    }
+    current_ai_engine = saved_engine;
+    search_threads = 0;
+    mcts_threads = 0;
+}
+
+/**
+ * @brief Measures the size of a tablebase file and the time a probe takes, compressed or not.
+ *
+ * The positions probed are those of random games on a 10x10 board, every
+ * probe looking for the optimal move too.
+ *
+ * @param num_probes The number of positions probed in each file.
+ */
+void
+test_runtime_tablebase_file(int num_probes) {
+    static int possible_moves[ROWS * COLS][2];
+    const char *path = "runtime_tablebase.bin";
+    const char *names[] = {"uncompressed", "compressed"};
+    int compressions[] = {TABLEBASE_COMPRESSION_NONE, TABLEBASE_COMPRESSION_RICE};
+    tablebase tb;
+    set_board_config(10, 10, 6);
+    if (!tablebase_solve(&tb)) {
+        set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+        return;
+    }
+
+    for (int c = 0; c < 2; c++) {
+        tablebase_file file;
+        if (!tablebase_file_write(&tb, path, compressions[c]) || !tablebase_file_open(&file, path)) {
+            continue;
+        }
+        srand(13); /// The same positions for both files
+        game_state state;
+        game_state_init(&state);
+        double runtime = 0.0;
+        for (int probe = 0; probe < num_probes; probe++) {
+            if (state.profile.row_len[0] == 0) {
+                game_state_init(&state);
+            }
+            bool won;
+            int row;
+            int col;
+            clock_t start = clock(); /// Start measuring the runtime
+            tablebase_file_probe(&file, &state, &won, &row, &col);
+            runtime += ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+            int count = game_state_legal_moves(&state, possible_moves);
+            int move = rand() % count;
+            game_state_apply_move(&state, possible_moves[move][0], possible_moves[move][1]);
+        }
+        printf("Tablebase file %s: %zu bytes, %.3f microseconds per probe, %llu blocks decoded\n", names[c],
+               file.mapping_size, runtime * 1e6 / num_probes, (unsigned long long) file.blocks_decoded);
+        tablebase_file_close(&file);
+    }
+    remove(path);
+    tablebase_free(&tb);
+    set_board_config(DEFAULT_ROWS, DEFAULT_COLS, DEFAULT_NUM_MAX_TO_DELETE);
+}
@@ -12,6 +12,12 @@ int main() {
     int test_count = 0, successes = 0;
     printf("test runtime\n");
     test_runtime(1000);
+    test_runtime_bitboard(1000);
+    test_runtime_game_state(1000);
+    test_runtime_playouts(100000);
+    test_runtime_corner_board(100000);
+    test_runtime_engines(20);
+    test_runtime_tablebase_file(100000);
 
     printf("\ntest players and scores\n");
     testPlayersNameAndScores();
@@ -38,6 +44,9 @@ int main() {
     test_receive_move();
     printf("\n");
 
+    test_board_config_handshake();
+    printf("\n");
+
     printf("testing ai functions...\n");
     run_test(test_num_cell_row, &successes, &test_count);
     run_test(test_num_cell_col, &successes, &test_count);
@@ -52,6 +61,31 @@ int main() {
     run_test(test_col_rectangle_strategy, &successes, &test_count);
     run_test(test_corner_strategy, &successes, &test_count);
     run_test(test_gun_strategy, &successes, &test_count);
+    run_test(test_bitboard_engine, &successes, &test_count);
+    run_test(test_profile_engine, &successes, &test_count);
+    run_test(test_board_config, &successes, &test_count);
+    run_test(test_all_num_to_delete, &successes, &test_count);
+    run_test(test_game_state, &successes, &test_count);
+    run_test(test_possible_moves_threads, &successes, &test_count);
+    run_test(test_make_unmake_move, &successes, &test_count);
+    run_test(test_playout_batch, &successes, &test_count);
+    run_test(test_corner_board, &successes, &test_count);
+    run_test(test_analysis, &successes, &test_count);
+    run_test(test_corner_analysis, &successes, &test_count);
+    run_test(test_board_profile, &successes, &test_count);
+    run_test(test_find_pattern, &successes, &test_count);
+    run_test(test_endgame_solvers, &successes, &test_count);
+    run_test(test_search, &successes, &test_count);
+    run_test(test_parallel_search, &successes, &test_count);
+    run_test(test_mcts, &successes, &test_count);
+    run_test(test_ai_engines, &successes, &test_count);
+    run_test(test_anytime_search, &successes, &test_count);
+    run_test(test_pondering, &successes, &test_count);
+    run_test(test_opening_book, &successes, &test_count);
+    run_test(test_staircase_rank, &successes, &test_count);
+    run_test(test_tablebase, &successes, &test_count);
+    run_test(test_default_tablebase, &successes, &test_count);
+    run_test(test_tablebase_file, &successes, &test_count);
     int failures = test_count - successes;
     printf("%d failures out of %d tests\n", failures, test_count);
     return successes;